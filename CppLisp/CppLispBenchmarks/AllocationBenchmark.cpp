@@ -0,0 +1,92 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+// Counts the heap allocations of the interpreter core for simple numeric loops.
+//
+// The loops are evaluated for n and 2n iterations, the difference removes the 
+// allocations needed to setup the scope, to parse and to compile the script.
+// The allocations of one (+ i 1) expression are the difference between a loop 
+// with an additional (+ i 1) in its body and the same loop without it.
+
+#include "Lisp.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static size_t g_AllocationCount = 0;
+
+void * operator new(std::size_t size)
+{
+	g_AllocationCount++;
+	void * p = std::malloc(size != 0 ? size : 1);
+	if (p == 0)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+using namespace CppLisp;
+
+static const char * LoopScript = "(do (defn f (n) (do (def i 0) (while (< i n) (setf i (+ i 1))) (return i))) (f {0}))";
+static const char * LoopWithAddScript = "(do (defn f (n) (do (def i 0) (while (< i n) (do (+ i 1) (setf i (+ i 1)))) (return i))) (f {0}))";
+
+static size_t CountAllocations(const string & script, int iterations)
+{
+	string code = string::Format(script, std::to_string(iterations));
+	size_t start = g_AllocationCount;
+	Lisp::Eval(code);
+	return g_AllocationCount - start;
+}
+
+static double AllocationsPerIteration(const string & script, int iterations)
+{
+	size_t small = CountAllocations(script, iterations);
+	size_t large = CountAllocations(script, 2 * iterations);
+	return (double)(large - small) / (double)iterations;
+}
+
+int main(int argc, char * argv[])
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 10000;
+
+	double loop = AllocationsPerIteration(LoopScript, iterations);
+	double loopWithAdd = AllocationsPerIteration(LoopWithAddScript, iterations);
+
+	printf("allocations per loop iteration: %.2f\n", loop);
+	printf("allocations per (+ i 1)       : %.2f\n", loopWithAdd - loop);
+	return 0;
+}
@@ -0,0 +1,350 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+// Benchmark suite for the interpreter core.
+//
+// Runs the tests of CsLisp/Scripts/benchmark.fuel (loop, calls, strings) and
+// additional workloads for the parser, macro expansion, dictionaries, lists
+// and recursion. Every workload is executed some times for warmup and then
+// measured for the given number of repetitions, the median, the 95th
+// percentile and the minimum of the run times are reported. The results can
+// be written as JSON to track the performance across versions.
+//
+// usage: fuel-bench [-w=warmup] [-r=repetitions] [-json=file|-] 
+//                   [-s=script-path] [-l=library-path] [workload ...]
+
+#include "Lisp.h"
+#include "Parser.h"
+#include "Runtime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace CppLisp;
+
+#ifndef FUEL_BENCH_SCRIPT_PATH
+#define FUEL_BENCH_SCRIPT_PATH "."
+#endif
+#ifndef FUEL_BENCH_LIBRARY_PATH
+#define FUEL_BENCH_LIBRARY_PATH "."
+#endif
+
+static const char * WorkloadScript = "(do\n\
+	(define-macro-eval inc-eval (x) (+ x 1))\n\
+	(define-macro-expand inc-expand (x) '(+ x 1))\n\
+	(defn macro-eval-bench (n) (do (def i 0) (while (< i n) (setf i (inc-eval i))) (return i)))\n\
+	(defn dict-bench (n)\n\
+		(do\n\
+			(def d (make-dict))\n\
+			(def i 0)\n\
+			(while (< i n) (do (dict-set d i (* i 2)) (setf i (+ i 1))))\n\
+			(def sum 0)\n\
+			(setf i 0)\n\
+			(while (< i n) (do (setf sum (+ sum (dict-get d i))) (setf i (+ i 1))))\n\
+			(return sum)))\n\
+	(defn dict-string-bench (d n)\n\
+		(do\n\
+			(def i 0)\n\
+			(while (< i n) (do (dict-set d (+ \"key\" i) i) (setf i (+ i 1))))\n\
+			(def hits 0)\n\
+			(setf i 0)\n\
+			(while (< i n) (do (if (dict-contains-key d (+ \"key\" (* i 2))) (setf hits (+ hits 1))) (setf i (+ i 1))))\n\
+			(return hits)))\n\
+	(defn dict-view-bench (n)\n\
+		(do\n\
+			(def d (make-dict #t))\n\
+			(def i 0)\n\
+			(while (< i n) (do (dict-set d i (+ \"value\" i)) (setf i (+ i 1))))\n\
+			(def hits 0)\n\
+			(setf i 0)\n\
+			(while (< i n) (do (if (dict-contains-value d (+ \"value\" (* i 2))) (setf hits (+ hits (len (dict-keys d))))) (setf i (+ i 1))))\n\
+			(return hits)))\n\
+	(defn rmap (f l) (if (== (len l) 0) '() (cons (f (first l)) (rmap f (rest l)))))\n\
+	(defn rfilter (p l) (if (== (len l) 0) '() (if (p (first l)) (cons (first l) (rfilter p (rest l))) (rfilter p (rest l)))))\n\
+	(defn list-recursion-bench (n)\n\
+		(do\n\
+			(def l '())\n\
+			(def i 0)\n\
+			(while (< i n) (do (setf l (cons i l)) (setf i (+ i 1))))\n\
+			(return (len (rfilter (lambda (x) (> x 100)) (rmap (lambda (x) (* x 2)) l))))))\n\
+	(defn list-bench (n)\n\
+		(do\n\
+			(def l '())\n\
+			(def i 0)\n\
+			(while (< i n) (do (setf l (cons i l)) (setf i (+ i 1))))\n\
+			(return (reduce (lambda (x y) (+ x y)) (map (lambda (x) (* x 2)) (reverse l)) 0))))\n\
+	(defn fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))\n\
+	(defn map-fib-bench (mapper n)\n\
+		(do\n\
+			(def l '())\n\
+			(def i 0)\n\
+			(while (< i n) (do (setf l (cons 15 l)) (setf i (+ i 1))))\n\
+			(return (reduce (lambda (x y) (+ x y)) (mapper fib l) 0))))\n\
+)";
+
+struct Workload
+{
+	string Name;
+	std::function<void()> Run;
+};
+
+struct WorkloadResult
+{
+	string Name;
+	std::vector<double> Samples;	// in ms, sorted
+	double Median;
+	double Percentile95;
+	double Minimum;
+	double Mean;
+};
+
+static string ReadFile(const string & fileName)
+{
+	std::ifstream file(fileName);
+	if (!file)
+	{
+		fprintf(stderr, "can not read file %s\n", fileName.c_str());
+		exit(1);
+	}
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+static string GetOption(const string & arg, const string & option)
+{
+	return arg.StartsWith(option) ? string(arg.substr(option.size())) : string::Empty;
+}
+
+static Workload CreateScriptWorkload(const string & name, std::shared_ptr<LispScope> scope, const string & code)
+{
+	return Workload{ name, [scope, code]()
+	{
+		Lisp::Eval(code, scope, "fuel-bench", false, std::make_shared<TextWriter>(true));
+	} };
+}
+
+static std::vector<Workload> CreateWorkloads(const string & scriptPath)
+{
+	std::vector<Workload> workloads;
+
+	string benchmarkScript = ReadFile(scriptPath + "/benchmark.fuel");
+	std::shared_ptr<LispScope> benchmarkScope = LispEnvironment::CreateDefaultScope();
+	Lisp::Eval(benchmarkScript, benchmarkScope, "benchmark.fuel", false, std::make_shared<TextWriter>(true));
+	workloads.push_back(CreateScriptWorkload("loop", benchmarkScope, "(TestLoopAndSum 100000)"));
+	workloads.push_back(CreateScriptWorkload("calls", benchmarkScope, "(TestCalls 30000)"));
+	workloads.push_back(CreateScriptWorkload("strings", benchmarkScope, "(TestStrings 1000 sLongString)"));
+
+	std::stringstream parserCode;
+	parserCode << "(do\n";
+	for (int i = 0; i < 50; i++)
+	{
+		parserCode << benchmarkScript << "\n";
+	}
+	parserCode << ")\n";
+	string parserScript = parserCode.str();
+	workloads.push_back(Workload{ "parser", [parserScript]() { LispParser::Parse(parserScript); } });
+
+	std::shared_ptr<LispScope> workloadScope = LispEnvironment::CreateDefaultScope();
+	Lisp::Eval(WorkloadScript, workloadScope, "fuel-bench", false, std::make_shared<TextWriter>(true));
+
+	std::stringstream macroCode;
+	macroCode << "(list";
+	for (int i = 0; i < 1000; i++)
+	{
+		macroCode << " (inc-expand " << i << ")";
+	}
+	macroCode << ")";
+	workloads.push_back(CreateScriptWorkload("macro-expand", workloadScope, macroCode.str()));
+	workloads.push_back(CreateScriptWorkload("macro-eval", workloadScope, "(macro-eval-bench 2000)"));
+	workloads.push_back(CreateScriptWorkload("dict", workloadScope, "(dict-bench 10000)"));
+	workloads.push_back(CreateScriptWorkload("dict-strings", workloadScope, "(dict-string-bench (make-dict) 20000)"));
+	workloads.push_back(CreateScriptWorkload("sorted-dict-strings", workloadScope, "(dict-string-bench (make-sorted-dict) 20000)"));
+	workloads.push_back(CreateScriptWorkload("dict-views", workloadScope, "(dict-view-bench 5000)"));
+	workloads.push_back(CreateScriptWorkload("list", workloadScope, "(list-bench 5000)"));
+	workloads.push_back(CreateScriptWorkload("list-recursion", workloadScope, "(list-recursion-bench 2000)"));
+	workloads.push_back(CreateScriptWorkload("recursion", workloadScope, "(fib 20)"));
+	workloads.push_back(CreateScriptWorkload("map-fib", workloadScope, "(map-fib-bench map 64)"));
+	workloads.push_back(CreateScriptWorkload("pmap-fib", workloadScope, "(map-fib-bench pmap 64)"));
+	return workloads;
+}
+
+static double RunInMilliseconds(const Workload & workload)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	workload.Run();
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+static double Percentile(const std::vector<double> & sortedSamples, double percent)
+{
+	// nearest rank method
+	size_t rank = (size_t)std::ceil(percent / 100.0 * (double)sortedSamples.size());
+	return sortedSamples[rank > 0 ? rank - 1 : 0];
+}
+
+static WorkloadResult Measure(const Workload & workload, int warmup, int repetitions)
+{
+	for (int i = 0; i < warmup; i++)
+	{
+		workload.Run();
+	}
+
+	WorkloadResult result;
+	result.Name = workload.Name;
+	for (int i = 0; i < repetitions; i++)
+	{
+		result.Samples.push_back(RunInMilliseconds(workload));
+	}
+	std::sort(result.Samples.begin(), result.Samples.end());
+
+	size_t count = result.Samples.size();
+	result.Median = count % 2 == 1 ? result.Samples[count / 2] : (result.Samples[count / 2 - 1] + result.Samples[count / 2]) / 2.0;
+	result.Percentile95 = Percentile(result.Samples, 95.0);
+	result.Minimum = result.Samples.front();
+	double sum = 0.0;
+	for (double sample : result.Samples)
+	{
+		sum += sample;
+	}
+	result.Mean = sum / (double)count;
+	return result;
+}
+
+static void WriteJson(FILE * file, const std::vector<WorkloadResult> & results, int warmup, int repetitions)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"version\": \"%s\",\n", Lisp::Version.c_str());
+	fprintf(file, "  \"compiler\": \"%s\",\n", Lisp::GetCompilerInfo().c_str());
+	fprintf(file, "  \"warmup\": %d,\n", warmup);
+	fprintf(file, "  \"repetitions\": %d,\n", repetitions);
+	fprintf(file, "  \"unit\": \"ms\",\n");
+	fprintf(file, "  \"workloads\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const WorkloadResult & result = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"median\": %.4f, \"p95\": %.4f, \"min\": %.4f, \"mean\": %.4f, \"samples\": [", result.Name.c_str(), result.Median, result.Percentile95, result.Minimum, result.Mean);
+		for (size_t j = 0; j < result.Samples.size(); j++)
+		{
+			fprintf(file, j == 0 ? "%.4f" : ", %.4f", result.Samples[j]);
+		}
+		fprintf(file, "] }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char * argv[])
+{
+	int warmup = 2;
+	int repetitions = 10;
+	string jsonFile;
+	string scriptPath = FUEL_BENCH_SCRIPT_PATH;
+	LispRuntime::SetDefaultLibraryPath(FUEL_BENCH_LIBRARY_PATH);
+	std::vector<string> selected;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg.StartsWith("-w="))
+		{
+			warmup = atoi(GetOption(arg, "-w=").c_str());
+		}
+		else if (arg.StartsWith("-r="))
+		{
+			repetitions = std::max(1, atoi(GetOption(arg, "-r=").c_str()));
+		}
+		else if (arg.StartsWith("-json="))
+		{
+			jsonFile = GetOption(arg, "-json=");
+		}
+		else if (arg.StartsWith("-s="))
+		{
+			scriptPath = GetOption(arg, "-s=");
+		}
+		else if (arg.StartsWith("-l="))
+		{
+			LispRuntime::SetDefaultLibraryPath(GetOption(arg, "-l="));
+		}
+		else
+		{
+			selected.push_back(arg);
+		}
+	}
+
+	std::vector<WorkloadResult> results;
+	bool jsonToStdout = jsonFile == "-";
+
+	// the output of the scripts is discarded, the TextWriter writes always to std::cout
+	std::streambuf * coutBuffer = std::cout.rdbuf(null);
+	try
+	{
+		for (const Workload & workload : CreateWorkloads(scriptPath))
+		{
+			if (!selected.empty() && std::find(selected.begin(), selected.end(), workload.Name) == selected.end())
+			{
+				continue;
+			}
+			results.push_back(Measure(workload, warmup, repetitions));
+			if (!jsonToStdout)
+			{
+				const WorkloadResult & result = results.back();
+				printf("%-20s median %10.3f ms   p95 %10.3f ms   min %10.3f ms\n", result.Name.c_str(), result.Median, result.Percentile95, result.Minimum);
+			}
+		}
+	}
+	catch (const LispException & exc)
+	{
+		std::cout.rdbuf(coutBuffer);
+		fprintf(stderr, "error running benchmark: %s\n", exc.Message.c_str());
+		return 1;
+	}
+	std::cout.rdbuf(coutBuffer);
+	std::cout.clear();
+
+	if (jsonToStdout)
+	{
+		WriteJson(stdout, results, warmup, repetitions);
+	}
+	else if (!jsonFile.empty())
+	{
+		FILE * file = fopen(jsonFile.c_str(), "w");
+		if (file == 0)
+		{
+			fprintf(stderr, "can not write file %s\n", jsonFile.c_str());
+			return 1;
+		}
+		WriteJson(file, results, warmup, repetitions);
+		fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,76 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+// Measures the time needed for the arithmetic and compare operations.
+//
+// Every operation is evaluated in a loop inside of a compiled function, the
+// time of the same loop without the operation is subtracted, the remaining
+// time divided by the number of iterations is the time of one operation.
+// Each operation is measured for int/int, int/double and double/double arguments.
+
+#include "Lisp.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace CppLisp;
+
+static const char * BaselineScript = "(do (defn f (n a b) (do (def i 0) (while (< i n) (setf i (+ i 1))) (return i))) (f {0} {1} {2}))";
+static const char * OperationScript = "(do (defn f (n a b) (do (def i 0) (while (< i n) (do ({3} a b) (setf i (+ i 1)))) (return i))) (f {0} {1} {2}))";
+
+static double MeasureSeconds(const string & script)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Lisp::Eval(script);
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(stop - start).count();
+}
+
+static double NanosecondsPerOperation(const char * op, const char * a, const char * b, int iterations)
+{
+	string count = std::to_string(iterations);
+	double baseline = MeasureSeconds(string::Format(BaselineScript, count, a, b));
+	double operation = MeasureSeconds(string::Format(OperationScript, count, a, b, op));
+	double result = (operation - baseline) * 1e9 / (double)iterations;
+	return result > 0.0 ? result : 0.0;
+}
+
+int main(int argc, char * argv[])
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+
+	const char * operations[] = { "+", "-", "*", "/", "%", "<", "<=", "==", "!=" };
+
+	printf("operation    int/int ns  int/double ns  double/double ns\n");
+	for (const char * op : operations)
+	{
+		double intInt = NanosecondsPerOperation(op, "7", "3", iterations);
+		double intDouble = NanosecondsPerOperation(op, "7", "3.5", iterations);
+		double doubleDouble = NanosecondsPerOperation(op, "7.5", "3.5", iterations);
+		printf("%-9s %13.1f %14.1f %17.1f\n", op, intInt, intDouble, doubleDouble);
+	}
+	return 0;
+}
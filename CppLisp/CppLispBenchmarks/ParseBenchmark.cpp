@@ -0,0 +1,133 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+// Measures the tokenizer and parser throughput in MB/s of fuel source code.
+//
+// The source code is read from the files given at the command line or
+// generated if no file is given. The code is scanned (token views only),
+// tokenized and parsed repeatedly, the fastest run of each phase is reported.
+
+#include "Parser.h"
+#include "Tokenizer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace CppLisp;
+
+static string GenerateScript(int functionCount)
+{
+	std::stringstream code;
+	code << "(do\n";
+	for (int i = 0; i < functionCount; i++)
+	{
+		code << "  ; function number " << i << "\n";
+		code << "  (defn f" << i << " (a b c)\n";
+		code << "    (do\n";
+		code << "      (def l '(1 2.5 \"text with (brackets)\" #t nil))\n";
+		code << "      (if (< a " << i << ") (list a b c `(a ,b ,@l)) (+ a (* b c) (- c 1.5)))))\n";
+	}
+	code << ")\n";
+	return code.str();
+}
+
+static string ReadFiles(int argc, char * argv[], int firstFile)
+{
+	// all files are parsed as one module
+	std::stringstream code;
+	code << "(do\n";
+	for (int i = firstFile; i < argc; i++)
+	{
+		std::ifstream file(argv[i]);
+		if (!file)
+		{
+			fprintf(stderr, "can not read file %s\n", argv[i]);
+			exit(1);
+		}
+		code << file.rdbuf() << "\n";
+	}
+	code << ")\n";
+	return code.str();
+}
+
+static double ScanTimeInSeconds(const string & code)
+{
+	// the containers are reused like in a reader which scans many modules
+	static std::vector<LispTokenView> tokens;
+	static std::vector<string> escapedTexts;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	LispTokenizer::Scan(code, 0, tokens, escapedTexts);
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(stop - start).count();
+}
+
+static double TokenizeTimeInSeconds(const string & code)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	IEnumerable<std::shared_ptr<LispToken>> tokens = LispTokenizer::Tokenize(code, 0, std::make_shared<LispArena>());
+	tokens.clear();
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(stop - start).count();
+}
+
+static double ParseTimeInSeconds(const string & code)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::shared_ptr<object> ast = LispParser::Parse(code);
+	ast.reset();
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(stop - start).count();
+}
+
+static void Measure(const char * phase, double (*timeInSeconds)(const string &), const string & code, int runs)
+{
+	double best = timeInSeconds(code);
+	for (int i = 1; i < runs; i++)
+	{
+		double time = timeInSeconds(code);
+		if (time < best)
+		{
+			best = time;
+		}
+	}
+
+	double megaBytes = (double)code.size() / (1024.0 * 1024.0);
+	printf("%s %.2f MB in %.2f ms: %.2f MB/s\n", phase, megaBytes, best * 1000.0, megaBytes / best);
+}
+
+int main(int argc, char * argv[])
+{
+	// usage: fuel-parse-bench [runs] [file.fuel ...]
+	int runs = argc > 1 ? atoi(argv[1]) : 10;
+	string code = argc > 2 ? ReadFiles(argc, argv, 2) : GenerateScript(20000);
+
+	Measure("scanned", ScanTimeInSeconds, code, runs);
+	Measure("tokenized", TokenizeTimeInSeconds, code, runs);
+	Measure("parsed", ParseTimeInSeconds, code, runs);
+	return 0;
+}
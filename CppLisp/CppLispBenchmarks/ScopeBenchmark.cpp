@@ -0,0 +1,87 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+// Measures the time of symbol lookups in the global scope.
+//
+// All names of the default global scope (the builtin functions) are looked up
+// through a function scope on top of the global scope, like in a function call:
+// by name (ContainsKey of the local scope, then of the global scope) and by the 
+// interned symbol id (FindCellInScopes, local scope then global scope), which is 
+// used by the interpreter and the virtual machine. The result is the average time 
+// of one lookup.
+
+#include "Lisp.h"
+#include "Symbol.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace CppLisp;
+
+template <class Lookup> static double NanosecondsPerLookup(size_t count, int rounds, Lookup lookup)
+{
+	size_t found = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			found += lookup(i) ? 1 : 0;
+		}
+	}
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	if (found != count * rounds)
+	{
+		fprintf(stderr, "lookup failed\n");
+		exit(1);
+	}
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (double)(count * rounds);
+}
+
+int main(int argc, char * argv[])
+{
+	int rounds = argc > 1 ? atoi(argv[1]) : 10000;
+
+	std::shared_ptr<LispScope> scope = LispEnvironment::CreateDefaultScope();
+	std::vector<string> names;
+	std::vector<size_t> symbolIds;
+	for (const string & name : scope->GetKeys())
+	{
+		names.push_back(name);
+		symbolIds.push_back(LispSymbolTable::Intern(name));
+	}
+	// a function scope on top of the global scope, like in a function call
+	std::shared_ptr<LispScope> localScope = std::make_shared<LispScope>("f", scope);
+	localScope->PrivateInitForCpp(scope);
+
+	double byName = NanosecondsPerLookup(names.size(), rounds, [&](size_t i) -> bool { return localScope->ContainsKey(names[i]) || scope->ContainsKey(names[i]); });
+	double bySymbol = NanosecondsPerLookup(symbolIds.size(), rounds, [&](size_t i) -> bool { return localScope->FindCellInScopes(symbolIds[i]) != null; });
+
+	printf("global scope with %d symbols\n", (int)names.size());
+	printf("lookup by name     : %.1f ns\n", byName);
+	printf("lookup by symbol id: %.1f ns\n", bySymbol);
+	return 0;
+}
@@ -0,0 +1,139 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+// Measures the scaling of independent runtimes over threads.
+//
+// Every thread creates its own global scope (and runtime) and calls a user
+// defined function in a loop, the threads share only the process wide symbol
+// table. The throughput of all threads is compared to the throughput of one
+// thread: independent runtimes should scale linearly up to the number of cores.
+// The symbol table locks taken while calling are reported, too (see
+// LispRuntimeStatistics::SymbolTableLocks), the calls should take no lock.
+//
+// usage: fuel-thread-bench [max-threads] [calls-per-thread]
+
+#include "Lisp.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace CppLisp;
+
+static const char * CallsScript = "(do\n\
+	(defn add (a b) (+ a b))\n\
+	(defn calls-bench (n)\n\
+		(do\n\
+			(def sum 0)\n\
+			(def i 0)\n\
+			(while (< i n) (do (setf sum (add sum 1)) (setf i (+ i 1))))\n\
+			(return sum)))\n\
+)";
+
+struct ThreadResult
+{
+	size_t SymbolTableLocks;
+	bool IsOk;
+};
+
+static double RunThreads(size_t threadCount, int calls, /*out*/ size_t & symbolTableLocks)
+{
+	std::vector<std::thread> threads;
+	std::vector<ThreadResult> results(threadCount);
+	std::atomic<size_t> readyCount(0);
+	std::atomic<bool> start(false);
+	const string benchCall = "(calls-bench " + std::to_string(calls) + ")";
+
+	for (size_t t = 0; t < threadCount; t++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			std::shared_ptr<LispScope> scope = LispEnvironment::CreateDefaultScope();
+			Lisp::Eval(CallsScript, scope, "fuel-thread-bench");
+			// warmup: compile the functions and fill the call site caches
+			Lisp::Eval("(calls-bench 100)", scope, "fuel-thread-bench");
+			readyCount++;
+			while (!start)
+			{
+				std::this_thread::yield();
+			}
+			Lisp::ResetRuntimeStatistics();
+			std::shared_ptr<LispVariant> result = Lisp::Eval(benchCall, scope, "fuel-thread-bench");
+			results[t].SymbolTableLocks = Lisp::GetRuntimeStatistics().SymbolTableLocks;
+			results[t].IsOk = result->ToInt() == calls;
+		}));
+	}
+	while (readyCount < threadCount)
+	{
+		std::this_thread::yield();
+	}
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	start = true;
+	for (std::thread & thread : threads)
+	{
+		thread.join();
+	}
+	std::chrono::steady_clock::time_point stopTime = std::chrono::steady_clock::now();
+
+	symbolTableLocks = 0;
+	for (const ThreadResult & result : results)
+	{
+		if (!result.IsOk)
+		{
+			fprintf(stderr, "wrong result\n");
+			exit(1);
+		}
+		symbolTableLocks += result.SymbolTableLocks;
+	}
+	return std::chrono::duration<double>(stopTime - startTime).count();
+}
+
+int main(int argc, char * argv[])
+{
+	size_t cores = std::thread::hardware_concurrency();
+	size_t maxThreads = argc > 1 ? (size_t)atoi(argv[1]) : (cores > 0 ? cores : 4);
+	int calls = argc > 2 ? atoi(argv[2]) : 200000;
+
+	printf("%d cores, %d calls per thread\n", (int)cores, calls);
+	double singleThroughput = 0;
+	for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		size_t symbolTableLocks;
+		double seconds = RunThreads(threadCount, calls, /*out*/ symbolTableLocks);
+		double throughput = (double)threadCount * calls / seconds;
+		if (threadCount == 1)
+		{
+			singleThroughput = throughput;
+		}
+		printf("%3d threads: %8.3f s  %12.0f calls/s  speedup %5.2f  symbol table locks %d\n", (int)threadCount, seconds, throughput, throughput / singleThroughput, (int)symbolTableLocks);
+		if (threadCount < maxThreads && threadCount * 2 > maxThreads)
+		{
+			threadCount = maxThreads / 2;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,155 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_ARENA_H
+#define _LISP_ARENA_H
+
+#include "cstypes.h"
+
+#include <new>
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Region allocator for the nodes of a parse tree.
+	/// Memory is taken from large blocks and is released in one shot
+	/// when the arena is destroyed, single deallocations are ignored.
+	/// Allocation is not thread safe, an arena is filled by one parser.
+	/// </summary>
+	class LispArena
+	{
+	public:
+		/*public*/ const static size_t DefaultBlockSize = 64 * 1024;
+
+		explicit LispArena(size_t blockSize = DefaultBlockSize)
+			: m_BlockSize(blockSize), m_Current(0), m_Remaining(0), m_AllocatedBytes(0)
+		{
+		}
+
+		~LispArena()
+		{
+			for (var block : m_Blocks)
+			{
+				::operator delete(block);
+			}
+		}
+
+		void * Allocate(size_t size, size_t alignment)
+		{
+			size_t padding = (alignment - ((size_t)m_Current % alignment)) % alignment;
+			if (m_Current == 0 || padding + size > m_Remaining)
+			{
+				// big requests get a block of their own
+				size_t blockSize = size + alignment > m_BlockSize ? size + alignment : m_BlockSize;
+				m_Current = (char *)::operator new(blockSize);
+				m_Remaining = blockSize;
+				m_Blocks.push_back(m_Current);
+				padding = (alignment - ((size_t)m_Current % alignment)) % alignment;
+			}
+			void * result = m_Current + padding;
+			m_Current += padding + size;
+			m_Remaining -= padding + size;
+			m_AllocatedBytes += size;
+			return result;
+		}
+
+		size_t GetAllocatedBytes() const
+		{
+			return m_AllocatedBytes;
+		}
+
+		size_t GetBlockCount() const
+		{
+			return m_Blocks.size();
+		}
+
+	private:
+		LispArena(const LispArena &);
+		LispArena & operator=(const LispArena &);
+
+		size_t m_BlockSize;
+		char * m_Current;
+		size_t m_Remaining;
+		size_t m_AllocatedBytes;
+		std::vector<char *> m_Blocks;
+	};
+
+	/// <summary>
+	/// Standard allocator which takes its memory from a shared LispArena.
+	/// Every object allocated with it keeps the arena alive.
+	/// </summary>
+	template <class T>
+	class LispArenaAllocator
+	{
+	public:
+		typedef T value_type;
+
+		explicit LispArenaAllocator(std::shared_ptr<LispArena> arena)
+			: Arena(arena)
+		{
+		}
+
+		template <class U>
+		LispArenaAllocator(const LispArenaAllocator<U> & other)
+			: Arena(other.Arena)
+		{
+		}
+
+		T * allocate(size_t count)
+		{
+			return (T *)Arena->Allocate(count * sizeof(T), alignof(T));
+		}
+
+		void deallocate(T * /*p*/, size_t /*count*/)
+		{
+			// memory is released with the arena
+		}
+
+		template <class U>
+		bool operator==(const LispArenaAllocator<U> & other) const
+		{
+			return Arena == other.Arena;
+		}
+
+		template <class U>
+		bool operator!=(const LispArenaAllocator<U> & other) const
+		{
+			return Arena != other.Arena;
+		}
+
+		std::shared_ptr<LispArena> Arena;
+	};
+
+	/// <summary>
+	/// Creates a reference counted value in the given arena.
+	/// </summary>
+	template <class T, class... Args>
+	std::shared_ptr<T> MakeArenaShared(std::shared_ptr<LispArena> arena, Args&&... args)
+	{
+		return std::allocate_shared<T>(LispArenaAllocator<T>(arena), std::forward<Args>(args)...);
+	}
+}
+
+#endif
@@ -0,0 +1,574 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "Compiler.h"
+#include "Environment.h"
+#include "Variant.h"
+#include "Symbol.h"
+
+#include <algorithm>
+
+namespace CppLisp
+{
+	static size_t Emit(LispCode & code, LispOpCode opCode, size_t a = 0, size_t b = 0, size_t c = 0)
+	{
+		code.Instructions.push_back(LispInstruction(opCode, a, b, c));
+		return code.Instructions.size() - 1;
+	}
+
+	static void UseRegister(LispCode & code, size_t reg)
+	{
+		if (reg >= code.RegisterCount)
+		{
+			code.RegisterCount = reg + 1;
+		}
+	}
+
+	static size_t AddConstant(LispCode & code, std::shared_ptr<object> value)
+	{
+		code.Constants.push_back(value);
+		return code.Constants.size() - 1;
+	}
+
+	static size_t AddSymbol(LispCode & code, std::shared_ptr<object> symbol)
+	{
+		code.Symbols.push_back(symbol);
+		code.SymbolNames.push_back(symbol->ToString());
+		code.SymbolIds.push_back(LispSymbolTable::Intern(code.SymbolNames.back()));
+		return code.Symbols.size() - 1;
+	}
+
+	static size_t FindSlot(const LispCode & code, const string & name)
+	{
+		for (size_t i = 0; i < code.SlotNames.size(); i++)
+		{
+			if (code.SlotNames[i] == name)
+			{
+				return i;
+			}
+		}
+		return NoSlot;
+	}
+
+	static size_t AddSlot(LispCode & code, const string & name)
+	{
+		size_t slot = FindSlot(code, name);
+		if (slot == NoSlot)
+		{
+			code.SlotNames.push_back(name);
+			slot = code.SlotNames.size() - 1;
+		}
+		return slot;
+	}
+
+	static void EmitToken(LispCode & code, std::shared_ptr<object> function)
+	{
+		// for debugging: update the current line number at the current scope (like the interpreter does)
+		var token = function->ToLispVariantRef().Token;
+		if (token != null)
+		{
+			code.Tokens.push_back(token);
+			Emit(code, OpToken, code.Tokens.size() - 1);
+		}
+	}
+
+	static void PatchJumps(LispCode & code, const std::vector<size_t> & jumps)
+	{
+		for (var jump : jumps)
+		{
+			if (code.Instructions[jump].OpCode == OpJumpIfFalse || code.Instructions[jump].OpCode == OpJumpIfNotTrue)
+			{
+				code.Instructions[jump].B = code.Instructions.size();
+			}
+			else
+			{
+				code.Instructions[jump].A = code.Instructions.size();
+			}
+		}
+	}
+
+	static bool IsSymbolObject(std::shared_ptr<object> elem)
+	{
+		return elem->IsLispVariant() && elem->ToLispVariantRef().IsSymbol();
+	}
+
+	static bool IsBuiltinFunction(const string & name, std::shared_ptr<LispScope> globalScope, bool isSpecialForm)
+	{
+		std::shared_ptr<object> value;
+		if (globalScope != null && !LispEnvironment::IsMacro(name, globalScope) && globalScope->ContainsKey(name, &value))
+		{
+			const LispVariant & variant = value->ToLispVariantRef();
+			return variant.IsFunction() && variant.FunctionValue().IsBuiltin() && variant.FunctionValue().IsSpecialForm() == isSpecialForm;
+		}
+		return false;
+	}
+
+	static bool IsBuiltinSpecialForm(const string & name, std::shared_ptr<LispScope> globalScope)
+	{
+		return IsBuiltinFunction(name, globalScope, /*isSpecialForm:*/ true);
+	}
+
+	// is the ast a quoted list: (quote (...))
+	static bool IsQuotedList(std::shared_ptr<object> ast, std::shared_ptr<LispScope> globalScope)
+	{
+		if (ast->IsList())
+		{
+			const IEnumerable<std::shared_ptr<object>> & quote = ast->ToListRef();
+			if (quote.Count() == 2 && IsSymbolObject(quote.First()) && quote.First()->ToString() == LispEnvironment::Quote && quote[1] != null)
+			{
+				return (quote[1]->IsList() || (quote[1]->IsLispVariant() && quote[1]->ToLispVariantRef().IsList())) && IsBuiltinSpecialForm(LispEnvironment::Quote, globalScope);
+			}
+		}
+		return false;
+	}
+
+	// is the ast a call of the builtin function (or special form) with the given name: (name ...)
+	static bool IsBuiltinCall(std::shared_ptr<object> ast, const string & name, std::shared_ptr<LispScope> globalScope, bool isSpecialForm)
+	{
+		if (ast != null && ast->IsList())
+		{
+			const IEnumerable<std::shared_ptr<object>> & call = ast->ToListRef();
+			return call.Count() > 0 && IsSymbolObject(call.First()) && call.First()->ToString() == name && IsBuiltinFunction(name, globalScope, isSpecialForm);
+		}
+		return false;
+	}
+
+	// is the ast an element of a quoted list: (first '(...)) or (nth i '(...)), 
+	// returns the element (the element is a variant)
+	static bool IsElementOfQuotedList(const string & name, const IEnumerable<std::shared_ptr<object>> & astAsList, std::shared_ptr<LispScope> globalScope, /*out*/ std::shared_ptr<object> & element)
+	{
+		size_t argumentCount = astAsList.Count() - 1;
+		std::shared_ptr<object> quote;
+		int index = 0;
+		if (name == LispEnvironment::FirstFcn && argumentCount == 1)
+		{
+			quote = astAsList[1];
+		}
+		else if (name == LispEnvironment::NthFcn && argumentCount == 2 && astAsList[1] != null && astAsList[1]->IsLispVariant() && astAsList[1]->ToLispVariantRef().IsInt())
+		{
+			quote = astAsList[2];
+			index = astAsList[1]->ToLispVariantRef().IntValue();
+		}
+		if (quote == null || !IsQuotedList(quote, globalScope) || !IsBuiltinFunction(name, globalScope, /*isSpecialForm:*/ false))
+		{
+			return false;
+		}
+		std::shared_ptr<object> list = quote->ToListRef()[1];
+		const IEnumerable<std::shared_ptr<object>> & elements = list->IsList() ? list->ToListRef() : list->ToLispVariantRef().ListValueRef();
+		if (index < 0 || (size_t)index >= elements.Count() || elements[index] == null || !elements[index]->IsLispVariant())
+		{
+			return false;
+		}
+		element = elements[index];
+		return true;
+	}
+
+	std::shared_ptr<LispCode> LispCompiler::Compile(std::shared_ptr<object> ast, std::shared_ptr<LispScope> scope)
+	{
+		var code = std::make_shared<LispCode>();
+		code->Ast = ast;
+		CompileExpression(*code, ast, 0, 1, scope != null ? scope->GlobalScope : null);
+		Emit(*code, OpReturn, 0);
+		return code;
+	}
+
+	std::shared_ptr<LispCode> LispCompiler::CompileFunction(std::shared_ptr<object> ast, std::shared_ptr<LispScope> scope, const std::vector<string> & formalArguments)
+	{
+		var code = std::make_shared<LispCode>();
+		code->Ast = ast;
+		code->IsFunctionBody = true;
+		for (const string & name : formalArguments)
+		{
+			AddSlot(*code, name);
+		}
+		// the formal arguments are the first slots of the body, if their names are unique
+		bool isUnique = code->SlotNames.size() == formalArguments.size();
+		// the result of the body is the result of the function ==> the body is in tail position
+		CompileExpression(*code, ast, 0, 1, scope != null ? scope->GlobalScope : null, /*isTail:*/ true);
+		Emit(*code, OpReturn, 0);
+
+		// the local variables of a function body are never cached, 
+		// a call site may be compiled before the def of its local function
+		for (var & callSite : code->CallSites)
+		{
+			callSite.IsCacheable = callSite.IsSymbol && FindSlot(*code, callSite.FunctionName) == NoSlot;
+		}
+
+		for (const string & name : code->SymbolNames)
+		{
+			code->SymbolSlots.push_back(FindSlot(*code, name));
+		}
+		code->NeedsCallScope = !isUnique || 
+			std::any_of(code->SymbolIds.begin(), code->SymbolIds.end(), [](size_t symbolId) -> bool { return LispUserFunction::IsCallScopeSymbol(symbolId); });
+		return code;
+	}
+
+	void LispCompiler::CompileExpression(LispCode & code, std::shared_ptr<object> ast, size_t target, size_t free, std::shared_ptr<LispScope> globalScope, bool isTail)
+	{
+		UseRegister(code, target);
+
+		if (ast.get() == null)
+		{
+			Emit(code, OpNull, target);
+		}
+		else if (ast->IsLispVariant())
+		{
+			const LispVariant & item = ast->ToLispVariantRef();
+			if (item.IsSymbol())
+			{
+				size_t slot = FindSlot(code, item.ToString());
+				Emit(code, slot != NoSlot ? OpResolveLocal : OpResolve, target, AddSymbol(code, ast), slot);
+			}
+			else if (item.IsList() && !item.IsNil())
+			{
+				CompileCall(code, ast, item.ListValueRef(), target, free, globalScope, isTail);
+			}
+			else
+			{
+				Emit(code, OpValue, target, AddConstant(code, ast));
+			}
+		}
+		else if (ast->IsList())
+		{
+			const IEnumerable<std::shared_ptr<object>> & astAsList = ast->ToListRef();
+			if (astAsList.Count() == 0)
+			{
+				Emit(code, OpValue, target, AddConstant(code, std::make_shared<object>(LispVariant(LispType::_Nil))));
+			}
+			else
+			{
+				CompileCall(code, ast, astAsList, target, free, globalScope, isTail);
+			}
+		}
+		else
+		{
+			Emit(code, OpEval, target, AddConstant(code, ast));
+		}
+	}
+
+	void LispCompiler::CompileArgument(LispCode & code, std::shared_ptr<object> ast, size_t target, size_t free, std::shared_ptr<LispScope> globalScope)
+	{
+		UseRegister(code, target);
+
+		if (IsSymbolObject(ast))
+		{
+			size_t slot = FindSlot(code, ast->ToString());
+			Emit(code, slot != NoSlot ? OpResolveLocalArgument : OpResolveArgument, target, AddSymbol(code, ast), slot);
+		}
+		else if (ast->IsList())
+		{
+			CompileExpression(code, ast, target, free, globalScope);
+		}
+		else
+		{
+			Emit(code, OpConstant, target, AddConstant(code, ast));
+		}
+	}
+
+	void LispCompiler::CompileCall(LispCode & code, std::shared_ptr<object> ast, const IEnumerable<std::shared_ptr<object>> & astAsList, size_t target, size_t free, std::shared_ptr<LispScope> globalScope, bool isTail)
+	{
+		var function = astAsList.First();
+		if (IsSymbolObject(function) && CompileSpecialForm(code, function->ToString(), astAsList, target, free, globalScope, isTail))
+		{
+			return;
+		}
+
+		// the element of a quoted list is used without a call of the function, 
+		// if no lvalue is needed (used by the macros for loops)
+		std::shared_ptr<object> element;
+		size_t elementOperation = NoSlot;
+		if (IsSymbolObject(function) && FindSlot(code, function->ToString()) == NoSlot && IsElementOfQuotedList(function->ToString(), astAsList, globalScope, /*out*/ element))
+		{
+			EmitToken(code, function);
+			elementOperation = Emit(code, OpElement, target, AddConstant(code, element));
+		}
+
+		LispCallSite callSite;
+		callSite.Ast = ast;
+		callSite.Function = function;
+		callSite.FunctionName = function->ToString();
+		callSite.IsSymbol = IsSymbolObject(function);
+		callSite.Symbol = callSite.IsSymbol ? AddSymbol(code, function) : 0;
+		callSite.Slot = callSite.IsSymbol ? FindSlot(code, callSite.FunctionName) : NoSlot;
+		callSite.Token = function->ToLispVariantRef().Token;
+		callSite.ArgumentCount = astAsList.Count() - 1;
+		callSite.Target = target;
+		callSite.Base = free;
+		callSite.IsCacheable = false;
+
+		// special forms get the not evaluated arguments, process statements like this: `,@l  with l = (1 2 3)
+		callSite.Arguments.resize(callSite.ArgumentCount);
+		for (size_t i = 1; i < astAsList.Count(); i++)
+		{
+			var argument = astAsList[i];
+			if (argument->IsLispVariant())
+			{
+				const LispVariant & variant = argument->ToLispVariantRef();
+				if (variant.IsUnQuoted == LispUnQuoteModus::_UnQuoteSplicing && variant.IsList())
+				{
+					var lst = variant.ListValueRef();
+					callSite.Arguments.resize(callSite.Arguments.size() + lst.size() - 1);
+					for (var elem : lst)
+					{
+						callSite.Arguments[i - 1] = elem;
+						i++;
+					}
+
+					break;
+				}
+			}
+
+			callSite.Arguments[i - 1] = argument;
+		}
+
+		size_t next = free + callSite.ArgumentCount + 1;
+		UseRegister(code, next - 1);
+
+		code.CallSites.push_back(callSite);
+		size_t callSiteIndex = code.CallSites.size() - 1;
+		size_t enter = Emit(code, OpEnter, callSiteIndex);
+
+		// resolve values via local and global scope first, then evaluate the lists (like the interpreter does)
+		for (size_t i = 1; i < astAsList.Count(); i++)
+		{
+			if (!astAsList[i]->IsList())
+			{
+				CompileArgument(code, astAsList[i], free + i, next, globalScope);
+			}
+		}
+		for (size_t i = 1; i < astAsList.Count(); i++)
+		{
+			if (astAsList[i]->IsList())
+			{
+				CompileArgument(code, astAsList[i], free + i, next, globalScope);
+			}
+		}
+
+		// a call in tail position of a function body replaces the call of the function body
+		Emit(code, OpCall, callSiteIndex, isTail && code.IsFunctionBody ? 1 : 0);
+		code.Instructions[enter].B = code.Instructions.size();
+		if (elementOperation != NoSlot)
+		{
+			code.Instructions[elementOperation].C = code.Instructions.size();
+		}
+	}
+
+	bool LispCompiler::CompileSpecialForm(LispCode & code, const string & name, const IEnumerable<std::shared_ptr<object>> & astAsList, size_t target, size_t free, std::shared_ptr<LispScope> globalScope, bool isTail)
+	{
+		// the forms with invalid arguments are not translated, 
+		// the special form itself will report the error at run time
+		size_t argumentCount = astAsList.Count() - 1;
+		std::vector<size_t> jumps;
+
+		if ((name == LispEnvironment::Do || name == LispEnvironment::Begin) && IsBuiltinSpecialForm(name, globalScope))
+		{
+			for (size_t i = 1; i < astAsList.Count(); i++)
+			{
+				if (!astAsList[i]->IsList())
+				{
+					return false;
+				}
+			}
+
+			EmitToken(code, astAsList.First());
+			if (argumentCount == 0)
+			{
+				Emit(code, OpUndefined, target);
+			}
+			for (size_t i = 1; i < astAsList.Count(); i++)
+			{
+				CompileExpression(code, astAsList[i], target, free, globalScope, isTail && i == argumentCount);
+				if (i < argumentCount)
+				{
+					jumps.push_back(Emit(code, OpJumpIfReturn));
+				}
+			}
+			PatchJumps(code, jumps);
+			return true;
+		}
+
+		if (name == LispEnvironment::If && (argumentCount == 2 || argumentCount == 3) && IsBuiltinSpecialForm(name, globalScope))
+		{
+			EmitToken(code, astAsList.First());
+			CompileExpression(code, astAsList[1], target, free, globalScope);
+			size_t jumpToElse = Emit(code, OpJumpIfFalse, target);
+			CompileExpression(code, astAsList[2], target, free, globalScope, isTail);
+			jumps.push_back(Emit(code, OpJump));
+			code.Instructions[jumpToElse].B = code.Instructions.size();
+			if (argumentCount == 3)
+			{
+				CompileExpression(code, astAsList[3], target, free, globalScope, isTail);
+			}
+			else
+			{
+				Emit(code, OpNull, target);
+			}
+			PatchJumps(code, jumps);
+			return true;
+		}
+
+		if (name == LispEnvironment::While && argumentCount == 2 && IsBuiltinSpecialForm(name, globalScope))
+		{
+			size_t condition = free;
+			UseRegister(code, condition);
+
+			EmitToken(code, astAsList.First());
+			Emit(code, OpUndefined, target);
+			size_t loop = code.Instructions.size();
+			CompileExpression(code, astAsList[1], condition, free + 1, globalScope);
+			jumps.push_back(Emit(code, OpJumpIfNotTrue, condition));
+			CompileExpression(code, astAsList[2], target, free + 1, globalScope);
+			jumps.push_back(Emit(code, OpJumpIfReturn));
+			Emit(code, OpJump, loop);
+			PatchJumps(code, jumps);
+			return true;
+		}
+
+		if ((name == LispEnvironment::And || name == LispEnvironment::Or) && IsBuiltinSpecialForm(name, globalScope))
+		{
+			// the evaluation stops after the first false value (also for or!), 
+			// all other values must be bool values (like the special form does)
+			bool isAnd = name == LispEnvironment::And;
+			EmitToken(code, astAsList.First());
+			for (size_t i = 1; i < astAsList.Count(); i++)
+			{
+				CompileExpression(code, astAsList[i], target, free, globalScope);
+				if (isAnd || i == 1)
+				{
+					jumps.push_back(Emit(code, OpJumpIfFalse, target));
+				}
+				else
+				{
+					Emit(code, OpCheckBool, target);
+				}
+			}
+			Emit(code, OpBool, target, isAnd || argumentCount > 0 ? 1 : 0);
+			size_t jumpToEnd = Emit(code, OpJump);
+			PatchJumps(code, jumps);
+			Emit(code, OpBool, target, 0);
+			code.Instructions[jumpToEnd].A = code.Instructions.size();
+			return true;
+		}
+
+		if ((name == LispEnvironment::Def || name == LispEnvironment::Gdef) && argumentCount == 2 && 
+			astAsList[1]->IsLispVariant() && (astAsList[1]->ToLispVariantRef().IsSymbol() || astAsList[1]->ToLispVariantRef().IsString()) &&
+			IsBuiltinSpecialForm(name, globalScope))
+		{
+			EmitToken(code, astAsList.First());
+			CompileExpression(code, astAsList[2], target, free, globalScope);
+			if (code.IsFunctionBody && name == LispEnvironment::Def)
+			{
+				Emit(code, OpDefineLocal, target, AddSymbol(code, astAsList[1]), AddSlot(code, astAsList[1]->ToString()));
+			}
+			else
+			{
+				Emit(code, OpDefine, target, AddSymbol(code, astAsList[1]), name == LispEnvironment::Gdef ? 1 : 0);
+			}
+			return true;
+		}
+
+		if (name == LispEnvironment::Eval && argumentCount == 1 && IsQuotedList(astAsList[1], globalScope) && IsBuiltinFunction(name, globalScope, /*isSpecialForm:*/ false))
+		{
+			// (eval '(...)) evaluates the list in the current scope
+			EmitToken(code, astAsList.First());
+			CompileExpression(code, astAsList[1]->ToListRef()[1], target, free, globalScope, isTail);
+			return true;
+		}
+
+		if (name == LispEnvironment::Eval && argumentCount == 1 && IsBuiltinFunction(name, globalScope, /*isSpecialForm:*/ false))
+		{
+			EmitToken(code, astAsList.First());
+			if (IsBuiltinCall(astAsList[1], LispEnvironment::List, globalScope, /*isSpecialForm:*/ false) && FindSlot(code, LispEnvironment::List) == NoSlot)
+			{
+				// (eval (list ...)) evaluates the elements of the list without creating the list
+				const IEnumerable<std::shared_ptr<object>> & elements = astAsList[1]->ToListRef();
+				size_t count = elements.Count() - 1;
+				size_t next = free + count;
+				UseRegister(code, next);
+				EmitToken(code, elements.First());
+				// resolve values via local and global scope first, then evaluate the lists (like the call of list does)
+				for (size_t i = 1; i < elements.Count(); i++)
+				{
+					if (!elements[i]->IsList())
+					{
+						CompileArgument(code, elements[i], free + i - 1, next, globalScope);
+					}
+				}
+				for (size_t i = 1; i < elements.Count(); i++)
+				{
+					if (elements[i]->IsList())
+					{
+						CompileArgument(code, elements[i], free + i - 1, next, globalScope);
+					}
+				}
+				Emit(code, OpEvalList, target, free, count);
+			}
+			else
+			{
+				CompileArgument(code, astAsList[1], target, free, globalScope);
+				Emit(code, OpEvalValue, target);
+			}
+			return true;
+		}
+
+		if (name == LispEnvironment::Quote && argumentCount == 1 && astAsList[1] != null && IsBuiltinSpecialForm(name, globalScope))
+		{
+			EmitToken(code, astAsList.First());
+			Emit(code, OpQuote, target, AddConstant(code, astAsList[1]));
+			return true;
+		}
+
+		if (name == LispEnvironment::Setf && argumentCount == 2 && IsBuiltinCall(astAsList[1], LispEnvironment::RVal, globalScope, /*isSpecialForm:*/ true) && 
+			astAsList[1]->ToListRef().Count() == 2 && astAsList[1]->ToListRef()[1] != null && astAsList[1]->ToListRef()[1]->IsList() &&
+			IsBuiltinSpecialForm(name, globalScope))
+		{
+			// (setf (rval expr) value) sets the symbol, which is the result of expr, 
+			// expr is evaluated without lvalue (like rval does)
+			const IEnumerable<std::shared_ptr<object>> & rval = astAsList[1]->ToListRef();
+			size_t needsLValue = free;
+			size_t symbol = free + 1;
+			UseRegister(code, symbol);
+			EmitToken(code, astAsList.First());
+			Emit(code, OpNeedsLValue, needsLValue, 0);
+			EmitToken(code, rval.First());
+			CompileExpression(code, rval[1], symbol, free + 2, globalScope);
+			Emit(code, OpRestoreLValue, needsLValue);
+			CompileExpression(code, astAsList[2], target, free + 2, globalScope);
+			Emit(code, OpSetfValue, target, symbol);
+			return true;
+		}
+
+		if (name == LispEnvironment::Setf && argumentCount == 2 && IsSymbolObject(astAsList[1]) && IsBuiltinSpecialForm(name, globalScope))
+		{
+			EmitToken(code, astAsList.First());
+			CompileExpression(code, astAsList[2], target, free, globalScope);
+			size_t slot = FindSlot(code, astAsList[1]->ToString());
+			Emit(code, slot != NoSlot ? OpSetfLocal : OpSetf, target, AddSymbol(code, astAsList[1]), slot);
+			return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,358 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_COMPILER_H
+#define _LISP_COMPILER_H
+
+#include "csobject.h"
+#include "cstypes.h"
+#include "Token.h"
+#include "Scope.h"
+
+#include <atomic>
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Operation codes of the FUEL byte code.
+	/// R = register, K = constant, S = symbol, L = local slot, C = call site, T = token
+	/// </summary>
+	enum LispOpCode
+	{
+		OpConstant = 0,				// R[A] = K[B] (argument, not evaluated)
+		OpValue = 1,				// R[A] = value of atom K[B]
+		OpResolve = 2,				// R[A] = value of symbol S[B]
+		OpResolveArgument = 3,		// R[A] = value of symbol S[B], evaluate the value if it is a list
+		OpResolveLocal = 4,			// R[A] = value of local L[C] (named S[B])
+		OpResolveLocalArgument = 5,	// R[A] = value of local L[C] (named S[B]), evaluate the value if it is a list
+		OpEval = 6,					// R[A] = evaluate K[B] with the ast interpreter
+		OpEnter = 7,				// resolve function of C[A], handle macros and special forms and goto B if done
+		OpCall = 8,					// call function of C[A] with the evaluated arguments, B != 0 for a call in tail position
+		OpDefine = 9,				// define S[B] with value R[A] in local (C == 0) or global scope (C != 0)
+		OpDefineLocal = 10,			// define local L[C] (named S[B]) with value R[A]
+		OpSetf = 11,				// set S[B] to value R[A]
+		OpSetfLocal = 12,			// set local L[C] (named S[B]) to value R[A]
+		OpJump = 13,				// goto A
+		OpJumpIfFalse = 14,			// if (!R[A].BoolValue()) goto B
+		OpJumpIfNotTrue = 15,		// if (!R[A].ToBool()) goto B
+		OpJumpIfReturn = 16,		// if (scope.IsInReturn) goto A
+		OpCheckBool = 17,			// R[A].BoolValue()
+		OpBool = 18,				// R[A] = (B != 0)
+		OpUndefined = 19,			// R[A] = undefined
+		OpNull = 20,				// R[A] = null
+		OpToken = 21,				// scope.CurrentToken = T[A]
+		OpReturn = 22,				// return R[A]
+		OpQuote = 23,				// R[A] = copy of K[B] (quote)
+		OpEvalValue = 24,			// R[A] = evaluate the value of R[A] (eval)
+		OpEvalList = 25,			// R[A] = evaluate the list R[B] ... R[B + C - 1] (eval of a list created with list)
+		OpNeedsLValue = 26,			// R[A] = scope.NeedsLValue, scope.NeedsLValue = (B != 0)
+		OpRestoreLValue = 27,		// scope.NeedsLValue = R[A]
+		OpSetfValue = 28,			// set the symbol or the lvalue R[B] to value R[A]
+		OpElement = 29				// if (!scope.NeedsLValue) { R[A] = K[B], goto C } (element of a quoted list)
+	};
+
+	/// <summary>
+	/// Marker for a symbol which is not a local variable of the compiled function.
+	/// </summary>
+	const size_t NoSlot = (size_t)-1;
+
+	// **********************************************************************
+	/// <summary>
+	/// One instruction of the FUEL byte code.
+	/// </summary>
+	struct LispInstruction
+	{
+		inline LispInstruction(LispOpCode opCode, size_t a = 0, size_t b = 0, size_t c = 0)
+			: OpCode(opCode), A(a), B(b), C(c)
+		{
+		}
+
+		LispOpCode OpCode;
+		size_t A;
+		size_t B;
+		size_t C;
+	};
+
+	// **********************************************************************
+	/// <summary>
+	/// The value cell of a function cached at a call site, valid for a global scope and a definition epoch.
+	/// The code of a function is shared by the chunks of pmap and by the forks of a global scope 
+	/// (see <see cref="LispScope::Fork"/>), which may run in parallel, so the cache is a sequence lock:
+	/// the version is odd while a thread writes the cache and a reader uses the cache only if
+	/// the version did not change while reading. A thread does not wait for a writing thread,
+	/// it resolves the function without the cache.
+	/// </summary>
+	struct LispCallSiteCache
+	{
+		/*public*/ std::atomic<size_t> Version;
+
+		/*public*/ std::atomic<std::shared_ptr<object> *> Cell;
+
+		/*public*/ std::atomic<const LispScope *> GlobalScope;
+
+		/*public*/ std::atomic<uint64_t> Epoch;
+
+		/*public*/ LispCallSiteCache()
+			: Version(0), Cell(null), GlobalScope(null), Epoch(0)
+		{
+		}
+
+		/*public*/ LispCallSiteCache(const LispCallSiteCache & /*other*/)
+			: Version(0), Cell(null), GlobalScope(null), Epoch(0)
+		{
+		}
+
+		/// <summary>
+		/// Returns the cached cell if it is valid for the given global scope and epoch, otherwise null.
+		/// </summary>
+		/*public*/ inline std::shared_ptr<object> * Find(const LispScope * globalScope, uint64_t epoch) const
+		{
+			size_t version = Version.load(std::memory_order_acquire);
+			if ((version & 1) == 0 && Epoch.load(std::memory_order_relaxed) == epoch && GlobalScope.load(std::memory_order_relaxed) == globalScope)
+			{
+				std::shared_ptr<object> * cell = Cell.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Version.load(std::memory_order_relaxed) == version)
+				{
+					return cell;
+				}
+			}
+			return null;
+		}
+
+		/// <summary>
+		/// Sets the cached cell, the cache is not changed if another thread writes the cache.
+		/// </summary>
+		/*public*/ inline void Set(std::shared_ptr<object> * cell, const LispScope * globalScope, uint64_t epoch)
+		{
+			size_t version = Version.load(std::memory_order_relaxed);
+			if ((version & 1) == 0 && Version.compare_exchange_strong(version, version + 1, std::memory_order_relaxed))
+			{
+				std::atomic_thread_fence(std::memory_order_release);
+				Cell.store(cell, std::memory_order_relaxed);
+				GlobalScope.store(globalScope, std::memory_order_relaxed);
+				Epoch.store(epoch, std::memory_order_relaxed);
+				Version.store(version + 2, std::memory_order_release);
+			}
+		}
+
+	private:
+		LispCallSiteCache & operator=(const LispCallSiteCache & other);
+	};
+
+	class LispCode;
+
+	// **********************************************************************
+	/// <summary>
+	/// The compiled expansion of a macro which is evaluated at run time (define-macro-eval).
+	/// The expansion of a call depends only on the macro and the ast of the call,
+	/// it is compiled at the first execution of the call site.
+	/// </summary>
+	struct LispMacroExpansion
+	{
+		/*public*/ std::shared_ptr<object> Macro;
+
+		/*public*/ std::shared_ptr<LispCode> Code;
+	};
+
+	// **********************************************************************
+	/// <summary>
+	/// Informations about a function call in the byte code.
+	/// The evaluated arguments of the call are stored in the registers
+	/// Base + 1 ... Base + ArgumentCount, the function in register Base 
+	/// and the result is stored in register Target.
+	/// Arguments holds the not evaluated arguments for special forms.
+	/// The function of a call site in a function body is cached (inline cache), 
+	/// if it is found in the global scope, see <see cref="LispRuntime::DefinitionEpoch"/>.
+	/// </summary>
+	struct LispCallSite
+	{
+		/*public*/ std::shared_ptr<object> Ast;
+
+		/*public*/ std::shared_ptr<object> Function;
+
+		/*public*/ string FunctionName;
+
+		/*public*/ bool IsSymbol;
+
+		/// <summary>
+		/// Index of the function name in the symbols of the code.
+		/// </summary>
+		/*public*/ size_t Symbol;
+
+		/// <summary>
+		/// Local slot of the function name or <see cref="NoSlot"/>.
+		/// </summary>
+		/*public*/ size_t Slot;
+
+		/*public*/ std::vector<std::shared_ptr<object>> Arguments;
+
+		/*public*/ size_t ArgumentCount;
+
+		/*public*/ std::shared_ptr<LispToken> Token;
+
+		/*public*/ size_t Target;
+
+		/*public*/ size_t Base;
+
+		/// <summary>
+		/// Can the function of this call site be cached?
+		/// True for symbols in function bodies which are not local variables.
+		/// </summary>
+		/*public*/ bool IsCacheable;
+
+		/// <summary>
+		/// The cached value cell of the function in the global scope.
+		/// </summary>
+		/*public*/ mutable LispCallSiteCache Cache;
+
+		/// <summary>
+		/// The compiled expansion of the macro called at this call site, the call site
+		/// may be executed in parallel ==> use std::atomic_load and std::atomic_store.
+		/// </summary>
+		/*public*/ mutable std::shared_ptr<LispMacroExpansion> MacroExpansion;
+	};
+
+	// **********************************************************************
+	/// <summary>
+	/// A compiled ast: instructions, constants pool and register count.
+	/// The symbols of a function body are resolved at compile time to lexical addresses:
+	/// local variables (formal arguments and variables defined with def) are 
+	/// stored in slots, all other symbols (globals, closure variables and 
+	/// functions) are bound to the value cell of their scope at run time.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispCode
+	{
+	public:
+		inline LispCode()
+			: RegisterCount(0), IsFunctionBody(false), NeedsCallScope(false)
+		{
+		}
+
+		/*public*/ std::vector<LispInstruction> Instructions;
+
+		/*public*/ std::vector<std::shared_ptr<object>> Constants;
+
+		/*public*/ std::vector<std::shared_ptr<object>> Symbols;
+
+		/*public*/ std::vector<string> SymbolNames;
+
+		/// <summary>
+		/// The interned ids of the symbols, see <see cref="LispSymbolTable"/>.
+		/// </summary>
+		/*public*/ std::vector<size_t> SymbolIds;
+
+		/*public*/ std::vector<std::shared_ptr<LispToken>> Tokens;
+
+		/*public*/ std::vector<LispCallSite> CallSites;
+
+		/*public*/ size_t RegisterCount;
+
+		/// <summary>
+		/// The names of the local variables of a function body.
+		/// </summary>
+		/*public*/ std::vector<string> SlotNames;
+
+		/// <summary>
+		/// The local slot of each symbol or <see cref="NoSlot"/> (function bodies only), 
+		/// a symbol may be compiled before the def of the local variable.
+		/// </summary>
+		/*public*/ std::vector<size_t> SymbolSlots;
+
+		/// <summary>
+		/// Is this code the body of a function, 
+		/// only function bodies have local slots.
+		/// </summary>
+		/*public*/ bool IsFunctionBody;
+
+		/// <summary>
+		/// Does a call of this function body need the scope of the call from the start?
+		/// True if the body uses _args or _additionalArgs or the formal arguments are not unique,
+		/// otherwise the virtual machine keeps the local variables in slots until a scope is needed.
+		/// </summary>
+		/*public*/ bool NeedsCallScope;
+
+		/// <summary>
+		/// The (macro expanded) ast for this code, 
+		/// needed if the code is executed by the ast interpreter.
+		/// </summary>
+		/*public*/ std::shared_ptr<object> Ast;
+	};
+
+	// **********************************************************************
+	/// <summary>
+	/// The FUEL byte code compiler.
+	/// Translates a macro expanded ast into byte code for the <see cref="LispVirtualMachine"/>.
+	/// The special forms do, begin, if, while, and, or, def, gdef, setf and quote are 
+	/// translated into jumps and register operations, all other calls are 
+	/// resolved and executed at run time (like the ast interpreter does).
+	/// The expansions of the macros evaluated at run time use eval, rval and 
+	/// quoted lists, these patterns are translated too: the evaluation of a quoted 
+	/// list with eval, (eval '(...)), is translated like the list itself, a list 
+	/// created for eval, (eval (list ...)), is evaluated without creating the list,
+	/// (setf (rval expr) value) sets the symbol which is the result of expr and 
+	/// the elements of quoted lists, (first '(...)) and (nth i '(...)), are constants
+	/// if no lvalue is needed.
+	/// Calls in tail position of a function body (the body itself, the last 
+	/// expression of do and the branches of if) are marked as tail calls.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispCompiler
+	{
+	public:
+		//#region public methods
+
+		/// <summary>
+		/// Compiles the given ast.
+		/// </summary>
+		/// <param name="ast">The macro expanded ast.</param>
+		/// <param name="scope">The scope, used to detect the builtin special forms.</param>
+		/// <returns>The compiled code.</returns>
+		/*public*/ static std::shared_ptr<LispCode> Compile(std::shared_ptr<object> ast, std::shared_ptr<LispScope> scope);
+
+		/// <summary>
+		/// Compiles the given ast as body of a function with the given formal arguments.
+		/// The formal arguments are stored in the first local slots.
+		/// </summary>
+		/// <param name="ast">The macro expanded ast.</param>
+		/// <param name="scope">The scope, used to detect the builtin special forms.</param>
+		/// <param name="formalArguments">The names of the formal arguments.</param>
+		/// <returns>The compiled code.</returns>
+		/*public*/ static std::shared_ptr<LispCode> CompileFunction(std::shared_ptr<object> ast, std::shared_ptr<LispScope> scope, const std::vector<string> & formalArguments);
+
+		//#endregion
+
+	private:
+		//#region private methods
+
+		/*private*/ static void CompileExpression(LispCode & code, std::shared_ptr<object> ast, size_t target, size_t free, std::shared_ptr<LispScope> globalScope, bool isTail = false);
+		/*private*/ static void CompileArgument(LispCode & code, std::shared_ptr<object> ast, size_t target, size_t free, std::shared_ptr<LispScope> globalScope);
+		/*private*/ static void CompileCall(LispCode & code, std::shared_ptr<object> ast, const IEnumerable<std::shared_ptr<object>> & astAsList, size_t target, size_t free, std::shared_ptr<LispScope> globalScope, bool isTail);
+		/*private*/ static bool CompileSpecialForm(LispCode & code, const string & name, const IEnumerable<std::shared_ptr<object>> & astAsList, size_t target, size_t free, std::shared_ptr<LispScope> globalScope, bool isTail);
+
+		//#endregion
+	};
+}
+
+#endif
@@ -8,8 +8,19 @@ SOURCES += \
         $$PWD/Parser.cpp \
         $$PWD/Environment.cpp \
         $$PWD/Interpreter.cpp \
+        $$PWD/Compiler.cpp \
+        $$PWD/VirtualMachine.cpp \
         $$PWD/Scope.cpp \
+        $$PWD/Symbol.cpp \
+        $$PWD/Profiler.cpp \
+        $$PWD/ThreadPool.cpp \
+        $$PWD/Runtime.cpp \
+        $$PWD/RuntimeStatistics.cpp \
+        $$PWD/ModuleCache.cpp \
+        $$PWD/Reader.cpp \
+        $$PWD/List.cpp \
         $$PWD/Variant.cpp \
+        $$PWD/Dictionary.cpp \
         $$PWD/Utils.cpp \
         $$PWD/Exception.cpp \
         $$PWD/Lisp.cpp \
@@ -21,12 +32,24 @@ HEADERS += \
         $$PWD/cstypes.h \
         $$PWD/csexception.h \
         $$PWD/Interpreter.h \
+        $$PWD/Compiler.h \
+        $$PWD/VirtualMachine.h \
         $$PWD/Token.h \
+        $$PWD/Arena.h \
         $$PWD/Tokenizer.h \
         $$PWD/Parser.h \
         $$PWD/Environment.h \
         $$PWD/Scope.h \
+        $$PWD/Symbol.h \
+        $$PWD/Profiler.h \
+        $$PWD/ThreadPool.h \
+        $$PWD/Runtime.h \
+        $$PWD/RuntimeStatistics.h \
+        $$PWD/ModuleCache.h \
+        $$PWD/Reader.h \
+        $$PWD/List.h \
         $$PWD/Variant.h \
+        $$PWD/Dictionary.h \
         $$PWD/Exception.h \
         $$PWD/DebuggerInterface.h \
         $$PWD/Utils.h \
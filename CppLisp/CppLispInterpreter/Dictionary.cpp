@@ -0,0 +1,175 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "Dictionary.h"
+
+#include <mutex>
+
+namespace CppLisp
+{
+	// protects the creation of the views, a dictionary can be read by several threads
+	static std::mutex g_ViewsLock;
+
+	static inline bool HasHash(const object & value)
+	{
+		switch (value.GetType())
+		{
+			case __Undefined:
+			case __Nil:
+			case __Bool:
+			case __Int:
+			case __Double:
+			case __String:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	LispDictionary::LispDictionary(bool hasValueIndex)
+		: m_UnindexedValues(0), m_HasValueIndex(hasValueIndex)
+	{
+	}
+
+	void LispDictionary::AddToValueIndex(const std::shared_ptr<object> & value)
+	{
+		if (HasHash(*value))
+		{
+			m_ValueIndex[value]++;
+		}
+		else
+		{
+			m_UnindexedValues++;
+		}
+	}
+
+	void LispDictionary::RemoveFromValueIndex(const std::shared_ptr<object> & value)
+	{
+		if (HasHash(*value))
+		{
+			size_t * count = m_ValueIndex.FindValue(value);
+			if (count != 0 && --(*count) == 0)
+			{
+				m_ValueIndex.Remove(value);
+			}
+		}
+		else
+		{
+			m_UnindexedValues--;
+		}
+	}
+
+	void LispDictionary::ResetViews()
+	{
+		m_KeysView.reset();
+		m_ValuesView.reset();
+	}
+
+	void LispDictionary::Set(const LispVariant & key, const std::shared_ptr<object> & value)
+	{
+		std::shared_ptr<object> & item = BaseType::operator[](key);
+		if (m_HasValueIndex)
+		{
+			if (item != null)
+			{
+				RemoveFromValueIndex(item);
+			}
+			AddToValueIndex(value);
+		}
+		item = value;
+		ResetViews();
+	}
+
+	bool LispDictionary::Remove(const LispVariant & key)
+	{
+		std::shared_ptr<object> * item = BaseType::FindValue(key);
+		if (item == 0)
+		{
+			return false;
+		}
+		if (m_HasValueIndex)
+		{
+			RemoveFromValueIndex(*item);
+		}
+		BaseType::Remove(key);
+		ResetViews();
+		return true;
+	}
+
+	void LispDictionary::Clear()
+	{
+		BaseType::Clear();
+		m_ValueIndex.Clear();
+		m_UnindexedValues = 0;
+		ResetViews();
+	}
+
+	bool LispDictionary::ContainsValue(const std::shared_ptr<object> & value) const
+	{
+		if (!m_HasValueIndex)
+		{
+			return BaseType::ContainsValue(value);
+		}
+		if (HasHash(*value))
+		{
+			// values of different types are never equal, so a value with hash can only be found in the index
+			return m_ValueIndex.ContainsKey(value);
+		}
+		return m_UnindexedValues > 0 && BaseType::ContainsValue(value);
+	}
+
+	std::shared_ptr<object> LispDictionary::GetKeysView() const
+	{
+		std::lock_guard<std::mutex> guard(g_ViewsLock);
+		if (m_KeysView == null)
+		{
+			IEnumerable<std::shared_ptr<object>> keys;
+			keys.reserve(size());
+			for (const auto & kvp : *this)
+			{
+				keys.push_back(std::make_shared<object>(kvp.first));
+			}
+			m_KeysView = std::make_shared<object>(keys);
+		}
+		// the copy shares the list with the view until one of them is modified
+		return std::make_shared<object>(*m_KeysView);
+	}
+
+	std::shared_ptr<object> LispDictionary::GetValuesView() const
+	{
+		std::lock_guard<std::mutex> guard(g_ViewsLock);
+		if (m_ValuesView == null)
+		{
+			IEnumerable<std::shared_ptr<object>> values;
+			values.reserve(size());
+			for (const auto & kvp : *this)
+			{
+				values.push_back(std::make_shared<object>(LispVariant(kvp.second)));
+			}
+			m_ValuesView = std::make_shared<object>(values);
+		}
+		return std::make_shared<object>(*m_ValuesView);
+	}
+}
@@ -0,0 +1,150 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_DICTIONARY_H
+#define _LISP_DICTIONARY_H
+
+#include "cstypes.h"
+#include "csstring.h"
+#include "csobject.h"
+#include "Variant.h"
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Hash function for values in the value index of a <see cref="LispDictionary"/>.
+	/// </summary>
+	struct ObjectValueHash
+	{
+		inline size_t operator()(const std::shared_ptr<object> & value) const
+		{
+			return value->GetHash(null);
+		}
+	};
+
+	/// <summary>
+	/// Equality of values in the value index of a <see cref="LispDictionary"/>.
+	/// </summary>
+	struct ObjectValueEqual
+	{
+		inline bool operator()(const std::shared_ptr<object> & l, const std::shared_ptr<object> & r) const
+		{
+			return *l == *r;
+		}
+	};
+
+	/// <summary>
+	/// The dictionary of the fuel dict objects (make-dict), a hash table 
+	/// which uses the hash and the equality of the key values.
+	/// All modifications are done with Set, Remove and Clear, so the 
+	/// dictionary can maintain the optional value index and the views.
+	/// The views are lists of the keys or of the values, which are created
+	/// once per modification of the dictionary and which are shared (copy
+	/// on write) by all callers of GetKeysView and GetValuesView.
+	/// The views are created under a lock, so the dictionary can be read
+	/// by several threads at the same time (see pmap).
+	/// </summary>
+	/*public*/ class DLLEXPORT LispDictionary : private HashDictionary<LispVariant, std::shared_ptr<object>, LispVariantKeyHash, LispVariantKeyEqual>
+	{
+	public:
+		typedef HashDictionary<LispVariant, std::shared_ptr<object>, LispVariantKeyHash, LispVariantKeyEqual> BaseType;
+		typedef BaseType::const_iterator const_iterator;
+
+	private:
+		/// <summary>
+		/// Number of occurrences of every value, only if the value index is enabled.
+		/// Values without hash (lists, functions, ...) are only counted in m_UnindexedValues.
+		/// </summary>
+		HashDictionary<std::shared_ptr<object>, size_t, ObjectValueHash, ObjectValueEqual> m_ValueIndex;
+		size_t m_UnindexedValues;
+		bool m_HasValueIndex;
+
+		mutable std::shared_ptr<object> m_KeysView;
+		mutable std::shared_ptr<object> m_ValuesView;
+
+		void AddToValueIndex(const std::shared_ptr<object> & value);
+		void RemoveFromValueIndex(const std::shared_ptr<object> & value);
+		void ResetViews();
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="LispDictionary"/> class.
+		/// </summary>
+		/// <param name="hasValueIndex">Maintain a reverse index of the values, which makes ContainsValue O(1).</param>
+		explicit LispDictionary(bool hasValueIndex = false);
+
+		inline const_iterator begin() const
+		{
+			return BaseType::begin();
+		}
+		inline const_iterator end() const
+		{
+			return BaseType::end();
+		}
+
+		using BaseType::size;
+		using BaseType::empty;
+
+		inline bool HasValueIndex() const
+		{
+			return m_HasValueIndex;
+		}
+
+		/// <summary>
+		/// Returns the value of the key or null, needs only one probe sequence.
+		/// </summary>
+		inline const std::shared_ptr<object> * FindValue(const LispVariant & key) const
+		{
+			return BaseType::FindValue(key);
+		}
+
+		inline bool ContainsKey(const LispVariant & key, std::shared_ptr<object> * pValue = 0) const
+		{
+			return BaseType::ContainsKey(key, pValue);
+		}
+
+		void Set(const LispVariant & key, const std::shared_ptr<object> & value);
+		bool Remove(const LispVariant & key);
+		void Clear();
+
+		/// <summary>
+		/// Determines whether the value is contained in the dictionary,
+		/// O(1) with value index for values with a hash, otherwise O(n).
+		/// </summary>
+		bool ContainsValue(const std::shared_ptr<object> & value) const;
+
+		/// <summary>
+		/// Returns a list of the keys in insertion order (a new key may take the place of a removed key).
+		/// </summary>
+		std::shared_ptr<object> GetKeysView() const;
+
+		/// <summary>
+		/// Returns a list of the values in the order of the keys.
+		/// </summary>
+		std::shared_ptr<object> GetValuesView() const;
+	};
+}
+
+#endif
@@ -24,15 +24,23 @@
 * */
 
 #include "Scope.h"
+#include "Dictionary.h"
 #include "Exception.h"
 #include "Interpreter.h"
+#include "VirtualMachine.h"
 #include "Lisp.h"
+#include "Symbol.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "ModuleCache.h"
+#include "RuntimeStatistics.h"
 
 #include <map>
 #include <fstream>
 
 #include <chrono>
 #include <thread>
+#include <mutex>
 
 #include <ctime>
 
@@ -56,6 +64,8 @@ const string Defn = "defn";
 const string Gdefn = "gdefn";
 const string MapFcn = "map";
 const string ReduceFcn = "reduce";
+const string ParallelMapFcn = "pmap";
+const string ParallelReduceFcn = "preduce";
 const string DefineMacro = "define-macro";      // == define-macro-eval
 const string DefineMacroEval = "define-macro-eval";
 #ifdef ENABLE_COMPILE_TIME_MACROS 
@@ -85,6 +95,10 @@ const string LispEnvironment::Apply = "apply";
 const string LispEnvironment::Eval = "eval";
 const string LispEnvironment::EvalStr = "evalstr";
 const string LispEnvironment::Quote = "quote";
+const string LispEnvironment::List = "list";
+const string LispEnvironment::FirstFcn = "first";
+const string LispEnvironment::NthFcn = "nth";
+const string LispEnvironment::RVal = "rval";
 const string LispEnvironment::Quasiquote = "quasiquote";   
 const string LispEnvironment::UnQuote = "_unquote";
 const string LispEnvironment::UnQuoteSplicing = "_unquotesplicing";
@@ -92,12 +106,17 @@ const string LispEnvironment::UnQuoteSplicing = "_unquotesplicing";
 const string LispEnvironment::Sym = "sym";
 const string LispEnvironment::Str = "str";
 
-// ************************************************************************
+const string LispEnvironment::If = /*If*/"if";
+const string LispEnvironment::While = /*While*/"while";
+const string LispEnvironment::Do = /*Do*/"do";
+const string LispEnvironment::Begin = /*Begin*/"begin";
+const string LispEnvironment::And = /*And*/"and";
+const string LispEnvironment::Or = /*Or*/"or";
+const string LispEnvironment::Def = /*Def*/"def";
+const string LispEnvironment::Gdef = /*Gdef*/"gdef";
+const string LispEnvironment::Setf = /*Setf*/"setf";
 
-namespace CppLisp
-{
-	string LispUtils_LibraryPath = string::Empty;
-}
+// ************************************************************************
 
 static bool File_Exists(const string & fileName)
 {
@@ -167,6 +186,25 @@ static void CheckOptionalArgs(const string & name, size_t minCount, size_t maxCo
 	}
 }
 
+// creates the result of a builtin function, bool and int values are immediate values
+template <class T>
+static std::shared_ptr<LispVariant> CreateResult(const T & result)
+{
+	return std::make_shared<LispVariant>(std::make_shared<object>(result));
+}
+
+template <>
+std::shared_ptr<LispVariant> CreateResult<bool>(const bool & result)
+{
+	return std::make_shared<LispVariant>(result);
+}
+
+template <>
+std::shared_ptr<LispVariant> CreateResult<int>(const int & result)
+{
+	return std::make_shared<LispVariant>(result);
+}
+
 template <class T1>
 static std::shared_ptr<LispVariant> FuelFuncWrapper0(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope, const string & func_name, std::function<T1()> func)
 {
@@ -174,7 +212,7 @@ static std::shared_ptr<LispVariant> FuelFuncWrapper0(const std::vector<std::shar
 
 	const T1 & result = func();
 
-	return std::make_shared<LispVariant>(std::make_shared<object>(result));
+	return CreateResult(result);
 }
 
 template <class T1, class T2>
@@ -185,7 +223,7 @@ static std::shared_ptr<LispVariant> FuelFuncWrapper1(const std::vector<std::shar
 	const T1 & a1 = ToType<T1>(args[0]->ToLispVariantRef());
 	const T2 & result = func(a1);
 
-	return std::make_shared<LispVariant>(std::make_shared<object>(result));
+	return CreateResult(result);
 }
 
 template <class T1, class T2, class T3>
@@ -197,7 +235,7 @@ static std::shared_ptr<LispVariant> FuelFuncWrapper2(const std::vector<std::shar
 	const T2 & a2 = ToType<T2>(args[1]->ToLispVariantRef());
 	const T3 & result = func(a1, a2);
 
-	return std::make_shared<LispVariant>(std::make_shared<object>(result));
+	return CreateResult(result);
 }
 
 template <class T1, class T2, class T3, class T4>
@@ -210,7 +248,7 @@ static std::shared_ptr<LispVariant> FuelFuncWrapper2(const std::vector<std::shar
 	const T3 & a3 = ToType<T3>(args[2]->ToLispVariantRef());
 	const T4 & result = func(a1, a2);
 
-	return std::make_shared<LispVariant>(std::make_shared<object>(result));
+	return CreateResult(result);
 }
 
 /* not needed yet...
@@ -229,10 +267,11 @@ static const std::vector<std::shared_ptr<object>> GetCallArgs(const std::vector<
 }
 */
 
-static std::shared_ptr<object> CreateFunction(FuncX func, const string & signature = /*null*/"", const string & documentation = /*null*/"", bool isBuiltin = true, bool isSpecialForm = false, bool isEvalInExpand = false, const string & moduleName = Builtin)
+static std::shared_ptr<object> CreateFunction(FuncX func, const string & signature = /*null*/"", const string & documentation = /*null*/"", bool isBuiltin = true, bool isSpecialForm = false, bool isEvalInExpand = false, const string & moduleName = Builtin, std::shared_ptr<LispUserFunction> userFunction = null)
 {
 	LispFunctionWrapper wrapper;
 	wrapper.Function = func;
+	wrapper.UserFunction = userFunction;
 	wrapper.Signature = signature;
 	wrapper.ModuleName = moduleName;
 	wrapper.Documentation = documentation;
@@ -242,6 +281,18 @@ static std::shared_ptr<object> CreateFunction(FuncX func, const string & signatu
 	return std::make_shared<object>(LispVariant(LispType::_Function, std::make_shared<object>(wrapper)));
 }
 
+static std::shared_ptr<object> CreateOperatorFunction(FuncX func, LispOperator nativeOperator, const string & signature, const string & documentation)
+{
+	LispFunctionWrapper wrapper;
+	wrapper.Function = func;
+	wrapper.Operator = nativeOperator;
+	wrapper.Signature = signature;
+	wrapper.ModuleName = Builtin;
+	wrapper.Documentation = documentation;
+	wrapper.SetBuiltin(true);
+	return std::make_shared<object>(LispVariant(LispType::_Function, std::make_shared<object>(wrapper)));
+}
+
 static std::shared_ptr<LispVariant> EvalArgIfNeeded(std::shared_ptr<object> arg, std::shared_ptr<LispScope> scope)
 {
 	return (arg->IsIEnumerableOfObject() /*is IEnumerable<object>*/ || arg->IsList()) ? LispInterpreter::EvalAst(arg, scope) : arg->ToLispVariant();
@@ -431,6 +482,68 @@ static std::shared_ptr<LispVariant> _Sleep(const std::vector<std::shared_ptr<obj
 	return std::make_shared<LispVariant>(LispVariant());
 }
 
+static std::shared_ptr<LispVariant> ProfileStart(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckOptionalArgs("profile-start", 0, 1, args, scope);
+
+	var intervalInMs = args.size() > 0 ? args[0]->ToLispVariantRef().ToInt() : LispProfiler::DefaultIntervalInMs;
+	LispProfiler::Start(intervalInMs);
+	return std::make_shared<LispVariant>(LispVariant());
+}
+
+static std::shared_ptr<LispVariant> ProfileStop(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckOptionalArgs("profile-stop", 0, 1, args, scope);
+
+	LispProfiler::Stop();
+	if (args.size() > 0)
+	{
+		WriteTextFile(args[0]->ToLispVariantRef().ToString(), LispProfiler::GetFoldedStacks());
+	}
+	return std::make_shared<LispVariant>(std::make_shared<object>(LispProfiler::GetFlatReport()));
+}
+
+static void AddStatistic(LispDictionary & dict, const string & name, size_t value)
+{
+	dict.Set(LispVariant(std::make_shared<object>(name)), std::make_shared<object>((int)value));
+}
+
+static std::shared_ptr<LispVariant> RuntimeStats(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckArgs("runtime-stats", 0, args, scope);
+
+	const LispRuntimeStatistics statistics = Lisp::GetRuntimeStatistics();
+	LispDictionary dict;
+	dict.Set(LispVariant(std::make_shared<object>("enabled")), std::make_shared<object>(LispRuntimeStatistics::IsEnabled()));
+	AddStatistic(dict, "eval-ast-calls", statistics.EvalAstCalls);
+	AddStatistic(dict, "function-calls", statistics.FunctionCalls);
+	AddStatistic(dict, "function-scopes", statistics.FunctionScopes);
+	AddStatistic(dict, "object-allocations", statistics.ObjectAllocations);
+	AddStatistic(dict, "object-copies", statistics.ObjectCopies);
+	AddStatistic(dict, "payload-copies", statistics.PayloadCopies);
+	AddStatistic(dict, "macro-expansions", statistics.MacroExpansions);
+	AddStatistic(dict, "local-resolves", statistics.LocalResolves);
+	AddStatistic(dict, "global-resolves", statistics.GlobalResolves);
+	AddStatistic(dict, "closure-resolves", statistics.ClosureResolves);
+	AddStatistic(dict, "module-resolves", statistics.ModuleResolves);
+	AddStatistic(dict, "unresolved-symbols", statistics.UnresolvedSymbols);
+	AddStatistic(dict, "exceptions", statistics.ExceptionsThrown);
+	AddStatistic(dict, "call-site-cache-hits", statistics.CallSiteCacheHits);
+	AddStatistic(dict, "call-site-cache-misses", statistics.CallSiteCacheMisses);
+	AddStatistic(dict, "module-cache-hits", statistics.ModuleCacheHits);
+	AddStatistic(dict, "module-cache-misses", statistics.ModuleCacheMisses);
+	AddStatistic(dict, "symbol-table-locks", statistics.SymbolTableLocks);
+	return std::make_shared<LispVariant>(LispVariant(LispType::_NativeObject, std::make_shared<object>(dict)));
+}
+
+static std::shared_ptr<LispVariant> ResetRuntimeStats(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckArgs("reset-runtime-stats", 0, args, scope);
+
+	Lisp::ResetRuntimeStatistics();
+	return std::make_shared<LispVariant>(LispVariant());
+}
+
 static std::shared_ptr<LispVariant> Datetime(const std::vector<std::shared_ptr<object>> & /*args*/, std::shared_ptr<LispScope> /*scope*/)
 {
 	std::time_t t = std::time(0);   // get time now
@@ -498,11 +611,6 @@ static string AddFileExtensionIfNeeded(string fileName)
 	return fileName;
 }
 
-namespace CppLisp
-{
-	extern string LispUtils_LibraryPath;
-}
-
 #if defined(_WIN32) || defined(_WIN64)
 const std::string DirectorySeparatorChar("\\");
 const std::string OtherDirectorySeparatorChar("/");
@@ -516,52 +624,97 @@ string ConvertToLocalDirectorySeperators(const string & path)
 	return path.Replace(OtherDirectorySeparatorChar, DirectorySeparatorChar);
 }
 
-static std::shared_ptr<LispVariant> Import(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+static string FindModuleFile(const string & orgModuleFileName, std::shared_ptr<LispScope> scope)
 {
-	std::shared_ptr<LispVariant> result = std::make_shared<LispVariant>();
-	for(var modu : args)
+	string fileName = orgModuleFileName;
+	if (!File_Exists(fileName))
 	{
-		string code = string::Empty;
-		string orgModuleFileName = ConvertToLocalDirectorySeperators(modu->ToLispVariantRef().StringValue());
-		string fileName = orgModuleFileName;
+		// try the given library path (if available)
+		fileName = scope->GlobalScope->Runtime->LibraryPath + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
+		fileName = AddFileExtensionIfNeeded(fileName);
 		if (!File_Exists(fileName))
 		{
-			// try the given library path (if available)
-			fileName = LispUtils_LibraryPath + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
-			fileName = AddFileExtensionIfNeeded(fileName);
+			// try default path .\Library\modulename.fuel
+			fileName = "." + /*Path.*/DirectorySeparatorChar + "Library" + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
+			fileName = AddFileExtensionIfNeeded(fileName);		
 			if (!File_Exists(fileName))
 			{
-				// try default path .\Library\modulename.fuel
-				fileName = "." + /*Path.*/DirectorySeparatorChar + "Library" + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
-				fileName = AddFileExtensionIfNeeded(fileName);		
+				// try default path for visiscript .\lib\fuel\modulename.fuel
+				fileName = "." + /*Path.*/DirectorySeparatorChar + "lib" + /*Path.*/DirectorySeparatorChar + "fuel" + DirectorySeparatorChar + orgModuleFileName;
+				fileName = AddFileExtensionIfNeeded(fileName);
 				if (!File_Exists(fileName))
 				{
-					// try default path for visiscript .\lib\fuel\modulename.fuel
-					fileName = "." + /*Path.*/DirectorySeparatorChar + "lib" + /*Path.*/DirectorySeparatorChar + "fuel" + DirectorySeparatorChar + orgModuleFileName;
-					fileName = AddFileExtensionIfNeeded(fileName);
-					if (!File_Exists(fileName))
-					{
 
-						//			// try default path <fuel.exe-path>\Library\modulename.fuel
-						//// TODO			fileName = AppDomain.CurrentDomain.BaseDirectory + /*Path.*/DirectorySeparatorChar + "Library" + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
-						//			fileName = AddFileExtensionIfNeeded(fileName);
-						//			if (!File_Exists(fileName))
+					//			// try default path <fuel.exe-path>\Library\modulename.fuel
+					//// TODO			fileName = AppDomain.CurrentDomain.BaseDirectory + /*Path.*/DirectorySeparatorChar + "Library" + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
+					//			fileName = AddFileExtensionIfNeeded(fileName);
+					//			if (!File_Exists(fileName))
+					{
+						// try environment variable FUELPATH
+						//string envPath = Environment.GetEnvironmentVariable("FUELPATH");
+						char * envPath = getenv("FUELPATH");
+						if (envPath != null)
 						{
-							// try environment variable FUELPATH
-							//string envPath = Environment.GetEnvironmentVariable("FUELPATH");
-							char * envPath = getenv("FUELPATH");
-							if (envPath != null)
-							{
-								fileName = envPath + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
-								fileName = AddFileExtensionIfNeeded(fileName);
-							}
+							fileName = envPath + /*Path.*/DirectorySeparatorChar + orgModuleFileName;
+							fileName = AddFileExtensionIfNeeded(fileName);
 						}
 					}
 				}
 			}
 		}
+	}
+	return fileName;
+}
+
+// returns the absolute path of an existing file without . and .. (and without links if supported)
+static string GetFullPath(const string & fileName)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	char * fullPath = _fullpath(null, fileName.c_str(), 0);
+#else
+	char * fullPath = realpath(fileName.c_str(), null);
+#endif
+	if (fullPath == null)
+	{
+		return fileName;
+	}
+	string result = fullPath;
+	free(fullPath);
+	return result;
+}
+
+static std::shared_ptr<LispVariant> ImportModules(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope, bool reload)
+{
+	std::shared_ptr<LispVariant> result = std::make_shared<LispVariant>();
+	const std::shared_ptr<LispRuntime> & runtime = scope->GlobalScope->Runtime;
+	var modules = ((*(scope->GlobalScope))[LispEnvironment::Modules])->GetLispScopeRef();
+	for(var modu : args)
+	{
+		string code = string::Empty;
+		string orgModuleFileName = ConvertToLocalDirectorySeperators(modu->ToLispVariantRef().StringValue());
+
+		// an imported module is found without probing the file system
+		string moduleName;
+		if (!reload && runtime->ModuleRegistry.ContainsKey(orgModuleFileName, &moduleName) && modules->ContainsKey(moduleName))
+		{
+			continue;
+		}
+
+		string fileName = FindModuleFile(orgModuleFileName, scope);
+		string fullPath = string::Empty;
 		if (File_Exists(fileName))
 		{
+			// a module imported with another name or path is the same module
+			fullPath = GetFullPath(fileName);
+			if (runtime->ModuleRegistry.ContainsKey(fullPath, &moduleName) && modules->ContainsKey(moduleName))
+			{
+				runtime->ModuleRegistry[orgModuleFileName] = moduleName;
+				if (!reload)
+				{
+					continue;
+				}
+				fileName = moduleName;
+			}
 			code = ReadFileOrEmptyString(fileName);
 		}
 		else
@@ -582,10 +735,14 @@ static std::shared_ptr<LispVariant> Import(const std::vector<std::shared_ptr<obj
 			var importScope = std::make_shared<LispScope>("import " + fileName, scope->GlobalScope, std::make_shared<string>(fileName), scope->Output, scope->Input);
 			scope->PushNextScope(importScope);
 
-			result = Lisp::Eval(code, importScope, fileName);
+			string cacheFileName = runtime->UseModuleCache ? LispModuleCache::GetCacheFileName(fileName, runtime->ModuleCachePath) : string::Empty;
+			result = Lisp::Eval(code, importScope, fileName, /*tracing:*/ false, /*outp:*/ null, /*inp:*/ null, /*onlyMacroExpand:*/ false, cacheFileName);
 
 			// add new module to modules scope
-			(*(((*(scope->GlobalScope))[LispEnvironment::Modules])->GetLispScopeRef()))[fileName] = std::make_shared<object>(*importScope); // .Add(fileName, importScope);
+			(*modules)[fileName] = std::make_shared<object>(*importScope); // .Add(fileName, importScope);
+			LispEnvironment::RebuildModuleIndex(scope->GlobalScope);
+			runtime->ModuleRegistry[orgModuleFileName] = fileName;
+			runtime->ModuleRegistry[fullPath] = fileName;
 
 			scope->PopNextScope();
 		}
@@ -593,6 +750,16 @@ static std::shared_ptr<LispVariant> Import(const std::vector<std::shared_ptr<obj
 	return result;
 }
 
+static std::shared_ptr<LispVariant> Import(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	return ImportModules(args, scope, /*reload:*/ false);
+}
+
+static std::shared_ptr<LispVariant> Reload(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	return ImportModules(args, scope, /*reload:*/ true);
+}
+
 static std::shared_ptr<LispVariant> Nop(const std::vector<std::shared_ptr<object>> & /*args*/, std::shared_ptr<LispScope> /*scope*/)
 {
 	return std::make_shared<LispVariant>(LispVariant());
@@ -812,6 +979,16 @@ static std::shared_ptr<LispVariant> Slice(const std::vector<std::shared_ptr<obje
 {
 	CheckArgs("slice", 3, args, scope);
 
+	const LispVariant & val = args[0]->ToLispVariantRef();
+	if (val.IsList())
+	{
+		// the slice shares the elements with the list, a negative length means up to the end of the list
+		const LispList & elements = val.LispListValueRef();
+		var startPos = args[1]->ToLispVariantRef().ToInt();
+		var len = args[2]->ToLispVariantRef().ToInt();
+		return std::make_shared<LispVariant>(std::make_shared<object>(elements.Slice(startPos >= 0 ? (size_t)startPos : elements.Count(), len >= 0 ? (size_t)len : elements.Count())));
+	}
+
 	var value = ((LispVariant)args[0]).ToString();
 	var startPos = (size_t)((LispVariant)args[1]).ToInt();
 	var len = ((LispVariant)args[2]).ToInt();
@@ -855,31 +1032,65 @@ static std::shared_ptr<LispVariant> UpperCase(const std::vector<std::shared_ptr<
 	return FuelFuncWrapper1<string, string>(args, scope, "upper-case", [](const string & arg1) -> string { return arg1.ToUpper();  });
 }
 
-static std::shared_ptr<LispVariant> ArithmetricOperation(const std::vector<std::shared_ptr<object>> & args, std::function<std::shared_ptr<LispVariant>(std::shared_ptr<LispVariant>, std::shared_ptr<LispVariant>)> op)
+// returns true if all arguments are bool, int or double values
+static bool GetImmediateArgs(const std::vector<std::shared_ptr<object>> & args, LispImmediate * values)
 {
-	std::shared_ptr<LispVariant> result(null);
-	for (var elem : args)
+	for (size_t i = 0; i < args.size(); i++)
 	{
-		if (result == null)
+		if (!args[i]->IsLispVariant() || !args[i]->ToLispVariantRef().ToImmediate(values[i]))
 		{
-			result = std::make_shared<LispVariant>(LispVariant(elem));
+			return false;
 		}
-		else
+	}
+	return true;
+}
+
+template <class Op>
+static std::shared_ptr<LispVariant> ArithmetricOperation(const std::vector<std::shared_ptr<object>> & args, LispOperator nativeOp, Op op)
+{
+	// the operands and intermediate results are not allocated on the heap
+	if (args.size() == 0)
+	{
+		return null;
+	}
+	if (args.size() == 1)
+	{
+		return std::make_shared<LispVariant>(args[0]);
+	}
+	// fast path for numbers
+	if (args.size() == 2)
+	{
+		LispImmediate values[2];
+		if (GetImmediateArgs(args, values) && LispVariant::NativeOperation(nativeOp, values[0], values[1], values[0]))
 		{
-			result = op(result, std::make_shared<LispVariant>(LispVariant(elem)));
+			return values[0].ToLispVariant();
 		}
 	}
+	std::shared_ptr<LispVariant> result = std::make_shared<LispVariant>(op(LispVariant(args[0]), LispVariant(args[1])));
+	for (size_t i = 2; i < args.size(); i++)
+	{
+		result = std::make_shared<LispVariant>(op(*result, LispVariant(args[i])));
+	}
 	return result;
 }
 
-static std::shared_ptr<LispVariant> CompareOperation(const std::vector<std::shared_ptr<object>> & args, std::function<bool(const LispVariant &, const LispVariant &)> op, std::shared_ptr<LispScope> scope, const string & name)
+template <class Op>
+static std::shared_ptr<LispVariant> CompareOperation(const std::vector<std::shared_ptr<object>> & args, LispOperator nativeOp, Op op, std::shared_ptr<LispScope> scope, const string & name)
 {
-	return FuelFuncWrapper2<LispVariant, LispVariant, bool>(args, scope, name, [op](const LispVariant & arg1, const LispVariant & arg2) -> bool { return op(arg1, arg2); });
+	CheckArgs(name, 2, args, scope);
+
+	// fast path for numbers, the arguments are not copied
+	LispImmediate values[2];
+	if (GetImmediateArgs(args, values) && LispVariant::NativeOperation(nativeOp, values[0], values[1], values[0]))
+	{
+		return values[0].ToLispVariant();
+	}
+	return std::make_shared<LispVariant>(op(args[0]->ToLispVariantRef(), args[1]->ToLispVariantRef()));
 }
 
 static std::shared_ptr<LispVariant> Addition(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
 {
-	return ArithmetricOperation(args, [](std::shared_ptr<LispVariant> l, std::shared_ptr<LispVariant> r) -> std::shared_ptr<LispVariant> { return std::make_shared<LispVariant>(*l + *r); });
+	return ArithmetricOperation(args, OperatorAdd, [](const LispVariant & l, const LispVariant & r) -> LispVariant { return l + r; });
 }
 
 static std::shared_ptr<LispVariant> Subtraction(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
@@ -890,31 +1101,31 @@ static std::shared_ptr<LispVariant> Subtraction(const std::vector<std::shared_pt
 		var value = (LispVariant)args[0];
 		if (value.IsInt())
 		{
-			return std::make_shared<LispVariant>(std::make_shared<object>(-value.IntValue()));
+			return std::make_shared<LispVariant>(-value.IntValue());
 		}
 		if (value.IsDouble())
 		{
-			return std::make_shared<LispVariant>(std::make_shared<object>(-value.DoubleValue()));
+			return std::make_shared<LispVariant>(-value.DoubleValue());
 		}
 		throw LispExceptionBase(string::Format("Unary operator - not available for {0}", value.TypeString()));
 	}
 
-	return ArithmetricOperation(args, [](std::shared_ptr<LispVariant> l, std::shared_ptr<LispVariant> r) -> std::shared_ptr<LispVariant> { return std::make_shared<LispVariant>(*l - *r); });
+	return ArithmetricOperation(args, OperatorSubtract, [](const LispVariant & l, const LispVariant & r) -> LispVariant { return l - r; });
 }
 
 static std::shared_ptr<LispVariant> Multiplication(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
 {
-	return ArithmetricOperation(args, [](std::shared_ptr<LispVariant> l, std::shared_ptr<LispVariant> r) -> std::shared_ptr<LispVariant> { return std::make_shared<LispVariant>(*l * *r); });
+	return ArithmetricOperation(args, OperatorMultiply, [](const LispVariant & l, const LispVariant & r) -> LispVariant { return l * r; });
 }
 
 static std::shared_ptr<LispVariant> Division(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
 {
-	return ArithmetricOperation(args, [](std::shared_ptr<LispVariant> l, std::shared_ptr<LispVariant> r) -> std::shared_ptr<LispVariant> { return std::make_shared<LispVariant>(*l / *r); });
+	return ArithmetricOperation(args, OperatorDivide, [](const LispVariant & l, const LispVariant & r) -> LispVariant { return l / r; });
 }
 
 static std::shared_ptr<LispVariant> Modulo(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
 {
-	return ArithmetricOperation(args, [](std::shared_ptr<LispVariant> l, std::shared_ptr<LispVariant> r) -> std::shared_ptr<LispVariant> { return std::make_shared<LispVariant>(*l % *r); });
+	return ArithmetricOperation(args, OperatorModulo, [](const LispVariant & l, const LispVariant & r) -> LispVariant { return l % r; });
 }
 
 static std::shared_ptr<LispVariant> Not(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
@@ -924,32 +1135,32 @@ static std::shared_ptr<LispVariant> Not(const std::vector<std::shared_ptr<object
 
 static std::shared_ptr<LispVariant> LessTest(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	return CompareOperation(args, [](const LispVariant & l, const LispVariant & r) -> bool { return l < r; }, scope, "<");
+	return CompareOperation(args, OperatorLess, [](const LispVariant & l, const LispVariant & r) -> bool { return l < r; }, scope, "<");
 }
 
 static std::shared_ptr<LispVariant> GreaterTest(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	return CompareOperation(args, [](const LispVariant & l, const LispVariant & r) -> bool { return l > r; }, scope, ">");
+	return CompareOperation(args, OperatorGreater, [](const LispVariant & l, const LispVariant & r) -> bool { return l > r; }, scope, ">");
 }
 
 static std::shared_ptr<LispVariant> LessEqualTest(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	return CompareOperation(args, [](const LispVariant & l, const LispVariant & r) -> bool { return l <= r; }, scope, "<=");
+	return CompareOperation(args, OperatorLessEqual, [](const LispVariant & l, const LispVariant & r) -> bool { return l <= r; }, scope, "<=");
 }
 
 static std::shared_ptr<LispVariant> GreaterEqualTest(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	return CompareOperation(args, [](const LispVariant & l, const LispVariant & r) -> bool { return l >= r; }, scope, ">=");
+	return CompareOperation(args, OperatorGreaterEqual, [](const LispVariant & l, const LispVariant & r) -> bool { return l >= r; }, scope, ">=");
 }
 
 static std::shared_ptr<LispVariant> EqualTest(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	return CompareOperation(args, [](const LispVariant & l, const LispVariant & r) -> bool { return LispVariant::EqualOp(l, r); }, scope, "==");
+	return CompareOperation(args, OperatorEqual, [](const LispVariant & l, const LispVariant & r) -> bool { return LispVariant::EqualOp(l, r); }, scope, "==");
 }
 
 static std::shared_ptr<LispVariant> NotEqualTest(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	return CompareOperation(args, [](const LispVariant & l, const LispVariant & r) -> bool { return !LispVariant::EqualOp(l, r); }, scope, "!=");
+	return CompareOperation(args, OperatorNotEqual, [](const LispVariant & l, const LispVariant & r) -> bool { return !LispVariant::EqualOp(l, r); }, scope, "!=");
 }
 
 static std::shared_ptr<LispVariant> CreateList(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
@@ -1003,8 +1214,136 @@ static std::shared_ptr<LispVariant> Reduce(const std::vector<std::shared_ptr<obj
 	return result;
 }
 
+// more chunks than threads balance the different run times of the chunks
+const size_t ChunksPerThread = 4;
+
+// Counts the work of a chunk processed by another thread than the calling thread in the given 
+// statistics, the counters of the thread (i. e. of a waiting chunk) are restored afterwards.
+struct LispChunkStatisticsCounter
+{
+	LispRuntimeStatistics * Statistics;
+	LispRuntimeStatistics SavedStatistics;
+
+	LispChunkStatisticsCounter(LispRuntimeStatistics * statistics)
+		: Statistics(statistics), SavedStatistics(LispRuntimeStatistics::GetCurrent())
+	{
+		if (Statistics != null)
+		{
+			LispRuntimeStatistics::Reset();
+		}
+	}
+
+	~LispChunkStatisticsCounter()
+	{
+		if (Statistics != null)
+		{
+			*Statistics = LispRuntimeStatistics::GetCurrent();
+			LispRuntimeStatistics::Reset();
+			LispRuntimeStatistics::Add(SavedStatistics);
+		}
+	}
+};
+
+// Processes the elements 0 ... count-1 in chunks on the thread pool, processChunk is called with 
+// the chunk number, the first and the last + 1 element of the chunk and the scope of the chunk.
+// Thread safety: every chunk calls the function with its own child scope of the calling scope, 
+// the calling scope is not modified. The global scope, the closures of the function and the 
+// elements are shared by all chunks and are only read: the function must not define or modify 
+// global variables (gdef, setf of a global variable, import) or modify the elements, only the 
+// values created by the function belong to its chunk. The debugger and tracing are not thread 
+// safe, the chunks are processed one after the other if one of them is active.
+static void ProcessChunksInParallel(const string & functionName, size_t count, std::shared_ptr<LispScope> scope, const std::function<void(size_t, size_t, size_t, std::shared_ptr<LispScope>)> & processChunk)
+{
+	var globalScope = scope->GlobalScope;
+	bool isSerial = globalScope->Debugger != null || globalScope->Tracing;
+	size_t chunkCount = isSerial ? 1 : LispThreadPool::GetThreadCount() * ChunksPerThread;
+	chunkCount = chunkCount < count ? chunkCount : count;
+	// the runtime statistics are counted per thread, the work of the other threads is added to the calling thread
+	std::thread::id callingThread = std::this_thread::get_id();
+	std::vector<LispRuntimeStatistics> chunkStatistics(chunkCount, LispRuntimeStatistics());
+	LispThreadPool::ParallelFor(chunkCount, [&](size_t chunk)
+	{
+		LispChunkStatisticsCounter counter(std::this_thread::get_id() != callingThread ? &chunkStatistics[chunk] : null);
+		var chunkScope = std::make_shared<LispScope>(functionName, globalScope, std::make_shared<string>(scope->ModuleName), scope->Output, scope->Input);
+		chunkScope->Previous = scope;
+		processChunk(chunk, count * chunk / chunkCount, count * (chunk + 1) / chunkCount, chunkScope);
+	});
+	for (const var & statistics : chunkStatistics)
+	{
+		LispRuntimeStatistics::Add(statistics);
+	}
+}
+
+static std::shared_ptr<LispVariant> ParallelMap(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckArgs(ParallelMapFcn, 2, args, scope);
+
+	var function = CheckForFunction(ParallelMapFcn, args[0], scope)->FunctionValue();
+	var elements = LispEnvironment::CheckForList(ParallelMapFcn, args[1], scope);
+
+	// every chunk writes the results of its elements, so the order of the elements is kept
+	IEnumerable<std::shared_ptr<object>> list(elements->size());
+	ProcessChunksInParallel(ParallelMapFcn, elements->size(), scope, [&](size_t /*chunk*/, size_t first, size_t last, std::shared_ptr<LispScope> chunkScope)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			std::vector<std::shared_ptr<object>> args;
+			args.push_back(std::make_shared<object>(*((*elements)[i])));
+			list[i] = std::make_shared<object>(*(function.Function(args, chunkScope)));
+		}
+	});
+	return std::make_shared<LispVariant>(LispType::_List, std::make_shared<object>(list));
+}
+
+static std::shared_ptr<LispVariant> ParallelReduce(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckArgs(ParallelReduceFcn, 3, args, scope);
+
+	var function = CheckForFunction(ParallelReduceFcn, args[0], scope)->FunctionValue();
+	var elements = LispEnvironment::CheckForList(ParallelReduceFcn, args[1], scope);
+
+	// every chunk is reduced starting with its first element, the function must be associative,
+	// so the results of the chunks can be reduced in the order of the chunks like the elements by reduce
+	size_t chunkCount = LispThreadPool::GetThreadCount() * ChunksPerThread;
+	std::vector<std::shared_ptr<LispVariant>> chunkResults(chunkCount < elements->size() ? chunkCount : elements->size());
+	ProcessChunksInParallel(ParallelReduceFcn, elements->size(), scope, [&](size_t chunk, size_t first, size_t last, std::shared_ptr<LispScope> chunkScope)
+	{
+		var result = std::make_shared<LispVariant>((*elements)[first]);
+		for (size_t i = first + 1; i < last; i++)
+		{
+			std::vector<std::shared_ptr<object>> args;
+			args.push_back(std::make_shared<object>(*((*elements)[i])));
+			args.push_back(std::make_shared<object>(*result));
+			result = std::make_shared<LispVariant>(*(function.Function(args, chunkScope)));
+		}
+		chunkResults[chunk] = result;
+	});
+
+	var result = std::make_shared<LispVariant>(args[2]->ToLispVariantRef());
+	for (var chunkResult : chunkResults)
+	{
+		if (chunkResult != null)
+		{
+			std::vector<std::shared_ptr<object>> args;
+			args.push_back(std::make_shared<object>(*chunkResult));
+			args.push_back(std::make_shared<object>(*result));
+			result = std::make_shared<LispVariant>(*(function.Function(args, scope)));
+		}
+	}
+	return result;
+}
+
 static std::shared_ptr<LispVariant> Cons(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
 {
+	if (args.size() > 1)
+	{
+		const LispVariant & item2 = args[1]->ToLispVariantRef();
+		if (item2.IsList())
+		{
+			// the new list shares the elements of the tail
+			return std::make_shared<LispVariant>(LispType::_List, std::make_shared<object>(LispList::Cons(args[0], item2.LispListValueRef())));
+		}
+	}
 	var list = IEnumerable<std::shared_ptr<object>>();
 	if (args.size() > 0)
 	{
@@ -1012,19 +1351,7 @@ static std::shared_ptr<LispVariant> Cons(const std::vector<std::shared_ptr<objec
 	}
 	if (args.size() > 1)
 	{
-		var item2 = args[1]->ToLispVariantRef();
-		if (item2.IsList())
-		{
-			const IEnumerable<std::shared_ptr<object>> & l = item2.ListValueRef();
-			for(var item : l)
-			{
-				list.Add(item);
-			}
-		}
-		else
-		{
-			list.Add(args[1]);
-		}
+		list.Add(args[1]);
 	}
 	var result = std::make_shared<LispVariant>(LispType::_List, std::make_shared<object>(list));
 	return result;
@@ -1039,14 +1366,18 @@ static std::shared_ptr<LispVariant> Length(const std::vector<std::shared_ptr<obj
 	{
 		if (val.Value->IsDictionary())
 		{
-			return std::make_shared<LispVariant>(std::make_shared<object>((int)val.Value->ToDictionary().size()));
+			return std::make_shared<LispVariant>(std::make_shared<object>((int)val.Value->ToDictionaryRef().size()));
+		}
+		if (val.Value->IsSortedDictionary())
+		{
+			return std::make_shared<LispVariant>(std::make_shared<object>((int)val.Value->ToSortedDictionaryRef().size()));
 		}
 	}
 	if (val.IsString())
 	{
 		return std::make_shared<LispVariant>(std::make_shared<object>((int)val.StringValue().size()));
 	}
-	const IEnumerable<std::shared_ptr<object>> & elements = val.ListValueRef();
+	const LispList & elements = val.LispListValueRef();
 	return std::make_shared<LispVariant>(std::make_shared<object>((int)elements.Count()));
 }
 
@@ -1075,7 +1406,11 @@ static std::shared_ptr<LispVariant> First(const std::vector<std::shared_ptr<obje
 	}
 	else
 	{
-		const IEnumerable<std::shared_ptr<object>> & elements = val.ListValueRef();
+		const LispList & elements = val.LispListValueRef();
+		if (elements.Count() == 0)
+		{
+			return std::make_shared<LispVariant>(LispVariant(LispType::_Nil));
+		}
 		return std::make_shared<LispVariant>(elements.First());
 	}
 }
@@ -1105,7 +1440,11 @@ static std::shared_ptr<LispVariant> Last(const std::vector<std::shared_ptr<objec
 	}
 	else
 	{
-		const IEnumerable<std::shared_ptr<object>> & elements = val.ListValueRef();
+		const LispList & elements = val.LispListValueRef();
+		if (elements.Count() == 0)
+		{
+			return std::make_shared<LispVariant>(LispVariant(LispType::_Nil));
+		}
 		return std::make_shared<LispVariant>(elements.Last());
 	}
 }
@@ -1119,8 +1458,8 @@ static std::shared_ptr<LispVariant> Rest(const std::vector<std::shared_ptr<objec
 	{
 		return std::make_shared<LispVariant>(std::make_shared<object>(val.StringValue().Substring(1)));
 	}
-	IEnumerable<std::shared_ptr<object>> elements = val.ListValueRef();
-	return std::make_shared<LispVariant>(std::make_shared<object>(elements.Skip(1)));
+	// the rest shares the elements with the list
+	return std::make_shared<LispVariant>(std::make_shared<object>(val.LispListValueRef().Skip(1)));
 }
 
 static std::shared_ptr<LispVariant> Nth(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
@@ -1149,7 +1488,7 @@ static std::shared_ptr<LispVariant> Nth(const std::vector<std::shared_ptr<object
 	}
 	else
 	{
-		const IEnumerable<std::shared_ptr<object>> & elements = val.ListValueRef();
+		const LispList & elements = val.LispListValueRef();
 		return std::make_shared<LispVariant>(elements.ElementAt(index));
 	}
 }
@@ -1163,11 +1502,13 @@ static std::shared_ptr<LispVariant> Push(const std::vector<std::shared_ptr<objec
 	var pos = args.size() > 2 ? args[2]->ToLispVariantRef().ToInt() : 0;
 	if (list.IsList())
 	{
-		IEnumerable<std::shared_ptr<object>> & elements = list.ListValueNotConstRef();
-		if (pos < (int)elements.Count())
+		// inserting in front of the first element is O(1) amortized like cons
+		LispList & elements = list.LispListValueNotConstRef();
+		if (pos >= 0 && pos < (int)elements.Count())
 		{
 			elements.Insert(pos, std::make_shared<object>(val));
-			return std::make_shared<LispVariant>(LispVariant(std::make_shared<object>(elements)));
+			// return the modified list itself instead of a copy (like the C# version)
+			return std::make_shared<LispVariant>(list);
 		}
 		return std::make_shared<LispVariant>(LispVariant(LispType::_Nil));
 	}
@@ -1185,8 +1526,9 @@ static std::shared_ptr<LispVariant> Pop(const std::vector<std::shared_ptr<object
 	var pos = args.size() > 1 ? args[1]->ToLispVariantRef().ToInt() : 0;
 	if (list.IsList())
 	{
-		IEnumerable<std::shared_ptr<object>> & elements = list.ListValueNotConstRef();
-		if (pos < (int)elements.Count())
+		// removing the first element does not copy the elements
+		LispList & elements = list.LispListValueNotConstRef();
+		if (pos >= 0 && pos < (int)elements.Count())
 		{
 			var elem = elements.ElementAt(pos);
 			elements.RemoveAt(pos);
@@ -1202,16 +1544,13 @@ static std::shared_ptr<LispVariant> Pop(const std::vector<std::shared_ptr<object
 
 static std::shared_ptr<LispVariant> Append(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> /*scope*/)
 {
-	var list = IEnumerable<std::shared_ptr<object>>();
+	std::vector<const LispList *> lists;
 	for(var listElement : args)
 	{
-		const IEnumerable<std::shared_ptr<object>> & lst = listElement->ToLispVariantRef().ListValueRef();
-		for(var item : lst)
-		{
-			list.Add(item);
-		}
+		lists.push_back(&(listElement->ToLispVariantRef().LispListValueRef()));
 	}
-	var result = std::make_shared<LispVariant>(LispType::_List, std::make_shared<object>(list));
+	// the result shares the elements of the last list
+	var result = std::make_shared<LispVariant>(LispType::_List, std::make_shared<object>(LispList::Append(lists)));
 	return result;
 }
 
@@ -1338,7 +1677,7 @@ static std::shared_ptr<LispVariant> EvalStrFcn(const std::vector<std::shared_ptr
 	const LispVariant & variant = args[0]->ToLispVariantRef();
 	var tempModuleName = scope->ModuleName;
 	scope->IsInEval = true;
-	var result = Lisp::Eval(variant.Value->ToString(), scope, LispEnvironment::EvalStrTag + scope->ModuleName + ":" + variant.Value->ToString());
+	var result = Lisp::Eval(variant.StringValue(), scope, LispEnvironment::EvalStrTag + scope->ModuleName + ":" + variant.StringValue());
 	scope->IsInEval = false;
 	scope->ModuleName = tempModuleName;
 	return result;
@@ -1346,41 +1685,128 @@ static std::shared_ptr<LispVariant> EvalStrFcn(const std::vector<std::shared_ptr
 
 static std::shared_ptr<LispVariant> MakeDict(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	CheckArgs("make-dict", 0, args, scope);
+	CheckOptionalArgs("make-dict", 0, 1, args, scope);
+
+	var hasValueIndex = args.size() > 0 && args[0]->ToLispVariantRef().BoolValue();
+	return std::make_shared<LispVariant>(LispVariant(LispType::_NativeObject, std::make_shared<object>(LispDictionary(hasValueIndex))));
+}
+
+static std::shared_ptr<LispVariant> MakeSortedDict(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckArgs("make-sorted-dict", 0, args, scope);
+
+	return std::make_shared<LispVariant>(LispVariant(LispType::_NativeObject, std::make_shared<object>(LispSortedDictionary())));
+}
+
+// the dict functions support the hash dictionary (make-dict) and the sorted dictionary (make-sorted-dict), 
+// both have the same interface for reading, the operations are implemented once for both types
+
+static void DictSetValue(LispDictionary & dict, const LispVariant & key, const std::shared_ptr<object> & value)
+{
+	dict.Set(key, value);
+}
+
+static void DictSetValue(LispSortedDictionary & dict, const LispVariant & key, const std::shared_ptr<object> & value)
+{
+	dict[key] = value;
+}
+
+template <class DictionaryType> static std::shared_ptr<LispVariant> DictGetValue(const DictionaryType & dict, const LispVariant & key, const std::vector<std::shared_ptr<object>> & args)
+{
+	std::shared_ptr<object> result;
+	if (!dict.ContainsKey(key, &result))
+	{
+		if (args.size() > 2)
+		{
+			return args[2]->ToLispVariant();
+		}
+		result = std::make_shared<object>(object());
+	}
+	return std::make_shared<LispVariant>(result);
+}
+
+static std::shared_ptr<object> DictGetKeys(const LispDictionary & dict)
+{
+	return dict.GetKeysView();
+}
+
+static std::shared_ptr<object> DictGetKeys(const LispSortedDictionary & dict)
+{
+	IEnumerable<std::shared_ptr<object>> result;
+	result.reserve(dict.size());
+	for (const auto & kvp : dict)
+	//foreach(var key in nativeDict.Keys)
+	{
+		result.Add(std::make_shared<object>(kvp.first));
+	}
+	return std::make_shared<object>(result);
+}
+
+static std::shared_ptr<object> DictGetValues(const LispDictionary & dict)
+{
+	return dict.GetValuesView();
+}
+
+static std::shared_ptr<object> DictGetValues(const LispSortedDictionary & dict)
+{
+	IEnumerable<std::shared_ptr<object>> result;
+	result.reserve(dict.size());
+	for (const auto & kvp : dict)
+	{
+		result.Add(std::make_shared<object>(LispVariant(kvp.second)));
+	}
+	return std::make_shared<object>(result);
+}
 
-	return std::make_shared<LispVariant>(LispVariant(LispType::_NativeObject, std::make_shared<object>(Dictionary<LispVariant, std::shared_ptr<object>>())));
+static const std::shared_ptr<object> & GetDictArg(const string & name, const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	const LispVariant & variant = args[0]->ToLispVariantRef();
+	if (!variant.IsNativeObject() || variant.Value == null || !(variant.Value->IsDictionary() || variant.Value->IsSortedDictionary()))
+	{
+		throw LispException("Dictionary expected in " + name, scope.get());
+	}
+	return variant.Value;
 }
 
 static std::shared_ptr<LispVariant> DictSet(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
 	CheckArgs("dict-set", 3, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
+	const std::shared_ptr<object> & dict = GetDictArg("dict-set", args, scope);
 	const LispVariant & key = args[1]->ToLispVariantRef();
 	var value = args[2]->ToLispVariant();
-	dict[key] = value->Value;
+	if (dict->IsSortedDictionary())
+	{
+		DictSetValue(dict->ToSortedDictionary(), key, value->BoxedValue());
+	}
+	else
+	{
+		DictSetValue(dict->ToDictionary(), key, value->BoxedValue());
+	}
 
 	return value;
 }
 
 static std::shared_ptr<LispVariant> DictGet(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
-	CheckArgs("dict-get", 2, args, scope);
+	CheckOptionalArgs("dict-get", 2, 3, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
+	const std::shared_ptr<object> & dict = GetDictArg("dict-get", args, scope);
 	const LispVariant & key = args[1]->ToLispVariantRef();
-	var result = dict.ContainsKey(key) ? dict[key] : std::make_shared<object>(object());
-
-	return std::make_shared<LispVariant>(result);
+	if (dict->IsSortedDictionary())
+	{
+		return DictGetValue(dict->ToSortedDictionaryRef(), key, args);
+	}
+	return DictGetValue(dict->ToDictionaryRef(), key, args);
 }
 
 static std::shared_ptr<LispVariant> DictRemove(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
 	CheckArgs("dict-remove", 2, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
+	const std::shared_ptr<object> & dict = GetDictArg("dict-remove", args, scope);
 	const LispVariant & key = args[1]->ToLispVariantRef();
-	var ok = dict.Remove(key);
+	var ok = dict->IsSortedDictionary() ? dict->ToSortedDictionary().Remove(key) : dict->ToDictionary().Remove(key);
 
 	return std::make_shared<LispVariant>(std::make_shared<object>(ok));
 }
@@ -1389,23 +1815,35 @@ static std::shared_ptr<LispVariant> DictKeys(const std::vector<std::shared_ptr<o
 {
 	CheckArgs("dict-keys", 1, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
-	IEnumerable<std::shared_ptr<object>> result;
-	for (var elem : dict.GetKeys())
-	//foreach(var key in nativeDict.Keys)
-	{
-		result.Add(std::make_shared<object>(elem));
-	}
+	const std::shared_ptr<object> & dict = GetDictArg("dict-keys", args, scope);
+	var result = dict->IsSortedDictionary() ? DictGetKeys(dict->ToSortedDictionaryRef()) : DictGetKeys(dict->ToDictionaryRef());
 
-	return std::make_shared<LispVariant>(std::make_shared<object>(result));
+	return std::make_shared<LispVariant>(result);
+}
+
+static std::shared_ptr<LispVariant> DictValues(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	CheckArgs("dict-values", 1, args, scope);
+
+	const std::shared_ptr<object> & dict = GetDictArg("dict-values", args, scope);
+	var result = dict->IsSortedDictionary() ? DictGetValues(dict->ToSortedDictionaryRef()) : DictGetValues(dict->ToDictionaryRef());
+
+	return std::make_shared<LispVariant>(result);
 }
 
 static std::shared_ptr<LispVariant> DictClear(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
 {
 	CheckArgs("dict-clean", 1, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
-	dict.Clear();
+	const std::shared_ptr<object> & dict = GetDictArg("dict-clean", args, scope);
+	if (dict->IsSortedDictionary())
+	{
+		dict->ToSortedDictionary().Clear();
+	}
+	else
+	{
+		dict->ToDictionary().Clear();
+	}
 
 	return std::make_shared<LispVariant>();
 }
@@ -1414,9 +1852,9 @@ static std::shared_ptr<LispVariant> DictContainsKey(const std::vector<std::share
 {
 	CheckArgs("dict-contains-key", 2, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
+	const std::shared_ptr<object> & dict = GetDictArg("dict-contains-key", args, scope);
 	const LispVariant & key = args[1]->ToLispVariantRef();
-	var result = dict.ContainsKey(key);
+	var result = dict->IsSortedDictionary() ? dict->ToSortedDictionaryRef().ContainsKey(key) : dict->ToDictionaryRef().ContainsKey(key);
 
 	return std::make_shared<LispVariant>(std::make_shared<object>(result));
 }
@@ -1425,9 +1863,9 @@ static std::shared_ptr<LispVariant> DictContainsValue(const std::vector<std::sha
 {
 	CheckArgs("dict-contains-value", 2, args, scope);
 
-	Dictionary<LispVariant, std::shared_ptr<object>> &  dict = args[0]->ToLispVariantRef().Value->ToDictionary();
-	var value = args[1]->ToLispVariant();
-	var result = dict.ContainsValue(value->Value);
+	const std::shared_ptr<object> & dict = GetDictArg("dict-contains-value", args, scope);
+	var value = args[1]->ToLispVariant()->BoxedValue();
+	var result = dict->IsSortedDictionary() ? dict->ToSortedDictionaryRef().ContainsValue(value) : dict->ToDictionaryRef().ContainsValue(value);
 
 	return std::make_shared<LispVariant>(std::make_shared<object>(result));
 }
@@ -1545,7 +1983,7 @@ std::shared_ptr<object> UnQuoteIfNeeded(std::shared_ptr<object> item, bool & isS
 			if (value.IsList())
 			{
 				std::shared_ptr<object> pObj = std::make_shared<object>(value.ListValueRef());
-				return LispInterpreter::EvalAst(pObj, scope)->Value;
+				return LispInterpreter::EvalAst(pObj, scope)->BoxedValue();
 			}
 			else
 			{
@@ -1729,76 +2167,115 @@ static IEnumerable<std::shared_ptr<object>> VectorToList(const std::vector<std::
 	return ret;
 }
 
-std::shared_ptr<LispVariant> fn_form(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+// the names are interned once, so a call does not access the symbol table
+static size_t ArgsMetaId()
 {
-	var name = /*(string)*/scope->UserData.get()!=null ? scope->UserData->ToString() : "";
-	var moduleName = scope->ModuleName;
-	var userDoc = scope->UserDoc;
-	var signature = userDoc.get() != null ? userDoc->Item1() : string::Empty/*null*/;
-	var documentation = userDoc.get() != null ? userDoc->Item2() : string::Empty/*null*/;
+	static const size_t argsMetaId = LispSymbolTable::Intern(ArgsMeta);
+	return argsMetaId;
+}
 
-	std::function<std::shared_ptr<LispVariant>(const std::vector<std::shared_ptr<object>> &, std::shared_ptr<LispScope>)> fcn = 
-		[name, moduleName, args, scope](const std::vector<std::shared_ptr<object>> & localArgs, std::shared_ptr<LispScope> localScope) -> std::shared_ptr<LispVariant>
-	{
-		var childScope = std::make_shared<LispScope>(name, localScope->GlobalScope, std::make_shared<string>(moduleName), scope->Output, scope->Input);
-		localScope->PushNextScope(childScope);
+static size_t AdditionalArgsId()
+{
+	static const size_t additionalArgsId = LispSymbolTable::Intern(AdditionalArgs);
+	return additionalArgsId;
+}
 
-		// add formal arguments to current scope
-		var i = 0;
-		std::vector<std::shared_ptr<object>> formalArgs = args[0]->IsLispVariant() /*is LispVariant*/ ? args[0]->ToLispVariantRef().ListValueRef().ToArray() : LispEnvironment::GetExpression(args[0])->ToArray();
-		
-		std::vector<std::shared_ptr<object>> tempLocalArgs = localArgs;
+bool LispUserFunction::IsCallScopeSymbol(size_t symbolId)
+{
+	return symbolId == ArgsMetaId() || symbolId == AdditionalArgsId();
+}
 
-		if (formalArgs.size() > localArgs.size())
-		{
-			//throw LispException("Invalid number of arguments");
+std::shared_ptr<LispScope> LispUserFunction::CreateCallScope(const std::vector<std::shared_ptr<object>> & localArgs, std::shared_ptr<LispScope> localScope) const
+{
+	COUNT_RUNTIME_STATISTIC(FunctionScopes);
+	var childScope = std::make_shared<LispScope>(Name, localScope->GlobalScope, std::make_shared<string>(ModuleName), Scope->Output, Scope->Input);
 
-			// fill all not given arguments with nil
-			//var newLocalArgs = new object[formalArgs.size()];
-			std::vector<std::shared_ptr<object>> newLocalArgs(formalArgs.size());
-			for (size_t n = 0; n < formalArgs.size(); n++)
-			{
-				if (n < localArgs.size())
-				{
-					newLocalArgs[n] = localArgs[n];
-				}
-				else
-				{
-					newLocalArgs[n] = std::make_shared<object>(LispVariant(LispType::_Nil));
-				}
-			}
+	// add formal arguments to current scope, they are local variables of the function body
+	var i = 0;
+	std::vector<std::shared_ptr<object>> tempLocalArgs = localArgs;
 
-			tempLocalArgs = newLocalArgs;
-		}
+	if (FormalArgNames.size() > localArgs.size())
+	{
+		//throw LispException("Invalid number of arguments");
 
-		for(var arg : formalArgs)
+		// fill all not given arguments with nil
+		//var newLocalArgs = new object[formalArgs.size()];
+		std::vector<std::shared_ptr<object>> newLocalArgs(FormalArgNames.size());
+		for (size_t n = 0; n < FormalArgNames.size(); n++)
 		{
-			(*childScope)[arg->ToString()] = tempLocalArgs[i];
-			i++;
+			if (n < localArgs.size())
+			{
+				newLocalArgs[n] = localArgs[n];
+			}
+			else
+			{
+				newLocalArgs[n] = std::make_shared<object>(LispVariant(LispType::_Nil));
+			}
 		}
 
-		// support args function for accessing all given parameters
-		(*childScope)[ArgsMeta] = std::make_shared<object>(VectorToList(tempLocalArgs));
-		size_t formalArgsCount = formalArgs.size();
-		if (tempLocalArgs.size() > formalArgsCount)
+		tempLocalArgs = newLocalArgs;
+	}
+
+
+	for (const string & arg : FormalArgNames)
+	{
+		childScope->LocalCell(arg, FormalArgIds[i]) = tempLocalArgs[i];
+		i++;
+	}
+
+	// support args function for accessing all given parameters
+	childScope->LocalCell(ArgsMeta, ArgsMetaId()) = std::make_shared<object>(VectorToList(tempLocalArgs));
+	size_t formalArgsCount = FormalArgNames.size();
+	if (tempLocalArgs.size() > formalArgsCount)
+	{
+		//var additionalArgs = new object[tempLocalArgs.size() - formalArgsCount];
+		std::vector<std::shared_ptr<object>> additionalArgs(tempLocalArgs.size() - formalArgsCount);
+		for (size_t n = 0; n < tempLocalArgs.size() - formalArgsCount; n++)
 		{
-			//var additionalArgs = new object[tempLocalArgs.size() - formalArgsCount];
-			std::vector<std::shared_ptr<object>> additionalArgs(tempLocalArgs.size() - formalArgsCount);
-			for (size_t n = 0; n < tempLocalArgs.size() - formalArgsCount; n++)
-			{
-				additionalArgs[n] = tempLocalArgs[n + formalArgsCount];
-			}
-			(*childScope)[AdditionalArgs] = std::make_shared<object>(LispVariant(std::make_shared<object>(VectorToList(additionalArgs))));
+			additionalArgs[n] = tempLocalArgs[n + formalArgsCount];
 		}
+		childScope->LocalCell(AdditionalArgs, AdditionalArgsId()) = std::make_shared<object>(LispVariant(std::make_shared<object>(VectorToList(additionalArgs))));
+	}
 
-		// save the current call stack to resolve variables in closures
-		childScope->ClosureChain = scope;
-		childScope->NeedsLValue = scope->NeedsLValue;     // support setf in recursive calls
+	// save the current call stack to resolve variables in closures
+	childScope->ClosureChain = Scope;
+	childScope->NeedsLValue = Scope->NeedsLValue;     // support setf in recursive calls
+	return childScope;
+}
+
+std::shared_ptr<LispVariant> fn_form(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> scope)
+{
+	var userDoc = scope->UserDoc;
+	var signature = userDoc.get() != null ? userDoc->Item1() : string::Empty/*null*/;
+	var documentation = userDoc.get() != null ? userDoc->Item2() : string::Empty/*null*/;
+
+	var userFunction = std::make_shared<LispUserFunction>();
+	userFunction->Name = /*(string)*/scope->UserData.get()!=null ? scope->UserData->ToString() : "";
+	userFunction->ModuleName = scope->ModuleName;
+	userFunction->Scope = scope;
+	// compile the body of the function only once, the formal arguments are stored in the first local slots
+	std::vector<std::shared_ptr<object>> formalArgs = args[0]->IsLispVariant() /*is LispVariant*/ ? args[0]->ToLispVariantRef().ListValueRef().ToArray() : LispEnvironment::GetExpression(args[0])->ToArray();
+	for (var arg : formalArgs)
+	{
+		userFunction->FormalArgNames.push_back(arg->ToString());
+		userFunction->FormalArgIds.push_back(LispSymbolTable::Intern(userFunction->FormalArgNames.back()));
+	}
+	userFunction->Body = args.size() > 1 ? args[1] : null;
+	userFunction->Code = args.size() > 1 ? LispCompiler::CompileFunction(args[1], scope, userFunction->FormalArgNames) : null;
+
+	// the virtual machine calls the compiled body directly, this function is used by all other callers
+	std::function<std::shared_ptr<LispVariant>(const std::vector<std::shared_ptr<object>> &, std::shared_ptr<LispScope>)> fcn = 
+		[userFunction](const std::vector<std::shared_ptr<object>> & localArgs, std::shared_ptr<LispScope> localScope) -> std::shared_ptr<LispVariant>
+	{
+		COUNT_RUNTIME_STATISTIC(FunctionCalls);
+		var scope = userFunction->Scope;
+		var childScope = userFunction->CreateCallScope(localArgs, localScope);
+		localScope->PushNextScope(childScope);
 
 		std::shared_ptr<LispVariant> ret;
 		try
 		{
-			ret = LispInterpreter:: EvalAst(args[1], childScope);
+			ret = userFunction->Code != null ? LispVirtualMachine::Execute(userFunction->Code, childScope) : LispInterpreter::EvalAst(userFunction->Body, childScope);
 		}
 		catch (LispStopDebuggerException & exc)
 		{
@@ -1817,7 +2294,7 @@ std::shared_ptr<LispVariant> fn_form(const std::vector<std::shared_ptr<object>>
 			{
 				scope->GlobalScope->Output->WriteLine(ex.ToString());
 
-				debugger->InteractiveLoop(/*initialTopScope: */childScope, /*currentAst :*/ /*(IEnumerable<object>)*/std::make_shared<IEnumerable<std::shared_ptr<object>>>(args[1]->ToEnumerableOfObjectRef()) /*new List<object> { info.Item2 }*/);
+				debugger->InteractiveLoop(/*initialTopScope: */childScope, /*currentAst :*/ /*(IEnumerable<object>)*/std::make_shared<IEnumerable<std::shared_ptr<object>>>(userFunction->Body->ToEnumerableOfObjectRef()) /*new List<object> { info.Item2 }*/);
 			}
 
 			throw ex;
@@ -1826,7 +2303,7 @@ std::shared_ptr<LispVariant> fn_form(const std::vector<std::shared_ptr<object>>
 		return ret;
 	};
 
-	return std::make_shared<LispVariant>(CreateFunction(fcn, signature, documentation, /*isBuiltin:*/ false, /*isSpecialForm:*/ false,/*isEvalInExpand: */ false, /*moduleName :*/ scope->ModuleName));
+	return std::make_shared<LispVariant>(CreateFunction(fcn, signature, documentation, /*isBuiltin:*/ false, /*isSpecialForm:*/ false,/*isEvalInExpand: */ false, /*moduleName :*/ scope->ModuleName, /*userFunction:*/ userFunction));
 }
 
 // returns token just before the defn statement:
@@ -1974,24 +2451,40 @@ static std::shared_ptr<LispVariant> gdefn_form(const std::vector<std::shared_ptr
 
 bool LispEnvironment::FindFunctionInModules(const string & funcName, std::shared_ptr<LispScope> scope, std::shared_ptr<object> & foundValue)
 {
-	foundValue = null;
+	return FindFunctionInModules(LispSymbolTable::Find(funcName), scope, foundValue);
+}
+
+bool LispEnvironment::FindFunctionInModules(size_t symbolId, std::shared_ptr<LispScope> scope, std::shared_ptr<object> & foundValue)
+{
+	// one probe of the module index, also for the symbols which are not defined in any module
+	std::shared_ptr<object> ** cell = scope->GlobalScope->Runtime->ModuleIndex.FindValue(symbolId);
+	foundValue = cell != null ? **cell : null;
+	return cell != null;
+}
+
+void LispEnvironment::RebuildModuleIndex(std::shared_ptr<LispScope> globalScope)
+{
+	var & index = globalScope->Runtime->ModuleIndex;
+	index.Clear();
 
-	std::shared_ptr<object> importedModules = (*(scope->GlobalScope))[LispEnvironment::Modules];
-	if (importedModules.get() != null)
+	auto importedModules = globalScope->find(LispEnvironment::Modules);
+	if (importedModules != globalScope->end() && importedModules->second != null)
 	{
-		auto tempScope = importedModules->GetLispScopeRef();
-		for (/*KeyValuePair*/std::pair<string, std::shared_ptr<object>> kv : *tempScope)
+		// the modules are searched in the sorted order of their names (paths) like in the sorted scopes before
+		var modules = importedModules->second->GetLispScopeRef();
+		for (const string & moduleName : modules->GetKeys())
 		{
-			var module = /*(LispScope)*/kv.second->GetLispScopeRef();
-			auto item = module->find(funcName);
-			if (item != module->end())
+			var module = /*(LispScope)*/modules->find(moduleName)->second->GetLispScopeRef();
+			for (var & item : *module)
 			{
-				foundValue = item->second;
-				return true;
+				size_t symbolId = LispSymbolTable::Intern(item.first);
+				if (index.FindValue(symbolId) == null)
+				{
+					index[symbolId] = &(item.second);
+				}
 			}
 		}
 	}
-	return false;
 }
 
 bool LispEnvironment::IsInModules(const string & funcName, std::shared_ptr<LispScope> scope)
@@ -2007,27 +2500,49 @@ std::shared_ptr<object> LispEnvironment::GetFunctionInModules(const string & fun
 	return result;
 }
 
-static bool ExistsItem(std::shared_ptr<object> funcName, std::shared_ptr<LispScope> scope, const string & key)
+static std::shared_ptr<object> * FindMacroCell(size_t symbolId, std::shared_ptr<LispScope> scope)
 {
-    if (scope.get() != null)
-    {
-		auto item = scope->find(key);
-		if (item != scope->end())
+	static const size_t macrosId = LispSymbolTable::Intern(LispEnvironment::Macros);
+
+	if (scope.get() != null && symbolId != LispSymbolTable::NoSymbol)
+	{
+		std::shared_ptr<object> * macros = scope->FindCell(macrosId);
+		if (macros != null)
 		{
-			return (*item).second->GetLispScopeRef()->ContainsKey(funcName->ToString());
+			return (*macros)->GetLispScopeRef()->FindCell(symbolId);
 		}
-    }
-    return false;
+	}
+	return null;
+}
+
+size_t LispEnvironment::GetSymbolId(std::shared_ptr<object> item)
+{
+	if (item->IsLispVariant() && item->ToLispVariantRef().IsSymbol())
+	{
+		return item->ToLispVariantRef().SymbolId();
+	}
+	return LispSymbolTable::Find(item->ToString());
 }
 
 bool LispEnvironment::IsMacro(std::shared_ptr<object> funcName, std::shared_ptr<LispScope> scope)
 {
-    return ExistsItem(funcName, scope, LispEnvironment::Macros);
+	return FindMacroCell(GetSymbolId(funcName), scope) != null;
+}
+
+bool LispEnvironment::IsMacro(const string & funcName, std::shared_ptr<LispScope> scope)
+{
+	return FindMacroCell(LispSymbolTable::Find(funcName), scope) != null;
+}
+
+bool LispEnvironment::IsMacro(size_t symbolId, std::shared_ptr<LispScope> scope)
+{
+	return FindMacroCell(symbolId, scope) != null;
 }
 
 std::shared_ptr<object> LispEnvironment::GetMacro(std::shared_ptr<object> funcName, std::shared_ptr<LispScope> scope)
 {
-	return QueryItem(funcName, scope, Macros);
+	std::shared_ptr<object> * cell = FindMacroCell(GetSymbolId(funcName), scope);
+	return cell != null ? *cell : null;
 }
 
 bool LispEnvironment::IsExpression(std::shared_ptr<object> item)
@@ -2246,7 +2761,7 @@ string LispEnvironment::GetLispType(std::shared_ptr<object> obj)
 	return obj->GetTypeName();
 }
 
-std::shared_ptr<LispScope> LispEnvironment::CreateDefaultScope()
+std::shared_ptr<LispScope> LispEnvironment::CreateBuiltinScope()
 {
 	std::shared_ptr<LispScope> scope = std::make_shared<LispScope>(MainScope);
 
@@ -2269,9 +2784,14 @@ std::shared_ptr<LispScope> LispEnvironment::CreateDefaultScope()
 	(*scope)["gettrace"] = CreateFunction(GetTracePrint, "(gettrace)", "Returns the trace output.");
 #endif
 	(*scope)["need-l-value"] = CreateFunction(NeedLValue, "(need-l-value)", "Returns #t if a l-value is needed as return value of the current function.");
-	(*scope)["import"] = CreateFunction(Import, "(import module1 ...)", "Imports modules with fuel code.");
+	(*scope)["import"] = CreateFunction(Import, "(import module1 ...)", "Imports modules with fuel code, a module which is already imported is not evaluated again.");
+	(*scope)["reload"] = CreateFunction(Reload, "(reload module1 ...)", "Imports modules with fuel code again, also if they are already imported (i. e. after changing the code of a module).");
 	(*scope)["tickcount"] = CreateFunction(CurrentTickCount, "(tickcount)", "Returns the current tick count in milliseconds, can be used to measure times.");
 	(*scope)["sleep"] = CreateFunction(_Sleep, "(sleep time-in-ms)", "Sleeps the given number of milliseconds.");
+	(*scope)["profile-start"] = CreateFunction(ProfileStart, "(profile-start [interval-in-ms])", "Starts the sampling profiler, the call stack is sampled every interval (default 1 ms).");
+	(*scope)["runtime-stats"] = CreateFunction(RuntimeStats, "(runtime-stats)", "Returns a dictionary with the counters of the interpreter for the current thread (evaluations, function calls and scopes, object allocations and copies, macro expansions, symbol lookups per scope, exceptions, call site cache and module cache hits, symbol table locks), all counters are zero if the statistics are disabled.");
+	(*scope)["reset-runtime-stats"] = CreateFunction(ResetRuntimeStats, "(reset-runtime-stats)", "Sets all counters of the runtime statistics to zero.");
+	(*scope)["profile-stop"] = CreateFunction(ProfileStop, "(profile-stop [folded-stacks-file])", "Stops the sampling profiler and returns the flat profile per function and per line, the samples are written as folded stacks to the optional file (for flamegraph tools).");
 	(*scope)["date-time"] = CreateFunction(Datetime, "(date-time)", "Returns a list with informations about the current date and time: (year month day hours minutes seconds).");
 	(*scope)["platform"] = CreateFunction(Platform, "(platform)", "Returns a list with informations about the current platform: (operating_system runtime_environment).");
 
@@ -2301,52 +2821,54 @@ std::shared_ptr<LispScope> LispEnvironment::CreateDefaultScope()
 	(*scope)["float"] = CreateFunction(ToFloat, "(float expr)", "Convert the expr into a float value");
 
 	(*scope)["search"] = CreateFunction(Search, "(search searchtxt expr [pos] [len])", "Returns the first position of the searchtxt in the string, starting from position pos.");
-	(*scope)["slice"] = CreateFunction(Slice, "(slice expr1 pos len)", "Returns a substring of the given string expr1, starting from position pos with length len.");
+	(*scope)["slice"] = CreateFunction(Slice, "(slice expr1 pos len)", "Returns a substring of the given string expr1, starting from position pos with length len. For a list expr1 the elements starting from position pos are returned, the slice shares the elements with the list.");
 	(*scope)["replace"] = CreateFunction(Replace, "(replace expr1 searchtxt replacetxt)", "Returns a string of the given string expr1 with replacing searchtxt with replacetxt.");
 	(*scope)["trim"] = CreateFunction(Trim, "(trim expr1)", "Returns a string with no starting and trailing whitespaces.");
 	(*scope)["lower-case"] = CreateFunction(LowerCase, "(lower-case expr1)", "Returns a string with only lower case characters.");
 	(*scope)["upper-case"] = CreateFunction(UpperCase, "(upper-case expr1)", "Returns a string with only upper case characters.");
-	(*scope)["string"] = CreateFunction(Addition, "(string expr1 expr2 ...)", "see: add");
-	(*scope)["add"] = CreateFunction(Addition, "(add expr1 expr2 ...)", "Returns value of expr1 added with expr2 added with ...");
-	(*scope)["+"] = CreateFunction(Addition, "(+ expr1 expr2 ...)", "see: add");
-	(*scope)["sub"] = CreateFunction(Subtraction, "(sub expr1 expr2 ...)", "Returns value of expr1 subtracted with expr2 subtracted with ...");
-	(*scope)["-"] = CreateFunction(Subtraction, "(- expr1 expr2 ...)", "see: sub");
-	(*scope)["mul"] = CreateFunction(Multiplication, "(mul expr1 expr2 ...)", "Returns value of expr1 multipied by expr2 multiplied by ...");
-	(*scope)["*"] = CreateFunction(Multiplication, "(* expr1 expr2 ...)", "see: mul");
-	(*scope)["div"] = CreateFunction(Division, "(div expr1 expr2 ...)", "Returns value of expr1 divided by expr2 divided by ...");
-	(*scope)["/"] = CreateFunction(Division, "(/ expr1 expr2 ...)", "see: div");
-	(*scope)["mod"] = CreateFunction(Modulo, "(mod expr1 expr2)", "Returns value of modulo operation between expr1 and expr2");
-	(*scope)["%"] = CreateFunction(Modulo, "(% expr1 expr2)", "see: div");
-
-	(*scope)["<"] = CreateFunction(LessTest, "(< expr1 expr2)", "Returns #t if value of expression1 is smaller than value of expression2 and returns #f otherwiese.");
-	(*scope)[">"] = CreateFunction(GreaterTest, "(> expr1 expr2)", "Returns #t if value of expression1 is larger than value of expression2 and returns #f otherwiese.");
-	(*scope)["<="] = CreateFunction(LessEqualTest, "(<= expr1 expr2)", "Returns #t if value of expression1 is equal or smaller than value of expression2 and returns #f otherwiese.");
-	(*scope)[">="] = CreateFunction(GreaterEqualTest, "(>= expr1 expr2)", "Returns #t if value of expression1 is equal or larger than value of expression2 and returns #f otherwiese.");
+	(*scope)["string"] = CreateOperatorFunction(Addition, OperatorAdd, "(string expr1 expr2 ...)", "see: add");
+	(*scope)["add"] = CreateOperatorFunction(Addition, OperatorAdd, "(add expr1 expr2 ...)", "Returns value of expr1 added with expr2 added with ...");
+	(*scope)["+"] = CreateOperatorFunction(Addition, OperatorAdd, "(+ expr1 expr2 ...)", "see: add");
+	(*scope)["sub"] = CreateOperatorFunction(Subtraction, OperatorSubtract, "(sub expr1 expr2 ...)", "Returns value of expr1 subtracted with expr2 subtracted with ...");
+	(*scope)["-"] = CreateOperatorFunction(Subtraction, OperatorSubtract, "(- expr1 expr2 ...)", "see: sub");
+	(*scope)["mul"] = CreateOperatorFunction(Multiplication, OperatorMultiply, "(mul expr1 expr2 ...)", "Returns value of expr1 multipied by expr2 multiplied by ...");
+	(*scope)["*"] = CreateOperatorFunction(Multiplication, OperatorMultiply, "(* expr1 expr2 ...)", "see: mul");
+	(*scope)["div"] = CreateOperatorFunction(Division, OperatorDivide, "(div expr1 expr2 ...)", "Returns value of expr1 divided by expr2 divided by ...");
+	(*scope)["/"] = CreateOperatorFunction(Division, OperatorDivide, "(/ expr1 expr2 ...)", "see: div");
+	(*scope)["mod"] = CreateOperatorFunction(Modulo, OperatorModulo, "(mod expr1 expr2)", "Returns value of modulo operation between expr1 and expr2");
+	(*scope)["%"] = CreateOperatorFunction(Modulo, OperatorModulo, "(% expr1 expr2)", "see: div");
+
+	(*scope)["<"] = CreateOperatorFunction(LessTest, OperatorLess, "(< expr1 expr2)", "Returns #t if value of expression1 is smaller than value of expression2 and returns #f otherwiese.");
+	(*scope)[">"] = CreateOperatorFunction(GreaterTest, OperatorGreater, "(> expr1 expr2)", "Returns #t if value of expression1 is larger than value of expression2 and returns #f otherwiese.");
+	(*scope)["<="] = CreateOperatorFunction(LessEqualTest, OperatorLessEqual, "(<= expr1 expr2)", "Returns #t if value of expression1 is equal or smaller than value of expression2 and returns #f otherwiese.");
+	(*scope)[">="] = CreateOperatorFunction(GreaterEqualTest, OperatorGreaterEqual, "(>= expr1 expr2)", "Returns #t if value of expression1 is equal or larger than value of expression2 and returns #f otherwiese.");
 	
-	(*scope)["equal"] = CreateFunction(EqualTest, "(equal expr1 expr2)", "Returns #t if value of expression1 is equal with value of expression2 and returns #f otherwiese.");
-	(*scope)["="] = CreateFunction(EqualTest, "(= expr1 expr2)", "see: equal");
-	(*scope)["=="] = CreateFunction(EqualTest, "(== expr1 expr2)", "see: equal");
-	(*scope)["!="] = CreateFunction(NotEqualTest, "(!= expr1 expr2)", "Returns #t if value of expression1 is not equal with value of expression2 and returns #f otherwiese.");
+	(*scope)["equal"] = CreateOperatorFunction(EqualTest, OperatorEqual, "(equal expr1 expr2)", "Returns #t if value of expression1 is equal with value of expression2 and returns #f otherwiese.");
+	(*scope)["="] = CreateOperatorFunction(EqualTest, OperatorEqual, "(= expr1 expr2)", "see: equal");
+	(*scope)["=="] = CreateOperatorFunction(EqualTest, OperatorEqual, "(== expr1 expr2)", "see: equal");
+	(*scope)["!="] = CreateOperatorFunction(NotEqualTest, OperatorNotEqual, "(!= expr1 expr2)", "Returns #t if value of expression1 is not equal with value of expression2 and returns #f otherwiese.");
 
 	(*scope)["not"] = CreateFunction(Not, "(not expr)", "Returns the inverted bool value of the expression.");
 	(*scope)["!"] = CreateFunction(Not, "(! expr)", "see: not");
 
-	(*scope)["list"] = CreateFunction(CreateList, "(list item1 item2 ...)", "Returns a new list with the given elements.");
+	(*scope)[List] = CreateFunction(CreateList, "(list item1 item2 ...)", "Returns a new list with the given elements.");
 	(*scope)[MapFcn] = CreateFunction(Map, "(map function list)", "Returns a new list with elements, where all elements of the list where applied to the function.");	
 	(*scope)[ReduceFcn] = CreateFunction(Reduce, "(reduce function list initial)", "Reduce function.");
+	(*scope)[ParallelMapFcn] = CreateFunction(ParallelMap, "(pmap function list)", "Like map, but the function is applied to the elements in parallel on a thread pool, the order of the elements is kept. The function must not modify global variables or the elements of the list.");
+	(*scope)[ParallelReduceFcn] = CreateFunction(ParallelReduce, "(preduce function list initial)", "Like reduce, but parts of the list are reduced in parallel on a thread pool, the function must be associative. The function must not modify global variables or the elements of the list.");
 	(*scope)["cons"] = CreateFunction(Cons, "(cons item list)", "Returns a new list containing the item and the elements of the list.");
 	(*scope)["len"] = CreateFunction(Length, "(len list)", "Returns the length of the list.");
-	(*scope)["first"] = CreateFunction(First, "(first list)", "see: car");
+	(*scope)[FirstFcn] = CreateFunction(First, "(first list)", "see: car");
 	(*scope)["last"] = CreateFunction(Last, "(last list)", "Returns the last element of the list.");
 	(*scope)["car"] = CreateFunction(First, "(car list)", "Returns the first element of the list.");
 	(*scope)["rest"] = CreateFunction(Rest, "(rest list)", "see: cdr");
 	(*scope)["cdr"] = CreateFunction(Rest, "(cdr list)", "Returns a new list containing all elements except the first of the given list.");
-	(*scope)["nth"] = CreateFunction(Nth, "(nth number list)", "Returns the [number] element of the list.");
+	(*scope)[NthFcn] = CreateFunction(Nth, "(nth number list)", "Returns the [number] element of the list.");
 	(*scope)["push"] = CreateFunction(Push, "(push elem list [index])", "Inserts the element at the given index (default value 0) into the list (implace) and returns the updated list.");
 	(*scope)["pop"] = CreateFunction(Pop, "(pop list [index])", "Removes the element at the given index (default value 0) from the list and returns the removed element.");
 	(*scope)["append"] = CreateFunction(Append, "(append list1 list2 ...)", "Returns a new list containing all given lists elements.");
 	(*scope)["reverse"] = CreateFunction(Reverse, "(reverse expr)", "Returns a list or string with a reverted order.");
-	(*scope)["rval"] = CreateFunction(RValue, "(rval expr)", "Returns a RValue of the expr, disables LValue evaluation.", /*isBuiltin:*/true, /*isSpecialForm:*/ true);
+	(*scope)[RVal] = CreateFunction(RValue, "(rval expr)", "Returns a RValue of the expr, disables LValue evaluation.", /*isBuiltin:*/true, /*isSpecialForm:*/ true);
 	(*scope)[Sym] = CreateFunction(SymbolFcn, "(sym expr)", "Returns the evaluated expression as symbol.");
 	(*scope)[Str] = CreateFunction(ConvertToString, "(str expr)", "Returns the evaluated expression as string.");
 
@@ -2358,11 +2880,13 @@ std::shared_ptr<LispScope> LispEnvironment::CreateDefaultScope()
 	(*scope)[EvalStr] = CreateFunction(EvalStrFcn, "(evalstr string)", "Evaluates the string.");
 
 	// additional data types
-	(*scope)["make-dict"] = CreateFunction(MakeDict, "(make-dict)", "Returns a new dictionary.");
+	(*scope)["make-dict"] = CreateFunction(MakeDict, "(make-dict [index-values])", "Returns a new dictionary, a hash table for keys of type bool, int, double, string or symbol. With index-values #t the dictionary maintains a reverse index for dict-contains-value.");
+	(*scope)["make-sorted-dict"] = CreateFunction(MakeSortedDict, "(make-sorted-dict)", "Returns a new dictionary which keeps the keys sorted.");
 	(*scope)["dict-set"] = CreateFunction(DictSet, "(dict-set dict key value)", "Sets the value for the key in the dictionary.");
-	(*scope)["dict-get"] = CreateFunction(DictGet, "(dict-get dict key)", "Returns the value for the key or nil if key is not in dictionary.");
+	(*scope)["dict-get"] = CreateFunction(DictGet, "(dict-get dict key [default])", "Returns the value for the key or the default value (nil if not given) if key is not in dictionary.");
 	(*scope)["dict-remove"] = CreateFunction(DictRemove, "(dict-remove dict key)", "Removes the value / key pair from the directory and returns success flag.");
 	(*scope)["dict-keys"] = CreateFunction(DictKeys, "(dict-keys dict)", "Returns all keys in the dictionary.");
+	(*scope)["dict-values"] = CreateFunction(DictValues, "(dict-values dict)", "Returns all values in the dictionary in the order of the keys.");
 	(*scope)["dict-clear"] = CreateFunction(DictClear, "(dict-clear dict)", "Clears the dictionary.");
 	(*scope)["dict-contains-key"] = CreateFunction(DictContainsKey, "(dict-contains-key dict key)", "Returns #t if key is contained in dictionary, otherwise #f.");
 	(*scope)["dict-contains-value"] = CreateFunction(DictContainsValue, "(dict-contains-value dict key)", "Returns #t if value is contained in dictionary, otherwise #f.");
@@ -2439,3 +2963,16 @@ std::shared_ptr<LispScope> LispEnvironment::CreateDefaultScope()
 
 	return scope;
 }
+
+std::shared_ptr<LispScope> LispEnvironment::CreateDefaultScope()
+{
+	// the builtin functions are created once, every default scope is a fork of the builtin scope,
+	// the builtin scope is never released, so it is available while other static objects are destroyed
+	static std::shared_ptr<LispScope> * builtinScope = null;
+	static std::once_flag created;
+	std::call_once(created, []() { builtinScope = new std::shared_ptr<LispScope>(CreateBuiltinScope()); });
+
+	std::shared_ptr<LispScope> scope = (*builtinScope)->Fork(std::make_shared<TextWriter>(), std::make_shared<TextReader>());
+	scope->Runtime->LibraryPath = LispRuntime::GetDefaultLibraryPath();
+	return scope;
+}
@@ -38,14 +38,14 @@
 #include "csobject.h"
 
 extern DLLEXPORT std::string ReadFileOrEmptyString(const std::string & fileName);
+extern DLLEXPORT bool WriteTextFile(const std::string & fileName, const std::string & content);
 
 namespace CppLisp
 {
 	class LispScope;
+	class LispCode;
 	class LispBreakpointPosition;
 
-	extern string LispUtils_LibraryPath;
-
 	// **********************************************************************
 	/// <summary>
 	/// Class to hold informations about macro expansions at compile time.
@@ -77,6 +77,57 @@ namespace CppLisp
 		}
 	};
 
+	// **********************************************************************
+	/// <summary>
+	/// Class to hold informations about a user defined function (created by fn).
+	/// The <see cref="LispVirtualMachine"/> uses the compiled body to call the 
+	/// function without a recursion of the native stack.
+	/// </summary>
+	class DLLEXPORT LispUserFunction
+	{
+	public:
+		/*public*/ string Name;
+
+		/*public*/ string ModuleName;
+
+		/*public*/ std::vector<string> FormalArgNames;
+
+		/// <summary>
+		/// The interned ids of the formal arguments, interned once when the function is created.
+		/// </summary>
+		/*public*/ std::vector<size_t> FormalArgIds;
+
+		/// <summary>
+		/// The not evaluated body of the function.
+		/// </summary>
+		/*public*/ std::shared_ptr<object> Body;
+
+		/// <summary>
+		/// The compiled body of the function, null if the function has no body.
+		/// </summary>
+		/*public*/ std::shared_ptr<LispCode> Code;
+
+		/// <summary>
+		/// The scope in which the function was defined, used to resolve variables in closures.
+		/// </summary>
+		/*public*/ std::shared_ptr<LispScope> Scope;
+
+		/// <summary>
+		/// Creates the scope for a call of this function with the given arguments.
+		/// </summary>
+		/// <param name="args">The evaluated arguments.</param>
+		/// <param name="callerScope">The scope of the caller.</param>
+		/// <returns>The new scope with the formal arguments.</returns>
+		/*public*/ std::shared_ptr<LispScope> CreateCallScope(const std::vector<std::shared_ptr<object>> & args, std::shared_ptr<LispScope> callerScope) const;
+
+		/// <summary>
+		/// Is the given symbol a variable of the call scope besides the formal arguments (_args and _additionalArgs)?
+		/// </summary>
+		/// <param name="symbolId">The interned id of the symbol.</param>
+		/// <returns>True if the symbol is created by <see cref="CreateCallScope"/>.</returns>
+		/*public*/ static bool IsCallScopeSymbol(size_t symbolId);
+	};
+
 	// **********************************************************************
 	/// <summary>
 	/// The runtime environment for the FUEL lisp interpreter.
@@ -95,6 +146,10 @@ namespace CppLisp
 		const static string Eval;
 		const static string EvalStr;
 		const static string Quote;
+		const static string List;
+		const static string FirstFcn;
+		const static string NthFcn;
+		const static string RVal;
 		const static string Quasiquote;
 		const static string UnQuote;
 		const static string UnQuoteSplicing;
@@ -102,14 +157,40 @@ namespace CppLisp
 		const static string Sym;
 		const static string Str;
 
+		const static string If;
+		const static string While;
+		const static string Do;
+		const static string Begin;
+		const static string And;
+		const static string Or;
+		const static string Def;
+		const static string Gdef;
+		const static string Setf;
+
 		// methods
 		string GetFunctionsHelpFormated(const string & functionName, std::function<bool(const string &, const string &)> select = null);
 			
 		static bool IsInModules(const string & funcName, std::shared_ptr<LispScope> scope);
 		static bool IsMacro(std::shared_ptr<object> funcName, std::shared_ptr<LispScope> scope);
+		static bool IsMacro(const string & funcName, std::shared_ptr<LispScope> scope);
+		static bool IsMacro(size_t symbolId, std::shared_ptr<LispScope> scope);
+		static size_t GetSymbolId(std::shared_ptr<object> item);
 		static bool IsExpression(std::shared_ptr<object> item);
 		static bool FindFunctionInModules(const string & funcName, std::shared_ptr<LispScope> scope, std::shared_ptr<object> & foundValue);
-
+		static bool FindFunctionInModules(size_t symbolId, std::shared_ptr<LispScope> scope, std::shared_ptr<object> & foundValue);
+
+		/// <summary>
+		/// Rebuilds the index of the symbols of the imported modules (<see cref="LispRuntime::ModuleIndex"/>),
+		/// has to be called if the modules scope of the global scope was changed (import, fork).
+		/// A symbol defined in more than one module is taken from the module with the first name (path) in sorted order.
+		/// </summary>
+		/// <param name="globalScope">The global scope.</param>
+		static void RebuildModuleIndex(std::shared_ptr<LispScope> globalScope);
+
+		/// <summary>
+		/// Creates a new global scope with the builtin functions.
+		/// The builtin functions are created once, every default scope is a fork of them, see <see cref="LispScope::Fork"/>.
+		/// </summary>
 		static std::shared_ptr<LispScope> CreateDefaultScope();
 
 		static std::shared_ptr<object> QueryItem(std::shared_ptr<object> funcName, std::shared_ptr<LispScope> scope, const string & key);
@@ -119,6 +200,9 @@ namespace CppLisp
 		static std::shared_ptr<IEnumerable<std::shared_ptr<object>>> CheckForList(const string & functionName, std::shared_ptr<object> listObj, std::shared_ptr<LispScope> scope);
 
         static string GetLispType(std::shared_ptr<object> obj);
+
+	private:
+		static std::shared_ptr<LispScope> CreateBuiltinScope();
 	};
 }
 
@@ -32,6 +32,7 @@ namespace CppLisp
 		//: base(text)
 		: LispExceptionBase(text)
 	{
+		COUNT_RUNTIME_STATISTIC(ExceptionsThrown);
 		Message = text;
 		if (scope != 0)
 		{
@@ -53,6 +54,7 @@ namespace CppLisp
 		//: base(text)
 		: LispExceptionBase(text)
 	{
+		COUNT_RUNTIME_STATISTIC(ExceptionsThrown);
 		Message = text;
 		AddModuleNameAndStackInfos(moduleName, stackInfo);
 		AddTokenInfos(token);
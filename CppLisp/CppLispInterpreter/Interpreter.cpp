@@ -25,6 +25,7 @@
 
 #include "Interpreter.h"
 #include "Exception.h"
+#include "Profiler.h"
 
 namespace CppLisp
 {
@@ -73,6 +74,8 @@ namespace CppLisp
 
 	std::shared_ptr<LispVariant> LispInterpreter::EvalAst(std::shared_ptr<object> ast, std::shared_ptr<LispScope> scope)
 	{
+		COUNT_RUNTIME_STATISTIC(EvalAstCalls);
+
 		if (ast.get() == null)
 		{
 			return null;
@@ -130,11 +133,7 @@ namespace CppLisp
 				// Result:
 				// (setf a (+ \"blub\" \"xyz\"))  <-- replace formal arguments (as symbol)
 
-				bool anyMacroReplaced = false;
-				var runtimeMacro = macro->ToLispMacroRuntimeEvaluate();
-				var expression = ReplaceFormalArgumentsInExpression(runtimeMacro->FormalArguments, astAsList, runtimeMacro->Expression, scope, /*ref*/ anyMacroReplaced);
-
-				return EvalAst(std::make_shared<object>(*expression), scope);
+				return EvalAst(ExpandRuntimeMacro(ast, macro, scope), scope);
 			}
 
 			// expand macro at compile time: --> nothing to do at run time !
@@ -150,6 +149,10 @@ namespace CppLisp
 		// for debugging: update the current line number at the current scope
 		var currentToken = astAsList->First()->ToLispVariantRef().Token;
 		scope->CurrentToken = currentToken != null ? currentToken : scope->CurrentToken;
+		if (LispProfiler::SampleRequested.load(std::memory_order_relaxed))
+		{
+			LispProfiler::TakeSample(scope.get());
+		}
 
 		// resolve values via local and global scope
 		var astWithResolvedValues = ResolveArgsInScopes(scope, astAsList, false);
@@ -212,6 +215,15 @@ namespace CppLisp
 		return functionWrapper.Function(arguments, scope);
 	}
 
+	std::shared_ptr<object> LispInterpreter::ExpandRuntimeMacro(std::shared_ptr<object> ast, std::shared_ptr<object> macro, std::shared_ptr<LispScope> scope)
+	{
+		COUNT_RUNTIME_STATISTIC(MacroExpansions);
+		bool anyMacroReplaced = false;
+		var runtimeMacro = macro->ToLispMacroRuntimeEvaluate();
+		var expression = ReplaceFormalArgumentsInExpression(runtimeMacro->FormalArguments, ast->IsLispVariant() ? ast->ToLispVariantRef().LispListValueRef() : ast->ToLispListRef(), runtimeMacro->Expression, scope, /*ref*/ anyMacroReplaced);
+		return std::make_shared<object>(*expression);
+	}
+
 #ifdef ENABLE_COMPILE_TIME_MACROS 
 
 	std::shared_ptr<object> LispInterpreter::ExpandMacros(std::shared_ptr<object> ast, std::shared_ptr<LispScope> globalScope)
@@ -262,12 +274,11 @@ namespace CppLisp
 			var fcn = (*globalScope)[functionName]->ToLispVariantRef().FunctionValue();
 			if (fcn.IsEvalInExpand())
 			{
-				var args = std::make_shared<IEnumerable<std::shared_ptr<object>>>(astAsList);
-				args->RemoveAt(0);
+				var args = astAsList.Skip(1);
 
 				// process compile time macro definition 
 				//   --> side effect: add macro definition to internal macro scope
-				fcn.Function(args->ToArray(), globalScope);
+				fcn.Function(args.ToArray(), globalScope);
 
 				// compile time macros definitions will be removed from code in expand macro phase
 				// because only the side effect above is needed for further macro replacements
@@ -281,11 +292,12 @@ namespace CppLisp
 			var macro = LispEnvironment::GetMacro(function, globalScope);
 			if (macro->IsLispMacroCompileTimeExpand())
 			{
+				COUNT_RUNTIME_STATISTIC(MacroExpansions);
 				anyMacroReplaced = true;
 				var macroExpand = macro->ToLispMacroCompileTimeExpand();
-				var astWithReplacedArguments = std::make_shared<object>(*ReplaceFormalArgumentsInExpression(macroExpand->FormalArguments, std::make_shared<IEnumerable<std::shared_ptr<object>>>(astAsList), macroExpand->Expression, globalScope, /*ref*/ anyMacroReplaced));
+				var astWithReplacedArguments = std::make_shared<object>(*ReplaceFormalArgumentsInExpression(macroExpand->FormalArguments, ast->ToLispListRef(), macroExpand->Expression, globalScope, /*ref*/ anyMacroReplaced));
 				// process recursive macro expands (do not wrap list as LispVariant at this point)
-				var processedAst = ConvertLispVariantListToListIfNeeded(EvalAst(astWithReplacedArguments, globalScope)->Value);
+				var processedAst = ConvertLispVariantListToListIfNeeded(EvalAst(astWithReplacedArguments, globalScope)->BoxedValue());
 				return std::make_shared<object>(*processedAst);
 			}
 		}
@@ -362,12 +374,13 @@ namespace CppLisp
 		return ret;
 	}
 
-	std::shared_ptr<IEnumerable<std::shared_ptr<object>>> LispInterpreter::ReplaceFormalArgumentsInExpression(std::shared_ptr<IEnumerable<std::shared_ptr<object>>> formalArguments, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> astAsList, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> expression, std::shared_ptr<LispScope> scope, /*ref*/ bool & anyMacroReplaced)
+	std::shared_ptr<IEnumerable<std::shared_ptr<object>>> LispInterpreter::ReplaceFormalArgumentsInExpression(std::shared_ptr<IEnumerable<std::shared_ptr<object>>> formalArguments, const LispList & astAsList, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> expression, std::shared_ptr<LispScope> scope, /*ref*/ bool & anyMacroReplaced)
 	{
 		// replace (quoted-macro-args) --> '(<real_args>)
 		int i = 1;
 		bool replaced = false;
-		IEnumerable<std::shared_ptr<object>> realArguments = astAsList->Skip(1)/*.ToList()*/;
+		// the real arguments share the elements with the macro call
+		LispList realArguments = astAsList.Skip(1)/*.ToList()*/;
 		IEnumerable<std::shared_ptr<object>> lst;
 		lst.Add(std::make_shared<object>(LispVariant(LispType::_Symbol, std::make_shared<object>(LispEnvironment::Quote))));
 		lst.Add(std::make_shared<object>(LispVariant(std::make_shared<object>(realArguments))));
@@ -377,14 +390,14 @@ namespace CppLisp
 		for (var formalArgument : *formalArguments)
 		{
 			std::shared_ptr<object> value;
-			auto elem = (*astAsList)[i];
+			auto elem = astAsList.ElementAt(i);
 			if (elem->IsIEnumerableOfObject() || elem->IsList())
 			{
-				value = /*elem;*/ ExpandMacros((*astAsList)[i], scope, /*ref*/ anyMacroReplaced);
+				value = /*elem;*/ ExpandMacros(astAsList.ElementAt(i), scope, /*ref*/ anyMacroReplaced);
 			}
 			else
 			{
-				value = std::make_shared<object>(LispVariant((*astAsList)[i]));
+				value = std::make_shared<object>(LispVariant(astAsList.ElementAt(i)));
 			}
 			expression = ReplaceSymbolWithValueInExpression(/*(LispVariant)*/formalArgument->ToLispVariantRef(), value, expression, false, /*ref*/ anyMacroReplaced);
 			i++;
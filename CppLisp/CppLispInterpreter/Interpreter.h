@@ -73,6 +73,17 @@ namespace CppLisp
         /// <exception cref="System.Exception">Unexpected macro modus!</exception>
 		/*public*/ static std::shared_ptr<LispVariant> EvalAst(std::shared_ptr<object> ast, std::shared_ptr<LispScope> scope);
 
+		/// <summary>
+		/// Expands the call of a macro which is evaluated at run time:
+		/// the formal arguments of the macro are replaced by the (not evaluated) 
+		/// arguments of the call.
+		/// </summary>
+		/// <param name="ast">The ast of the macro call.</param>
+		/// <param name="macro">The macro, see <see cref="LispEnvironment::GetMacro"/>.</param>
+		/// <param name="scope">The scope.</param>
+		/// <returns>The expression to evaluate for the macro call.</returns>
+		/*public*/ static std::shared_ptr<object> ExpandRuntimeMacro(std::shared_ptr<object> ast, std::shared_ptr<object> macro, std::shared_ptr<LispScope> scope);
+
 #ifdef ENABLE_COMPILE_TIME_MACROS 
 
 		/*public*/ static std::shared_ptr<object> ExpandMacros(std::shared_ptr<object> ast, std::shared_ptr<LispScope> globalScope);
@@ -95,7 +106,7 @@ namespace CppLisp
 		/*private*/ static LispBreakpointPosition GetPosInfo(std::shared_ptr<object> item);
 
 		/*private*/ static std::shared_ptr<IEnumerable<std::shared_ptr<object>>> ReplaceSymbolWithValueInExpression(const LispVariant & symbol, std::shared_ptr<object> symbolValue, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> expression, bool macroArgsReplace, /*ref*/ bool & replacedAnything);
-		/*private*/ static std::shared_ptr<IEnumerable<std::shared_ptr<object>>> ReplaceFormalArgumentsInExpression(std::shared_ptr<IEnumerable<std::shared_ptr<object>>> formalArguments, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> astAsList, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> expression, std::shared_ptr<LispScope> scope, /*ref*/ bool & anyMacroReplaced);
+		/*private*/ static std::shared_ptr<IEnumerable<std::shared_ptr<object>>> ReplaceFormalArgumentsInExpression(std::shared_ptr<IEnumerable<std::shared_ptr<object>>> formalArguments, const LispList & astAsList, std::shared_ptr<IEnumerable<std::shared_ptr<object>>> expression, std::shared_ptr<LispScope> scope, /*ref*/ bool & anyMacroReplaced);
 		/*private*/ static bool IsSymbol(std::shared_ptr<object> elem);
 
         //#endregion
@@ -110,18 +110,82 @@ namespace CppLisp
 		return info;
 	}
 
-	std::shared_ptr<LispVariant> Lisp::Eval(const string & lispCode, std::shared_ptr<LispScope> scope/*= null*/, const string & moduleName/*= null*/, bool tracing/*, Dictionary<string, object> nativeItems = null*/, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp, bool onlyMacroExpand)
+	std::shared_ptr<LispVariant> Lisp::Eval(const string & lispCode, std::shared_ptr<LispScope> scope/*= null*/, const string & moduleName/*= null*/, bool tracing/*, Dictionary<string, object> nativeItems = null*/, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp, bool onlyMacroExpand, const string & cacheFileName)
 	{
 		// first create global scope, needed for macro expanding
+		var currentScope = PrepareScope(scope, moduleName, tracing, outp, inp);
+		return EvalInScope(lispCode, currentScope, onlyMacroExpand, cacheFileName, /*position:*/ 0, /*lineNo:*/ 1);
+	}
+
+	std::shared_ptr<LispVariant> Lisp::SaveEval(const string & lispCode, const string & moduleName, bool verboseErrorOutput, bool tracing, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp, bool onlyMacroExpand)
+	{
+		return SaveEvalCall([&]() -> std::shared_ptr<LispVariant>
+		{
+			return Eval(lispCode, /*scope:*/ null, /*moduleName :*/ moduleName, /*tracing :*/ tracing, outp, inp, onlyMacroExpand);
+		}, verboseErrorOutput, outp);
+	}
+
+	std::shared_ptr<LispVariant> Lisp::EvalForms(std::shared_ptr<LispReader> reader, std::shared_ptr<LispScope> scope/*= null*/, const string & moduleName/*= null*/, bool tracing, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp)
+	{
+		var currentScope = PrepareScope(scope, moduleName, tracing, outp, inp);
+		var result = std::make_shared<LispVariant>();
+		string form;
+		while (reader->ReadForm(/*out*/ form))
+		{
+			result = EvalInScope(form, currentScope, /*onlyMacroExpand:*/ false, /*cacheFileName:*/ string::Empty, reader->GetPosition(), reader->GetLineNo());
+		}
+		return result;
+	}
+
+	std::shared_ptr<LispVariant> Lisp::SaveEvalForms(std::shared_ptr<LispReader> reader, const string & moduleName, bool verboseErrorOutput, bool tracing, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp)
+	{
+		return SaveEvalCall([&]() -> std::shared_ptr<LispVariant>
+		{
+			return EvalForms(reader, /*scope:*/ null, /*moduleName :*/ moduleName, /*tracing :*/ tracing, outp, inp);
+		}, verboseErrorOutput, outp);
+	}
+
+	LispRuntimeStatistics Lisp::GetRuntimeStatistics()
+	{
+		return LispRuntimeStatistics::GetCurrent();
+	}
+
+	void Lisp::ResetRuntimeStatistics()
+	{
+		LispRuntimeStatistics::Reset();
+	}
+
+	void Lisp::RegisterNativeObjects(/*Dictionary<string, object> nativeItems,*/ LispScope & /*currentScope*/)
+	{
+		// TODO --> implement native objects
+		//			if (nativeItems != null)
+		//			{
+		//				foreach(KeyValuePair<string, object> item in nativeItems)
+		//				{
+		//					currentScope[item.Key] = new LispVariant(LispType.NativeObject, item.Value);
+		//				}
+		//			}
+	}
+
+	std::shared_ptr<LispScope> Lisp::PrepareScope(std::shared_ptr<LispScope> scope, const string & moduleName, bool tracing, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp)
+	{
 		var currentScope = scope == null ? LispEnvironment::CreateDefaultScope() : scope;
 		currentScope->ModuleName = moduleName;
 		currentScope->Tracing = tracing;
 		currentScope->Output = outp != null ? outp : (scope != null ? scope->Output : std::make_shared<TextWriter>());
 		currentScope->Input = inp != null ? inp : (scope != null ? scope->Input : std::make_shared<TextReader>());
 		RegisterNativeObjects(/*nativeItems,*/ *currentScope);
+		return currentScope;
+	}
+
+	std::shared_ptr<LispVariant> Lisp::EvalInScope(const string & lispCode, std::shared_ptr<LispScope> currentScope, bool onlyMacroExpand, const string & cacheFileName, size_t position, size_t lineNo)
+	{
 		size_t offset = 0;
 		string code = /*LispUtils.*/DecorateWithBlock(lispCode, /*out*/ offset);
-		var ast = LispParser::Parse(code, offset, currentScope);
+		// positions and line numbers of the tokens are relative to the whole code of a reader,
+		// the offset may wrap around because the positions are calculated as code position - offset
+		offset -= position;
+		var ast = LispParser::Parse(code, offset, currentScope, cacheFileName, lineNo);
 #ifdef ENABLE_COMPILE_TIME_MACROS 
 		var expandedAst = std::make_shared<object>(*(LispInterpreter::ExpandMacros(std::make_shared<object>(*ast), currentScope)));
 #else
@@ -134,17 +198,18 @@ namespace CppLisp
 		}
 		else
 		{
-			result = LispInterpreter::EvalAst(expandedAst, currentScope);
+			var code = LispCompiler::Compile(expandedAst, currentScope);
+			result = LispVirtualMachine::Execute(code, currentScope);
 		}
 		return result;
 	}
 
-	std::shared_ptr<LispVariant> Lisp::SaveEval(const string & lispCode, const string & moduleName, bool verboseErrorOutput, bool tracing, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp, bool onlyMacroExpand)
+	std::shared_ptr<LispVariant> Lisp::SaveEvalCall(std::function<std::shared_ptr<LispVariant>()> eval, bool verboseErrorOutput, std::shared_ptr<TextWriter> outp)
 	{
 		std::shared_ptr<LispVariant> result;
 		try
 		{
-			result = Eval(lispCode, /*scope:*/ null, /*moduleName :*/ moduleName, /*tracing :*/ tracing, outp, inp, onlyMacroExpand);
+			result = eval();
 		}
 		catch (LispException exc)
 		{
@@ -182,16 +247,4 @@ namespace CppLisp
 		}
 		return result;
 	}
-
-	void Lisp::RegisterNativeObjects(/*Dictionary<string, object> nativeItems,*/ LispScope & /*currentScope*/)
-	{
-		// TODO --> implement native objects
-		//			if (nativeItems != null)
-		//			{
-		//				foreach(KeyValuePair<string, object> item in nativeItems)
-		//				{
-		//					currentScope[item.Key] = new LispVariant(LispType.NativeObject, item.Value);
-		//				}
-		//			}
-	}
 }
\ No newline at end of file
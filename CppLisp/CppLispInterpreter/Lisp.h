@@ -44,9 +44,19 @@
 *    |
 *    |   AST = List<object> object=LispVariant|List<object>
 *    |
-*    |   --------------------           ---------------             --------
-*    --> | Interpreter/Eval |   --->    | Environment |     --->    | .NET |
+*    |   ------------
+*    --> | Compiler |
+*        ------------
+*
+*        ByteCode = List<Instruction> + Constants + CallSites
+*
 *        --------------------           ---------------             --------
+*        | VirtualMachine   |   --->    | Environment |     --->    | .NET |
+*        --------------------           ---------------             --------
+*                 |
+*        --------------------
+*        | Interpreter/Eval |  (macros at run time, debugging, tracing)
+*        --------------------
 *
 */
 
@@ -61,6 +71,12 @@
 #include "cstypes.h"
 #include "Parser.h"
 #include "Interpreter.h"
+#include "Compiler.h"
+#include "VirtualMachine.h"
+#include "RuntimeStatistics.h"
+#include "Reader.h"
+
+#include <functional>
 
 namespace CppLisp
 {
@@ -101,8 +117,9 @@ namespace CppLisp
 		/// <param name="moduleName">The module name and path.</param>
 		/// <param name="tracing">if set to <c>true</c> [tracing].</param>
 		/// <param name="nativeItems">The dictionary with native items.</param>
+		/// <param name="cacheFileName">The file name of the <see cref="LispModuleCache"/> for the tokens of the code, an empty string disables the cache.</param>
 		/// <returns>The result of the script evaluation</returns>
-		/*public*/ static std::shared_ptr<LispVariant> Eval(const string & lispCode, std::shared_ptr<LispScope> scope = 0/*= null*/, const string & moduleName = "test"/*= null*/, bool tracing = false/*, Dictionary<string, object> nativeItems = null*/, std::shared_ptr<TextWriter> outp = null, std::shared_ptr<TextReader> inp = null, bool onlyMacroExpand = false);
+		/*public*/ static std::shared_ptr<LispVariant> Eval(const string & lispCode, std::shared_ptr<LispScope> scope = 0/*= null*/, const string & moduleName = "test"/*= null*/, bool tracing = false/*, Dictionary<string, object> nativeItems = null*/, std::shared_ptr<TextWriter> outp = null, std::shared_ptr<TextReader> inp = null, bool onlyMacroExpand = false, const string & cacheFileName = ""/*= null*/);
 
 		/// <summary>
 		/// Evals the specified lisp code.
@@ -116,6 +133,46 @@ namespace CppLisp
 		/// <returns>The result</returns>
 		/*public*/ static std::shared_ptr<LispVariant> SaveEval(const string & lispCode, const string & moduleName = /* null*/ "main", bool verboseErrorOutput = false, bool tracing = false, std::shared_ptr<TextWriter> outp = null, std::shared_ptr<TextReader> inp = null, bool onlyMacroExpand = false);
 
+		/// <summary>
+		/// Evals the lisp code of the reader form by form, every top level form is
+		/// tokenized, compiled and executed before the next form is read,
+		/// so large inputs are evaluated with bounded memory.
+		/// An exception may occure if the lisp code is invalid,
+		/// the forms read before the invalid form are already evaluated.
+		/// </summary>
+		/// <param name="reader">The reader for the lisp code.</param>
+		/// <param name="scope">The scope.</param>
+		/// <param name="moduleName">The module name and path.</param>
+		/// <param name="tracing">if set to <c>true</c> [tracing].</param>
+		/// <returns>The result of the last form</returns>
+		/*public*/ static std::shared_ptr<LispVariant> EvalForms(std::shared_ptr<LispReader> reader, std::shared_ptr<LispScope> scope = 0/*= null*/, const string & moduleName = "test"/*= null*/, bool tracing = false, std::shared_ptr<TextWriter> outp = null, std::shared_ptr<TextReader> inp = null);
+
+		/// <summary>
+		/// Evals the lisp code of the reader form by form.
+		/// All exceptions will be filtered and an error value will be returned.
+		/// </summary>
+		/// <param name="reader">The reader for the lisp code.</param>
+		/// <param name="moduleName">The current module name.</param>
+		/// <param name="verboseErrorOutput">if set to <c>true</c> [verbose error output].</param>
+		/// <param name="tracing">if set to <c>true</c> [tracing].</param>
+		/// <returns>The result</returns>
+		/*public*/ static std::shared_ptr<LispVariant> SaveEvalForms(std::shared_ptr<LispReader> reader, const string & moduleName = /* null*/ "main", bool verboseErrorOutput = false, bool tracing = false, std::shared_ptr<TextWriter> outp = null, std::shared_ptr<TextReader> inp = null);
+
+		//#endregion
+
+		//#region runtime statistics
+
+		/// <summary>
+		/// Returns the current counters of the interpreter core for the calling thread.
+		/// </summary>
+		/// <returns>The counters</returns>
+		/*public*/ static LispRuntimeStatistics GetRuntimeStatistics();
+
+		/// <summary>
+		/// Sets all counters of the interpreter core for the calling thread to zero.
+		/// </summary>
+		/*public*/ static void ResetRuntimeStatistics();
+
 		//#endregion
 
 	private:
@@ -123,6 +180,12 @@ namespace CppLisp
 
 		/*private*/ static void RegisterNativeObjects(/*Dictionary<string, object> nativeItems,*/ LispScope & /*currentScope*/);
 
+		/*private*/ static std::shared_ptr<LispScope> PrepareScope(std::shared_ptr<LispScope> scope, const string & moduleName, bool tracing, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp);
+
+		/*private*/ static std::shared_ptr<LispVariant> EvalInScope(const string & lispCode, std::shared_ptr<LispScope> currentScope, bool onlyMacroExpand, const string & cacheFileName, size_t position, size_t lineNo);
+
+		/*private*/ static std::shared_ptr<LispVariant> SaveEvalCall(std::function<std::shared_ptr<LispVariant>()> eval, bool verboseErrorOutput, std::shared_ptr<TextWriter> outp);
+
 		//#endregion
 	};
 }
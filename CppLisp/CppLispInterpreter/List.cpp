@@ -0,0 +1,203 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "List.h"
+#include "csobject.h"
+#include "RuntimeStatistics.h"
+
+#include <mutex>
+
+namespace CppLisp
+{
+	// protects the copies made by Elements(), a list can be read by several threads
+	static std::mutex g_OwnStorageLock;
+
+	LispList::LispList()
+		: m_Storage(std::make_shared<Storage>()), m_Offset(0), m_Count(AllItems)
+	{
+		m_Storage->Front = 0;
+	}
+
+	LispList::LispList(const IEnumerable<std::shared_ptr<object>> & elements)
+		: m_Storage(std::make_shared<Storage>()), m_Offset(0), m_Count(AllItems)
+	{
+		m_Storage->Items = elements;
+		m_Storage->Front = 0;
+	}
+
+	LispList::LispList(IEnumerable<std::shared_ptr<object>> && elements)
+		: m_Storage(std::make_shared<Storage>()), m_Offset(0), m_Count(AllItems)
+	{
+		m_Storage->Items = std::move(elements);
+		m_Storage->Front = 0;
+	}
+
+	LispList::LispList(std::shared_ptr<Storage> storage, size_t offset, size_t count)
+		: m_Storage(storage), m_Offset(offset), m_Count(count)
+	{
+	}
+
+	LispList::LispList(const LispList & other)
+		: m_Storage(other.m_Storage), m_Offset(other.m_Offset), m_Count(other.m_Count)
+	{
+	}
+
+	LispList & LispList::operator=(const LispList & other)
+	{
+		m_Storage = other.m_Storage;
+		m_Offset = other.m_Offset;
+		m_Count = other.m_Count;
+		m_OwnStorage = null;
+		return *this;
+	}
+
+	std::shared_ptr<LispList::Storage> LispList::CopyToNewStorage() const
+	{
+		COUNT_RUNTIME_STATISTIC(PayloadCopies);
+		std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+		var begin = m_Storage->Items.begin() + m_Offset;
+		storage->Items.assign(begin, begin + Count());
+		storage->Front = 0;
+		return storage;
+	}
+
+	const IEnumerable<std::shared_ptr<object>> & LispList::OwnElements() const
+	{
+		std::lock_guard<std::mutex> guard(g_OwnStorageLock);
+		if (m_OwnStorage == null)
+		{
+			m_OwnStorage = CopyToNewStorage();
+		}
+		return m_OwnStorage->Items;
+	}
+
+	LispList LispList::Skip(size_t count) const
+	{
+		return Slice(count, AllItems);
+	}
+
+	LispList LispList::Slice(size_t pos, size_t count) const
+	{
+		size_t size = Count();
+		pos = pos < size ? pos : size;
+		count = count < size - pos ? count : size - pos;
+		return LispList(m_Storage, m_Offset + pos, count);
+	}
+
+	LispList LispList::Cons(const std::shared_ptr<object> & element, const LispList & tail)
+	{
+		size_t size = tail.Count();
+		size_t front = tail.m_Offset;
+		if (front > 0 && tail.m_Storage->Front.compare_exchange_strong(front, front - 1))
+		{
+			// the place in front of the tail was free and is claimed now: use it, the storage is shared with the tail
+			tail.m_Storage->Items[tail.m_Offset - 1] = element;
+			return LispList(tail.m_Storage, tail.m_Offset - 1, size + 1);
+		}
+
+		// copy the tail into a new storage with as many free places in front as elements
+		size_t room = size > 4 ? size : 4;
+		std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+		storage->Items.reserve(room + 1 + size);
+		storage->Items.resize(room);
+		storage->Items.push_back(element);
+		var begin = tail.m_Storage->Items.begin() + tail.m_Offset;
+		storage->Items.insert(storage->Items.end(), begin, begin + size);
+		storage->Front = room;
+		return LispList(storage, room, size + 1);
+	}
+
+	LispList LispList::Append(const std::vector<const LispList *> & lists)
+	{
+		if (lists.empty())
+		{
+			return LispList();
+		}
+		// put the elements of the other lists in front of the last list, starting with the last element
+		LispList result = *(lists.back());
+		for (size_t i = lists.size() - 1; i > 0; i--)
+		{
+			const LispList & list = *(lists[i - 1]);
+			for (size_t j = list.Count(); j > 0; j--)
+			{
+				result = Cons(list.ElementAt(j - 1), result);
+			}
+		}
+		return result;
+	}
+
+	IEnumerable<std::shared_ptr<object>> & LispList::MutableElements()
+	{
+		if (!IsWholeStorage() || m_Storage.use_count() > 1)
+		{
+			// the copy made by Elements() is not shared with other lists
+			m_Storage = m_OwnStorage != null ? m_OwnStorage : CopyToNewStorage();
+			m_Offset = 0;
+		}
+		m_OwnStorage = null;
+		// the number of elements may change
+		m_Count = AllItems;
+		return m_Storage->Items;
+	}
+
+	void LispList::Insert(size_t index, const std::shared_ptr<object> & element)
+	{
+		if (index == 0)
+		{
+			*this = Cons(element, *this);
+			return;
+		}
+		IEnumerable<std::shared_ptr<object>> & elements = MutableElements();
+		elements.Insert((int)index, element);
+	}
+
+	void LispList::RemoveAt(size_t index)
+	{
+		size_t size = Count();
+		if (index >= size)
+		{
+			return;
+		}
+		if (index == 0)
+		{
+			// move the view behind the first element, the storage is not changed
+			if (m_Storage.use_count() == 1 && m_Offset == m_Storage->Front.load())
+			{
+				// the storage is not shared: release the element and free the place for cons
+				m_Storage->Items[m_Offset].reset();
+				m_Storage->Front++;
+			}
+			m_Offset++;
+			m_OwnStorage = null;
+			if (m_Count != AllItems)
+			{
+				m_Count--;
+			}
+			return;
+		}
+		IEnumerable<std::shared_ptr<object>> & elements = MutableElements();
+		elements.RemoveAt(index);
+	}
+}
@@ -0,0 +1,170 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_LIST_H
+#define _LISP_LIST_H
+
+#include "cstypes.h"
+#include "csstring.h"
+
+#include <atomic>
+
+namespace CppLisp
+{
+	class object;
+
+	/// <summary>
+	/// The elements of a fuel list.
+	/// A list is a view (offset and count) of a storage, which is shared with
+	/// other lists, so rest and cons do not copy the elements:
+	/// rest creates a view starting at the next element, cons puts the new 
+	/// element in front of the elements of the tail if this place of the 
+	/// storage is still free. Otherwise cons copies the tail into a new 
+	/// storage with free places in front, so cons is O(1) amortized.
+	/// Elements of the storage are never changed while the storage is shared,
+	/// modifications (for example setf, push, pop) copy a shared storage first.
+	/// Elements() returns the elements as IEnumerable, a list which is not
+	/// the whole storage is copied once into its own storage for this.
+	/// Lists can be read by several threads at the same time (see pmap):
+	/// the free places in front are claimed atomically and the copy for
+	/// Elements() is made under a lock.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispList
+	{
+	private:
+		struct Storage
+		{
+			IEnumerable<std::shared_ptr<object>> Items;
+
+			/// <summary>
+			/// Index of the first used item, the items before are free for cons.
+			/// </summary>
+			std::atomic<size_t> Front;
+		};
+
+		/// <summary>
+		/// Count of a list which has all items of the storage from its offset,
+		/// the count changes with modifications of the elements.
+		/// </summary>
+		const static size_t AllItems = (size_t)-1;
+
+		std::shared_ptr<Storage> m_Storage;
+		size_t m_Offset;
+		size_t m_Count;
+
+		/// <summary>
+		/// Copy of the elements returned by Elements() if this list is not the whole storage.
+		/// </summary>
+		mutable std::shared_ptr<Storage> m_OwnStorage;
+
+		LispList(std::shared_ptr<Storage> storage, size_t offset, size_t count);
+
+		inline bool IsWholeStorage() const
+		{
+			return m_Offset == 0 && (m_Count == AllItems || m_Count == m_Storage->Items.size());
+		}
+
+		std::shared_ptr<Storage> CopyToNewStorage() const;
+		const IEnumerable<std::shared_ptr<object>> & OwnElements() const;
+
+	public:
+		LispList();
+		explicit LispList(const IEnumerable<std::shared_ptr<object>> & elements);
+		explicit LispList(IEnumerable<std::shared_ptr<object>> && elements);
+
+		/// <summary>
+		/// The copy shares the storage, the copy of the elements for Elements() is not shared.
+		/// </summary>
+		LispList(const LispList & other);
+		LispList & operator=(const LispList & other);
+
+		inline size_t Count() const
+		{
+			return m_Count != AllItems ? m_Count : m_Storage->Items.size() - m_Offset;
+		}
+
+		inline const std::shared_ptr<object> & ElementAt(size_t index) const
+		{
+			return m_Storage->Items[m_Offset + index];
+		}
+
+		inline const std::shared_ptr<object> & First() const
+		{
+			return ElementAt(0);
+		}
+
+		inline const std::shared_ptr<object> & Last() const
+		{
+			return ElementAt(Count() - 1);
+		}
+
+		/// <summary>
+		/// Returns the list without the first count elements, O(1).
+		/// </summary>
+		LispList Skip(size_t count) const;
+
+		/// <summary>
+		/// Returns the count elements starting at the position pos, O(1).
+		/// The slice shares the elements with this list, it is clipped to the elements of this list.
+		/// </summary>
+		LispList Slice(size_t pos, size_t count) const;
+
+		/// <summary>
+		/// Returns the list with the element in front of the elements of the tail, O(1) amortized.
+		/// </summary>
+		static LispList Cons(const std::shared_ptr<object> & element, const LispList & tail);
+
+		/// <summary>
+		/// Returns the concatenation of the lists, only the elements of the 
+		/// lists before the last list are copied, the last list is shared.
+		/// </summary>
+		static LispList Append(const std::vector<const LispList *> & lists);
+
+		/// <summary>
+		/// Returns the elements as IEnumerable.
+		/// </summary>
+		inline const IEnumerable<std::shared_ptr<object>> & Elements() const
+		{
+			return IsWholeStorage() ? m_Storage->Items : OwnElements();
+		}
+
+		/// <summary>
+		/// Returns the elements for modifications, the storage is copied if it is shared.
+		/// </summary>
+		IEnumerable<std::shared_ptr<object>> & MutableElements();
+
+		/// <summary>
+		/// Inserts the element at the given index, inserting in front of the first element is O(1) amortized.
+		/// </summary>
+		void Insert(size_t index, const std::shared_ptr<object> & element);
+
+		/// <summary>
+		/// Removes the element at the given index, removing the first element is O(1).
+		/// </summary>
+		void RemoveAt(size_t index);
+	};
+}
+
+#endif
@@ -0,0 +1,332 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "ModuleCache.h"
+#include "Symbol.h"
+#include "Lisp.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace CppLisp
+{
+	const string LispModuleCache::FileExtension = ".fuelc";
+
+	// increment if the file format or the tokens created by the tokenizer change
+	const uint32_t LispModuleCache::FormatVersion = 2;
+
+	static const char Magic[8] = { 'F', 'U', 'E', 'L', 'C', 0, 0, 0 };
+	// detects cache files written on a platform with another byte order
+	static const uint32_t ByteOrderMark = 0x01020304;
+
+#if defined(_WIN32) || defined(_WIN64)
+	static const char PathSeparator = '\\';
+#else
+	static const char PathSeparator = '/';
+#endif
+
+	// ************************************************************************
+
+	/// <summary>
+	/// Appends values in the native byte order to the content of a cache file.
+	/// </summary>
+	class LispModuleCacheWriter
+	{
+	public:
+		std::string Content;
+
+		template <class T> void Write(T value)
+		{
+			Content.append((const char *)&value, sizeof(T));
+		}
+
+		void WriteString(const std::string & text)
+		{
+			Write((uint32_t)text.size());
+			Content.append(text);
+		}
+	};
+
+	/// <summary>
+	/// Reads values from the content of a cache file,
+	/// the read methods return false if the content is too short.
+	/// </summary>
+	class LispModuleCacheReader
+	{
+	public:
+		LispModuleCacheReader(const std::string & content, size_t pos)
+			: m_Content(content), m_Pos(pos)
+		{
+		}
+
+		template <class T> bool Read(T & value)
+		{
+			if (m_Content.size() - m_Pos < sizeof(T))
+			{
+				return false;
+			}
+			memcpy(&value, m_Content.data() + m_Pos, sizeof(T));
+			m_Pos += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(std::string & text)
+		{
+			uint32_t length;
+			if (!Read(length) || m_Content.size() - m_Pos < length)
+			{
+				return false;
+			}
+			text.assign(m_Content.data() + m_Pos, length);
+			m_Pos += length;
+			return true;
+		}
+
+		bool IsAtEnd() const
+		{
+			return m_Pos == m_Content.size();
+		}
+
+	private:
+		const std::string & m_Content;
+		size_t m_Pos;
+	};
+
+	// ************************************************************************
+
+	static bool ReadBinaryFile(const string & fileName, std::string & content)
+	{
+		std::ifstream ifs(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!ifs.good())
+		{
+			return false;
+		}
+		std::streamoff size = ifs.tellg();
+		if (size <= 0)
+		{
+			return false;
+		}
+		content.resize((size_t)size);
+		ifs.seekg(0);
+		ifs.read(&content[0], size);
+		return ifs.good();
+	}
+
+	static bool WriteBinaryFile(const string & fileName, const std::string & content)
+	{
+		std::ofstream ofs(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		ofs.write(content.data(), content.size());
+		ofs.close();
+		return ofs.good();
+	}
+
+	static void WriteHeader(LispModuleCacheWriter & writer, const string & code, size_t offset)
+	{
+		writer.Content.append(Magic, sizeof(Magic));
+		writer.Write(LispModuleCache::FormatVersion);
+		writer.Write(ByteOrderMark);
+		writer.WriteString(Lisp::Version);
+		writer.Write((uint64_t)code.size());
+		writer.Write(LispModuleCache::GetHash(code));
+		writer.Write((uint64_t)offset);
+	}
+
+	static bool HasTextValue(LispTokenType type)
+	{
+		return type != Int && type != Double && type != True && type != False && type != Nil;
+	}
+
+	// ************************************************************************
+
+	string LispModuleCache::GetCacheFileName(const string & moduleFileName, const string & cacheDirectory)
+	{
+		const string moduleExtension = ".fuel";
+		string baseName = moduleFileName;
+		if (baseName.EndsWith(moduleExtension))
+		{
+			baseName = baseName.Substring(0, baseName.size() - moduleExtension.size());
+		}
+		if (cacheDirectory.empty())
+		{
+			return baseName + FileExtension;
+		}
+		size_t pos = baseName.find_last_of("/\\");
+		if (pos != std::string::npos)
+		{
+			baseName = baseName.Substring(pos + 1);
+		}
+		char hash[20];
+		snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)GetHash(moduleFileName));
+		string directory = cacheDirectory;
+		if (directory.back() != '/' && directory.back() != '\\')
+		{
+			directory += PathSeparator;
+		}
+		return directory + baseName + "-" + hash + FileExtension;
+	}
+
+	bool LispModuleCache::Load(const string & cacheFileName, const string & code, size_t offset, std::shared_ptr<LispArena> arena, IEnumerable<std::shared_ptr<LispToken>> & tokens)
+	{
+		std::string content;
+		LispModuleCacheWriter header;
+		WriteHeader(header, code, offset);
+		if (!ReadBinaryFile(cacheFileName, content) || content.compare(0, header.Content.size(), header.Content) != 0)
+		{
+			COUNT_RUNTIME_STATISTIC(ModuleCacheMisses);
+			return false;
+		}
+
+		LispModuleCacheReader reader(content, header.Content.size());
+		IEnumerable<std::shared_ptr<LispToken>> result;
+		uint64_t count = 0;
+		bool ok = reader.Read(count) && count <= content.size();
+		if (ok)
+		{
+			result.reserve((size_t)count);
+		}
+		for (uint64_t i = 0; ok && i < count; i++)
+		{
+			uint8_t type;
+			uint64_t start;
+			uint64_t stop;
+			uint64_t lineNo;
+			ok = reader.Read(type) && reader.Read(start) && reader.Read(stop) && reader.Read(lineNo) && type <= Nil;
+			if (!ok)
+			{
+				break;
+			}
+
+			std::shared_ptr<object> value;
+			size_t symbolId = LispSymbolTable::NoSymbol;
+			LispTokenType tokenType = (LispTokenType)type;
+			if (HasTextValue(tokenType))
+			{
+				std::string text;
+				ok = reader.ReadString(text);
+				if (tokenType == Symbol)
+				{
+					// all tokens of a symbol share the interned name
+					symbolId = LispSymbolTable::Intern(text);
+					value = LispSymbolTable::GetValue(symbolId);
+				}
+				else
+				{
+					value = std::make_shared<object>(text);
+				}
+			}
+			else if (tokenType == Int)
+			{
+				int32_t intValue = 0;
+				ok = reader.Read(intValue);
+				value = std::make_shared<object>((int)intValue);
+			}
+			else if (tokenType == Double)
+			{
+				double doubleValue = 0;
+				ok = reader.Read(doubleValue);
+				value = std::make_shared<object>(doubleValue);
+			}
+			else if (tokenType == Nil)
+			{
+				value = std::make_shared<object>(null);
+			}
+			else
+			{
+				value = std::make_shared<object>(tokenType == True);
+			}
+			result.push_back(MakeArenaShared<LispToken>(arena, tokenType, value, symbolId, (size_t)start, (size_t)stop, (size_t)lineNo));
+		}
+		if (!ok || !reader.IsAtEnd())
+		{
+			COUNT_RUNTIME_STATISTIC(ModuleCacheMisses);
+			return false;
+		}
+
+		COUNT_RUNTIME_STATISTIC(ModuleCacheHits);
+		tokens.swap(result);
+		return true;
+	}
+
+	bool LispModuleCache::Save(const string & cacheFileName, const string & code, size_t offset, const IEnumerable<std::shared_ptr<LispToken>> & tokens)
+	{
+		LispModuleCacheWriter writer;
+		WriteHeader(writer, code, offset);
+		writer.Write((uint64_t)tokens.size());
+		for (const std::shared_ptr<LispToken> & token : tokens)
+		{
+			writer.Write((uint8_t)token->Type);
+			writer.Write((uint64_t)token->StartPos);
+			writer.Write((uint64_t)token->StopPos);
+			writer.Write((uint64_t)token->LineNo);
+			if (HasTextValue(token->Type))
+			{
+				writer.WriteString(token->Value->ToString());
+			}
+			else if (token->Type == Int)
+			{
+				writer.Write((int32_t)(int)*(token->Value));
+			}
+			else if (token->Type == Double)
+			{
+				writer.Write((double)*(token->Value));
+			}
+		}
+
+		// a unique temporary file for every thread, other processes or threads may write the same cache file
+		size_t unique = std::hash<std::thread::id>()(std::this_thread::get_id()) ^ (size_t)std::chrono::steady_clock::now().time_since_epoch().count();
+		string tempFileName = cacheFileName + "." + std::to_string(unique) + ".tmp";
+		if (!WriteBinaryFile(tempFileName, writer.Content))
+		{
+			std::remove(tempFileName.c_str());
+			return false;
+		}
+		if (std::rename(tempFileName.c_str(), cacheFileName.c_str()) != 0)
+		{
+			// rename does not replace an existing file on all platforms
+			std::remove(cacheFileName.c_str());
+			if (std::rename(tempFileName.c_str(), cacheFileName.c_str()) != 0)
+			{
+				std::remove(tempFileName.c_str());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint64_t LispModuleCache::GetHash(const std::string & text)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (unsigned char ch : text)
+		{
+			hash ^= ch;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,105 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_MODULECACHE_H
+#define _LISP_MODULECACHE_H
+
+#include "Token.h"
+#include "Arena.h"
+
+#include <cstdint>
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Persistent cache for the tokens of imported modules (.fuelc files).
+	/// Tokenizing is the expensive part of an import, so the tokens of a module
+	/// are written to a binary cache file at the first import and are read from
+	/// the cache file at the following imports, the parse tree is built from the tokens.
+	/// A cache file is only used if the format version, the interpreter version,
+	/// the length and the hash of the (decorated) code are equal,
+	/// otherwise the code is tokenized again and the cache file is replaced.
+	/// The macro expanded code is not cached, because the expansion depends on the
+	/// macros of the importing scope and defines macros as side effect.
+	/// Errors while reading or writing a cache file are ignored,
+	/// i. e. for a library in a read only directory the code is tokenized at every import.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispModuleCache
+	{
+	public:
+		//#region constants
+
+		/*public*/ const static string FileExtension;
+
+		/*public*/ const static uint32_t FormatVersion;
+
+		//#endregion
+
+		//#region public static methods
+
+		/// <summary>
+		/// Returns the name of the cache file for a module file.
+		/// Without cache directory the cache file is placed next to the module file,
+		/// otherwise the name contains the hash of the module file name,
+		/// so modules with the same name in different directories get different cache files.
+		/// </summary>
+		/// <param name="moduleFileName">The file name of the module.</param>
+		/// <param name="cacheDirectory">The cache directory or an empty string.</param>
+		/// <returns>The file name of the cache file</returns>
+		/*public*/ static string GetCacheFileName(const string & moduleFileName, const string & cacheDirectory);
+
+		/// <summary>
+		/// Reads the tokens for the code from the cache file.
+		/// </summary>
+		/// <param name="cacheFileName">The file name of the cache file.</param>
+		/// <param name="code">The code, which was tokenized.</param>
+		/// <param name="offset">The position offset used for tokenizing.</param>
+		/// <param name="arena">The arena for the tokens.</param>
+		/// <param name="tokens">Output: the tokens, not changed if the cache file is not valid.</param>
+		/// <returns>True if the cache file exists and is valid for the code</returns>
+		/*public*/ static bool Load(const string & cacheFileName, const string & code, size_t offset, std::shared_ptr<LispArena> arena, IEnumerable<std::shared_ptr<LispToken>> & tokens);
+
+		/// <summary>
+		/// Writes the tokens of the code to the cache file.
+		/// The file is written with a temporary name and renamed afterwards,
+		/// so other processes never read a partially written cache file.
+		/// </summary>
+		/// <param name="cacheFileName">The file name of the cache file.</param>
+		/// <param name="code">The code, which was tokenized.</param>
+		/// <param name="offset">The position offset used for tokenizing.</param>
+		/// <param name="tokens">The tokens of the code.</param>
+		/// <returns>True if the cache file was written</returns>
+		/*public*/ static bool Save(const string & cacheFileName, const string & code, size_t offset, const IEnumerable<std::shared_ptr<LispToken>> & tokens);
+
+		/// <summary>
+		/// Returns the 64 bit FNV-1a hash of the text.
+		/// </summary>
+		/*public*/ static uint64_t GetHash(const std::string & text);
+
+		//#endregion
+	};
+}
+
+#endif
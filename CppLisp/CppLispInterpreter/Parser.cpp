@@ -24,6 +24,7 @@
 * */
 
 #include "Parser.h"
+#include "ModuleCache.h"
 #include "Exception.h"
 
 #include <stack>
@@ -36,26 +37,37 @@ const string LispParser::UnexpectedToken = "Unexpected token";
 
 namespace CppLisp
 {
-	std::shared_ptr<object> LispParser::Parse(const string & code, size_t offset, std::shared_ptr<LispScope> scope)
+	std::shared_ptr<object> LispParser::Parse(const string & code, size_t offset, std::shared_ptr<LispScope> scope, const string & cacheFileName, size_t lineNo)
 	{
 		std::shared_ptr<object> parseResult/* = null*/;
 		string moduleName = ""; // string.Empty;
 
+		// tokens and nodes of the parse tree are allocated in one arena per parsed code
+		var arena = std::make_shared<LispArena>();
+
 		// set tokens at LispScope to improve debugging and 
 		// support displaying of error position 
-		var tokens = LispTokenizer::Tokenize(code, offset);
+		IEnumerable<std::shared_ptr<LispToken>> tokens;
+		if (cacheFileName.empty() || !LispModuleCache::Load(cacheFileName, code, offset, arena, tokens))
+		{
+			tokens = LispTokenizer::Tokenize(code, offset, arena, lineNo);
+			if (!cacheFileName.empty())
+			{
+				LispModuleCache::Save(cacheFileName, code, offset, tokens);
+			}
+		}
 		if (scope.get() != null)
 		{
 			scope->Tokens = tokens;
 			moduleName = scope->ModuleName;
 		}
 
-		ParseTokens(moduleName, tokens.ToArray(), 0, /*ref*/ parseResult, /*isToplevel:*/ true);
+		ParseTokens(moduleName, tokens, 0, /*ref*/ parseResult, /*isToplevel:*/ true, arena);
 
 		return parseResult;
 	}
 
-	size_t LispParser::ParseTokens(const string & moduleName, std::vector<std::shared_ptr<LispToken>> tokens, size_t startIndex, /*ref*/ std::shared_ptr<object> & parseResult, bool isToplevel)
+	size_t LispParser::ParseTokens(const string & moduleName, const std::vector<std::shared_ptr<LispToken>> & tokens, size_t startIndex, /*ref*/ std::shared_ptr<object> & parseResult, bool isToplevel, std::shared_ptr<LispArena> arena)
 	{
 		size_t i;
 		std::shared_ptr<IEnumerable<std::shared_ptr<object>>> current = null;
@@ -66,7 +78,7 @@ namespace CppLisp
 			std::shared_ptr<LispToken> token = tokens[i];
 			if (token->Type == LispTokenType::ListStart)
 			{
-				current = std::make_shared<IEnumerable<std::shared_ptr<object>>>();
+				current = MakeArenaShared<IEnumerable<std::shared_ptr<object>>>(arena);
 				listStack.push(current);
 			}
 			else if (token->Type == LispTokenType::ListEnd)
@@ -75,7 +87,7 @@ namespace CppLisp
 				listStack.pop();
 				if (listStack.size() > 0)
 				{
-					listStack.top()->push_back/*Add*/(std::make_shared<object>(object(*temp)));
+					listStack.top()->push_back/*Add*/(MakeArenaShared<object>(arena, temp));
 					current = listStack.top();
 				}
 				else
@@ -84,41 +96,41 @@ namespace CppLisp
 					{
 						throw LispException(BracketsOutOfBalanceOrUnexpectedScriptCode, token, moduleName);
 					}
-					parseResult = std::make_shared<object>(*current);
+					parseResult = MakeArenaShared<object>(arena, current);
 					return i;
 				}
 			}
 			else if (token->Type == LispTokenType::Quote || token->Type == LispTokenType::QuasiQuote)
 			{
-				std::shared_ptr<IEnumerable<std::shared_ptr<object>>> quote = std::make_shared<IEnumerable<std::shared_ptr<object>>>();
-				quote->push_back/*Add*/(std::make_shared<object>(object(LispVariant(LispType::_Symbol, std::make_shared<object>(token->Type == LispTokenType::Quote ? LispEnvironment::Quote : LispEnvironment::Quasiquote)))));
+				std::shared_ptr<IEnumerable<std::shared_ptr<object>>> quote = MakeArenaShared<IEnumerable<std::shared_ptr<object>>>(arena);
+				quote->push_back/*Add*/(MakeArenaShared<object>(arena, LispVariant(LispType::_Symbol, MakeArenaShared<object>(arena, token->Type == LispTokenType::Quote ? LispEnvironment::Quote : LispEnvironment::Quasiquote))));
 
 				std::shared_ptr<object> quotedList = null;
-				i = ParseTokens(moduleName, tokens, i + 1, /*ref*/ quotedList, /*isToplevel:*/ false);
-				quote->push_back/*Add*/(std::make_shared<object>(object(*quotedList)));
+				i = ParseTokens(moduleName, tokens, i + 1, /*ref*/ quotedList, /*isToplevel:*/ false, arena);
+				quote->push_back/*Add*/(quotedList);
 
 				if (current != null)
 				{
-					current->push_back/*Add*/(std::make_shared<object>(object(*quote)));
+					current->push_back/*Add*/(MakeArenaShared<object>(arena, quote));
 				}
 			}
 			else if (token->Type == LispTokenType::UnQuote || token->Type == LispTokenType::UnQuoteSplicing)
 			{
-				var unquote = std::make_shared<IEnumerable<std::shared_ptr<object>>>();
+				var unquote = MakeArenaShared<IEnumerable<std::shared_ptr<object>>>(arena);
                 //LispUnQuoteModus unquotedModus = token->Type == LispTokenType::UnQuote ? LispUnQuoteModus::_UnQuote : LispUnQuoteModus::_UnQuoteSplicing;
-				unquote->push_back/*Add*/(std::make_shared<object>(LispVariant(LispType::_Symbol, std::make_shared<object>(object(token->Type == LispTokenType::UnQuote ? LispEnvironment::UnQuote : LispEnvironment::UnQuoteSplicing)))));
+				unquote->push_back/*Add*/(MakeArenaShared<object>(arena, LispVariant(LispType::_Symbol, MakeArenaShared<object>(arena, token->Type == LispTokenType::UnQuote ? LispEnvironment::UnQuote : LispEnvironment::UnQuoteSplicing))));
 
 				std::shared_ptr<object> quotedList = null;
-				i = ParseTokens(moduleName, tokens, i + 1, /*ref*/ quotedList, /*isToplevel:*/ false);
+				i = ParseTokens(moduleName, tokens, i + 1, /*ref*/ quotedList, /*isToplevel:*/ false, arena);
 				unquote->push_back/*Add*/(quotedList);
 
 				if (current != null)
 				{
-					current->push_back/*Add*/(std::make_shared<object>(*unquote));
+					current->push_back/*Add*/(MakeArenaShared<object>(arena, unquote));
 				}
 				else
 				{
-					parseResult = std::make_shared<object>(*unquote);
+					parseResult = MakeArenaShared<object>(arena, unquote);
 					return i;
 				}
 			}
@@ -130,14 +142,15 @@ namespace CppLisp
 			{
 				if (!isToplevel && current == null)
 				{
-					parseResult = std::make_shared<object>(LispVariant(token));
+					parseResult = MakeArenaShared<object>(arena, LispVariant(token));
 					return i;
 				}
 				if (current == null)
 				{
 					throw LispException(UnexpectedToken, token, moduleName);
 				}
-				current->push_back/*Add*/(std::make_shared<object>(LispVariant(std::make_shared<LispToken>(*token))));
+				// the token is shared with the token list of the scope, tokens are never modified
+				current->push_back/*Add*/(MakeArenaShared<object>(arena, LispVariant(token)));
 			}
 		}
 
@@ -147,7 +160,7 @@ namespace CppLisp
 			throw LispException(BracketsOutOfBalance, token, moduleName);
 		}
 
-		parseResult = std::make_shared<object>(*current);
+		parseResult = MakeArenaShared<object>(arena, current);
 		return i;
 	}
 
@@ -28,6 +28,7 @@
 
 #include "Token.h"
 #include "Scope.h"
+#include "Arena.h"
 
 namespace CppLisp
 {
@@ -54,15 +55,17 @@ namespace CppLisp
 		/// <param name="code">The code.</param>
 		/// <param name="offset">The position offset.</param>
 		/// <param name="scope">The scope.</param>
-		/// <returns>Abstract syntax tree as container</returns>
-		/*public*/ static std::shared_ptr<object> Parse(const string & code, size_t offset = 0, std::shared_ptr<LispScope> scope = null);
+		/// <param name="cacheFileName">The file name of the <see cref="LispModuleCache"/> for the tokens of the code or an empty string.</param>
+		/// <param name="lineNo">The line number of the first line of the code, used for code read by a <see cref="LispReader"/>.</param>
+		/// <returns>Abstract syntax tree as container, tokens and nodes are allocated in one arena which is released with the last node</returns>
+		/*public*/ static std::shared_ptr<object> Parse(const string & code, size_t offset = 0, std::shared_ptr<LispScope> scope = null, const string & cacheFileName = ""/*= null*/, size_t lineNo = 1);
 
 		//#endregion
 
 	private:
 		//#region private methods
 
-		/*private*/ static size_t ParseTokens(const string & moduleName, std::vector<std::shared_ptr<LispToken>> tokens, size_t startIndex, /*ref*/ std::shared_ptr<object> & parseResult, bool isToplevel);
+		/*private*/ static size_t ParseTokens(const string & moduleName, const std::vector<std::shared_ptr<LispToken>> & tokens, size_t startIndex, /*ref*/ std::shared_ptr<object> & parseResult, bool isToplevel, std::shared_ptr<LispArena> arena);
 
 		/*private*/ static bool OnlyCommentTokensFrom(const std::vector<std::shared_ptr<LispToken>> & tokens, size_t i);
 
@@ -0,0 +1,284 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "Profiler.h"
+#include "Scope.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#if defined( __linux__ ) || defined( __APPLE__ )
+#define _PROFILER_USE_SIGNAL
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+namespace CppLisp
+{
+	struct LispProfileCount
+	{
+		size_t Self;
+		size_t Total;
+
+		LispProfileCount()
+			: Self(0), Total(0)
+		{
+		}
+	};
+
+	struct LispProfilerData
+	{
+		std::mutex Lock;
+		std::condition_variable TimerSignal;
+		std::thread Timer;
+		bool IsRunning;
+		int IntervalInMs;
+		size_t SampleCount;
+		std::map<string, size_t> FoldedStacks;
+		std::map<string, LispProfileCount> Functions;
+		std::map<string, size_t> Lines;
+
+		LispProfilerData()
+			: IsRunning(false), IntervalInMs(LispProfiler::DefaultIntervalInMs), SampleCount(0)
+		{
+		}
+	};
+
+	static LispProfilerData & GetProfilerData()
+	{
+		static LispProfilerData data;
+		return data;
+	}
+
+	std::atomic<bool> LispProfiler::SampleRequested(false);
+
+#ifdef _PROFILER_USE_SIGNAL
+	// a thread would switch the reference counting of all shared_ptr to atomic operations,
+	// so the samples are requested by the profiling timer signal of the process
+	static struct sigaction g_PreviousAction;
+
+	static void ProfilingSignalHandler(int)
+	{
+		LispProfiler::SampleRequested.store(true, std::memory_order_relaxed);
+	}
+
+	static void StartTimer(LispProfilerData & data)
+	{
+		struct sigaction action;
+		action.sa_handler = ProfilingSignalHandler;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags = SA_RESTART;
+		sigaction(SIGPROF, &action, &g_PreviousAction);
+
+		struct itimerval timer;
+		timer.it_interval.tv_sec = data.IntervalInMs / 1000;
+		timer.it_interval.tv_usec = (data.IntervalInMs % 1000) * 1000;
+		timer.it_value = timer.it_interval;
+		setitimer(ITIMER_PROF, &timer, null);
+	}
+
+	static void StopTimer(LispProfilerData & /*data*/)
+	{
+		struct itimerval timer = {};
+		setitimer(ITIMER_PROF, &timer, null);
+		sigaction(SIGPROF, &g_PreviousAction, null);
+	}
+#else
+	static void TimerLoop(int intervalInMs)
+	{
+		LispProfilerData & data = GetProfilerData();
+		std::unique_lock<std::mutex> lock(data.Lock);
+		while (data.IsRunning)
+		{
+			data.TimerSignal.wait_for(lock, std::chrono::milliseconds(intervalInMs));
+			if (data.IsRunning)
+			{
+				LispProfiler::SampleRequested.store(true, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	static void StartTimer(LispProfilerData & data)
+	{
+		data.Timer = std::thread(TimerLoop, data.IntervalInMs);
+	}
+
+	static void StopTimer(LispProfilerData & data)
+	{
+		data.TimerSignal.notify_all();
+		data.Timer.join();
+	}
+#endif
+
+	void LispProfiler::Start(int intervalInMs)
+	{
+		Stop();
+
+		LispProfilerData & data = GetProfilerData();
+		std::lock_guard<std::mutex> guard(data.Lock);
+		data.IsRunning = true;
+		data.IntervalInMs = intervalInMs > 0 ? intervalInMs : DefaultIntervalInMs;
+		data.SampleCount = 0;
+		data.FoldedStacks.clear();
+		data.Functions.clear();
+		data.Lines.clear();
+		StartTimer(data);
+	}
+
+	void LispProfiler::Stop()
+	{
+		LispProfilerData & data = GetProfilerData();
+		{
+			std::lock_guard<std::mutex> guard(data.Lock);
+			if (!data.IsRunning)
+			{
+				return;
+			}
+			data.IsRunning = false;
+		}
+		StopTimer(data);
+		SampleRequested.store(false, std::memory_order_relaxed);
+	}
+
+	bool LispProfiler::IsRunning()
+	{
+		LispProfilerData & data = GetProfilerData();
+		std::lock_guard<std::mutex> guard(data.Lock);
+		return data.IsRunning;
+	}
+
+	static string GetFunctionName(const LispScope * scope)
+	{
+		return scope->Name + " (" + scope->ModuleName + ")";
+	}
+
+	static string GetLineName(const LispScope * scope)
+	{
+		size_t lineNo = scope->CurrentLineNo();
+		return scope->ModuleName + ":" + (lineNo != (size_t)-1 ? std::to_string(lineNo) : "?");
+	}
+
+	void LispProfiler::TakeSample(const LispScope * scope)
+	{
+		SampleRequested.store(false, std::memory_order_relaxed);
+
+		// collect the call chain from the current (inner) scope to the outer scope
+		std::vector<const LispScope *> chain;
+		for (const LispScope * current = scope; current != null && chain.size() < MaxStackDepth; current = current->Previous.get())
+		{
+			chain.push_back(current);
+		}
+
+		LispProfilerData & data = GetProfilerData();
+		std::lock_guard<std::mutex> guard(data.Lock);
+		if (!data.IsRunning || chain.empty())
+		{
+			return;
+		}
+		data.SampleCount++;
+
+		string stack = chain.size() == MaxStackDepth && chain.back()->Previous != null ? "[truncated];" : string::Empty;
+		std::vector<string> functions;
+		for (size_t i = chain.size(); i > 0; i--)
+		{
+			const LispScope * current = chain[i - 1];
+			stack += current->Name + " (" + GetLineName(current) + ")" + (i > 1 ? ";" : "");
+
+			// count recursive functions only once for the total
+			string function = GetFunctionName(current);
+			if (std::find(functions.begin(), functions.end(), function) == functions.end())
+			{
+				functions.push_back(function);
+				data.Functions[function].Total++;
+			}
+		}
+		data.FoldedStacks[stack]++;
+		data.Functions[GetFunctionName(scope)].Self++;
+		data.Lines[GetLineName(scope)]++;
+	}
+
+	size_t LispProfiler::GetSampleCount()
+	{
+		LispProfilerData & data = GetProfilerData();
+		std::lock_guard<std::mutex> guard(data.Lock);
+		return data.SampleCount;
+	}
+
+	static string FormatPercent(size_t count, size_t sampleCount)
+	{
+		char buffer[32];
+		sprintf(buffer, "%5.1f%%", sampleCount > 0 ? 100.0 * (double)count / (double)sampleCount : 0.0);
+		return buffer;
+	}
+
+	static string FormatCount(size_t count)
+	{
+		char buffer[32];
+		sprintf(buffer, "%8zu", count);
+		return buffer;
+	}
+
+	string LispProfiler::GetFlatReport()
+	{
+		LispProfilerData & data = GetProfilerData();
+		std::lock_guard<std::mutex> guard(data.Lock);
+
+		std::vector<std::pair<string, LispProfileCount>> functions(data.Functions.begin(), data.Functions.end());
+		std::stable_sort(functions.begin(), functions.end(), [](const std::pair<string, LispProfileCount> & a, const std::pair<string, LispProfileCount> & b) -> bool { return a.second.Self > b.second.Self || (a.second.Self == b.second.Self && a.second.Total > b.second.Total); });
+		std::vector<std::pair<string, size_t>> lines(data.Lines.begin(), data.Lines.end());
+		std::stable_sort(lines.begin(), lines.end(), [](const std::pair<string, size_t> & a, const std::pair<string, size_t> & b) -> bool { return a.second > b.second; });
+
+		string report = "Profile: " + std::to_string(data.SampleCount) + " samples, interval " + std::to_string(data.IntervalInMs) + " ms\n\n";
+		report += "    self  self%    total total%  function\n";
+		for (const std::pair<string, LispProfileCount> & function : functions)
+		{
+			report += FormatCount(function.second.Self) + " " + FormatPercent(function.second.Self, data.SampleCount) + " " + FormatCount(function.second.Total) + " " + FormatPercent(function.second.Total, data.SampleCount) + "  " + function.first + "\n";
+		}
+		report += "\n    self  self%  line\n";
+		for (const std::pair<string, size_t> & line : lines)
+		{
+			report += FormatCount(line.second) + " " + FormatPercent(line.second, data.SampleCount) + "  " + line.first + "\n";
+		}
+		return report;
+	}
+
+	string LispProfiler::GetFoldedStacks()
+	{
+		LispProfilerData & data = GetProfilerData();
+		std::lock_guard<std::mutex> guard(data.Lock);
+
+		string result;
+		for (const std::pair<const string, size_t> & stack : data.FoldedStacks)
+		{
+			result += stack.first + " " + std::to_string(stack.second) + "\n";
+		}
+		return result;
+	}
+}
@@ -0,0 +1,100 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_PROFILER_H
+#define _LISP_PROFILER_H
+
+#include "cstypes.h"
+#include "csstring.h"
+#include "csobject.h"
+
+#include <atomic>
+
+namespace CppLisp
+{
+	class LispScope;
+
+	/// <summary>
+	/// Sampling profiler for fuel scripts.
+	/// A timer thread requests a sample every interval, the interpreter and 
+	/// the virtual machine take the sample at the next function call by
+	/// recording the call chain of the current scope (function name, module
+	/// and current line number of every scope).
+	/// The samples are reported as flat profile per function and per line 
+	/// and as folded stacks, which can be processed by flamegraph tools.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispProfiler
+	{
+	public:
+		/*public*/ const static int DefaultIntervalInMs = 1;
+
+		/// <summary>
+		/// The maximum number of scopes recorded for one sample, 
+		/// the outer scopes of deeper call chains are truncated.
+		/// </summary>
+		/*public*/ const static size_t MaxStackDepth = 128;
+
+		/// <summary>
+		/// Flag set by the timer thread if a sample should be taken at the next function call.
+		/// </summary>
+		/*public*/ static std::atomic<bool> SampleRequested;
+
+		/// <summary>
+		/// Starts sampling, all samples of a previous run are removed.
+		/// </summary>
+		/// <param name="intervalInMs">The sampling interval in milliseconds.</param>
+		/*public*/ static void Start(int intervalInMs = DefaultIntervalInMs);
+
+		/// <summary>
+		/// Stops sampling, the samples are kept until the next start.
+		/// </summary>
+		/*public*/ static void Stop();
+
+		/*public*/ static bool IsRunning();
+
+		/// <summary>
+		/// Records the call chain of the given scope as one sample.
+		/// Called by the interpreter if a sample was requested.
+		/// </summary>
+		/// <param name="scope">The currently executed scope.</param>
+		/*public*/ static void TakeSample(const LispScope * scope);
+
+		/*public*/ static size_t GetSampleCount();
+
+		/// <summary>
+		/// Returns the flat profile: the number of samples for every function
+		/// (self and including called functions) and for every line.
+		/// </summary>
+		/*public*/ static string GetFlatReport();
+
+		/// <summary>
+		/// Returns the samples as folded stacks, one line per call chain:
+		/// "outer-function (module:line);...;inner-function (module:line) count".
+		/// </summary>
+		/*public*/ static string GetFoldedStacks();
+	};
+}
+
+#endif
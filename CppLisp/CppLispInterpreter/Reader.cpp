@@ -0,0 +1,247 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "Reader.h"
+
+#include <cstring>
+
+namespace CppLisp
+{
+	const size_t LispReader::DefaultChunkSize = 64 * 1024;
+
+	static bool IsWhiteSpace(char ch)
+	{
+		// the white space characters of the tokenizer
+		return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+	}
+
+	static bool IsQuote(char ch)
+	{
+		return ch == '\'' || ch == '`' || ch == ',';
+	}
+
+	LispReader::LispReader(std::function<bool(/*out*/ string &)> readChunk)
+		: m_ReadChunk(readChunk),
+		  m_Pos(0),
+		  m_FormStart(std::string::npos),
+		  m_Removed(0),
+		  m_Depth(0),
+		  m_LineNo(1),
+		  m_FormLineNo(1),
+		  m_FormPosition(0),
+		  m_IsInString(false),
+		  m_IsInComment(false),
+		  m_IsInAtom(false),
+		  m_WasLastBackslash(false),
+		  m_IsEndOfSource(false)
+	{
+	}
+
+	LispReader::LispReader(std::shared_ptr<std::istream> input, size_t chunkSize)
+		: LispReader([input, chunkSize](/*out*/ string & chunk) -> bool
+		  {
+			  chunk.resize(chunkSize);
+			  input->read(&chunk[0], chunkSize);
+			  chunk.resize((size_t)input->gcount());
+			  return chunk.size() > 0;
+		  })
+	{
+	}
+
+	LispReader::LispReader(std::shared_ptr<TextReader> input)
+		: LispReader([input](/*out*/ string & chunk) -> bool
+		  {
+			  if (input->EndOfStream())
+			  {
+				  return false;
+			  }
+			  chunk = input->ReadLine() + "\n";
+			  return true;
+		  })
+	{
+	}
+
+	bool LispReader::ReadForm(/*out*/ string & form)
+	{
+		do
+		{
+			while (m_Pos < m_Buffer.size())
+			{
+				char ch = m_Buffer[m_Pos];
+				if (m_IsInComment)
+				{
+					// skip the rest of the line at once
+					const char * text = m_Buffer.data();
+					const char * newLine = (const char *)memchr(text + m_Pos, '\n', m_Buffer.size() - m_Pos);
+					if (newLine == null)
+					{
+						m_Pos = m_Buffer.size();
+						break;
+					}
+					m_Pos = newLine - text + 1;
+					m_LineNo++;
+					m_IsInComment = false;
+					continue;
+				}
+
+				bool wasLastBackslash = m_WasLastBackslash;
+				m_WasLastBackslash = ch == '\\' && !wasLastBackslash;
+
+				if (m_IsInString)
+				{
+					m_Pos++;
+					if (ch == '\n')
+					{
+						m_LineNo++;
+					}
+					else if (ch == '"' && !wasLastBackslash)
+					{
+						m_IsInString = false;
+						if (m_Depth == 0)
+						{
+							FinishForm(m_Pos, /*out*/ form);
+							return true;
+						}
+					}
+					continue;
+				}
+
+				bool isString = ch == '"' && !wasLastBackslash;
+				bool isAtom = !IsWhiteSpace(ch) && ch != '(' && ch != ')' && ch != ';' && !IsQuote(ch) && !isString;
+				if (m_IsInAtom)
+				{
+					// a top level atom ends before the next delimiter
+					if (!isAtom)
+					{
+						FinishForm(m_Pos, /*out*/ form);
+						return true;
+					}
+					m_Pos++;
+					continue;
+				}
+				if (m_FormStart == std::string::npos && !IsWhiteSpace(ch) && ch != ';')
+				{
+					StartForm();
+				}
+
+				if (isString)
+				{
+					m_IsInString = true;
+				}
+				else if (isAtom)
+				{
+					// skip the @ of ,@ (also '@ and `@ like the tokenizer)
+					bool isSplicing = ch == '@' && m_Pos > m_FormStart && IsQuote(m_Buffer[m_Pos - 1]);
+					if (m_Depth == 0 && !isSplicing)
+					{
+						m_IsInAtom = true;
+					}
+				}
+				else if (ch == '\n')
+				{
+					m_LineNo++;
+				}
+				else if (ch == ';')
+				{
+					m_IsInComment = true;
+				}
+				else if (ch == '(')
+				{
+					m_Depth++;
+				}
+				else if (ch == ')')
+				{
+					m_Pos++;
+					// an unbalanced closing bracket is a form of its own
+					if (m_Depth <= 1)
+					{
+						FinishForm(m_Pos, /*out*/ form);
+						return true;
+					}
+					m_Depth--;
+					continue;
+				}
+				m_Pos++;
+			}
+		}
+		while (ReadChunk());
+
+		if (m_FormStart != std::string::npos)
+		{
+			// the source ends within a form
+			FinishForm(m_Buffer.size(), /*out*/ form);
+			return true;
+		}
+		return false;
+	}
+
+	bool LispReader::ReadChunk()
+	{
+		if (m_IsEndOfSource)
+		{
+			return false;
+		}
+
+		// remove the processed characters, only the current form is kept,
+		// a form spanning more chunks is moved only once
+		size_t keep = m_FormStart != std::string::npos ? m_FormStart : m_Pos;
+		if (keep > 0)
+		{
+			m_Buffer.erase(0, keep);
+			m_Removed += keep;
+			m_Pos -= keep;
+			if (m_FormStart != std::string::npos)
+			{
+				m_FormStart -= keep;
+			}
+		}
+
+		string chunk;
+		if (!m_ReadChunk(/*out*/ chunk))
+		{
+			m_IsEndOfSource = true;
+			return false;
+		}
+		m_Buffer.append(chunk);
+		return true;
+	}
+
+	void LispReader::StartForm()
+	{
+		m_FormStart = m_Pos;
+		m_FormLineNo = m_LineNo;
+		m_FormPosition = m_Removed + m_Pos;
+	}
+
+	void LispReader::FinishForm(size_t stop, /*out*/ string & form)
+	{
+		form = string(m_Buffer.data() + m_FormStart, stop - m_FormStart);
+		m_FormStart = std::string::npos;
+		m_Depth = 0;
+		m_IsInString = false;
+		m_IsInAtom = false;
+		m_Pos = stop;
+	}
+}
@@ -0,0 +1,144 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_READER_H
+#define _LISP_READER_H
+
+#include "cstypes.h"
+
+#include <functional>
+#include <istream>
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Streaming reader for lisp code, reads the code in chunks from a source
+	/// and returns one top level form (a list, a string, an atom or a quoted form) at a time.
+	/// The reader only detects the boundaries of the forms, the tokens of a form are
+	/// created by the tokenizer when the form is evaluated (see <see cref="Lisp::EvalForms"/>),
+	/// so every character of the code is scanned once by the reader and once by the tokenizer,
+	/// independent of the number of forms read so far.
+	/// Only the current form and the not yet processed rest of the last chunk are buffered,
+	/// i. e. the used memory is bounded by the size of the largest form plus the chunk size.
+	/// Comments and white spaces between the forms are skipped,
+	/// an unbalanced closing bracket is returned as form to report the error at evaluation,
+	/// the rest of the code is returned as form if the source ends within a form.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispReader
+	{
+	public:
+		//#region constants
+
+		/*public*/ const static size_t DefaultChunkSize;
+
+		//#endregion
+
+		//#region constructors
+
+		/// <summary>
+		/// Creates a reader for a generic source, e. g. a file descriptor or a socket.
+		/// </summary>
+		/// <param name="readChunk">Function to read the next chunk of code, returns false at the end of the source.</param>
+		explicit LispReader(std::function<bool(/*out*/ string &)> readChunk);
+
+		/// <summary>
+		/// Creates a reader for a stream, e. g. a file stream.
+		/// </summary>
+		/// <param name="input">The input stream.</param>
+		/// <param name="chunkSize">The number of characters read at once.</param>
+		explicit LispReader(std::shared_ptr<std::istream> input, size_t chunkSize = DefaultChunkSize);
+
+		/// <summary>
+		/// Creates a reader for a text reader, the code is read line by line.
+		/// </summary>
+		/// <param name="input">The text reader.</param>
+		explicit LispReader(std::shared_ptr<TextReader> input);
+
+		//#endregion
+
+		//#region public methods
+
+		/// <summary>
+		/// Reads the next top level form, reads chunks from the source until the form is complete.
+		/// </summary>
+		/// <param name="form">Output: the code of the form.</param>
+		/// <returns>True if a form was read, false at the end of the source</returns>
+		/*public*/ bool ReadForm(/*out*/ string & form);
+
+		/// <summary>
+		/// Returns the line number of the first line of the last read form.
+		/// </summary>
+		/*public*/ size_t GetLineNo() const
+		{
+			return m_FormLineNo;
+		}
+
+		/// <summary>
+		/// Returns the position of the first character of the last read form in the source.
+		/// </summary>
+		/*public*/ size_t GetPosition() const
+		{
+			return m_FormPosition;
+		}
+
+		//#endregion
+
+	private:
+		//#region private methods
+
+		/*private*/ bool ReadChunk();
+
+		/*private*/ void StartForm();
+
+		/*private*/ void FinishForm(size_t stop, /*out*/ string & form);
+
+		//#endregion
+
+		//#region private members
+
+		std::function<bool(/*out*/ string &)> m_ReadChunk;
+
+		std::string m_Buffer;
+		// position of the next not scanned character in the buffer
+		size_t m_Pos;
+		// position of the current form in the buffer or npos between two forms
+		size_t m_FormStart;
+		// number of characters removed from the front of the buffer
+		size_t m_Removed;
+		size_t m_Depth;
+		size_t m_LineNo;
+		size_t m_FormLineNo;
+		size_t m_FormPosition;
+		bool m_IsInString;
+		bool m_IsInComment;
+		bool m_IsInAtom;
+		bool m_WasLastBackslash;
+		bool m_IsEndOfSource;
+
+		//#endregion
+	};
+}
+
+#endif
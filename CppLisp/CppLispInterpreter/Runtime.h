@@ -0,0 +1,127 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_RUNTIME_H
+#define _LISP_RUNTIME_H
+
+#include "cstypes.h"
+#include "csstring.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace CppLisp
+{
+	/// <summary>
+	/// The mutable state of one interpreter instance.
+	/// Every global scope owns its runtime, the scopes of a global scope use 
+	/// the runtime of the global scope. So interpreters with different global 
+	/// scopes (i. e. different calls of Lisp::Eval without a scope) do not 
+	/// share mutable state and can run in parallel on different threads.
+	/// The symbol table is shared by all interpreters and is synchronized,
+	/// the <see cref="LispRuntimeStatistics"/> are counted per thread.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispRuntime
+	{
+	public:
+		/// <summary>
+		/// Gets the definition epoch of the scopes of this runtime.
+		/// The epoch is incremented if a symbol is removed from a scope (delvar) or 
+		/// added to a scope which is not the global scope (def, import, define-macro, eval), 
+		/// only the local variables of compiled function bodies do not change the epoch.
+		/// Used to invalidate the functions cached at the call sites by the <see cref="LispVirtualMachine"/>,
+		/// a new symbol in the global scope can not change a cached function of the global scope.
+		/// The epochs of all runtimes are different, because a new global scope may use 
+		/// the memory of a released global scope.
+		/// The epoch is atomic, because the chunks of pmap define symbols in parallel.
+		/// </summary>
+		/*public*/ std::atomic<uint64_t> DefinitionEpoch; // { get; private set; }
+
+		/// <summary>
+		/// Gets or sets the directory of the modules loaded by import.
+		/// </summary>
+		/*public*/ string LibraryPath; // { get; set; }
+
+		/// <summary>
+		/// Gets or sets a value indicating whether import uses the module cache (.fuelc files),
+		/// see <see cref="LispModuleCache"/>. Enabled by default.
+		/// </summary>
+		/*public*/ bool UseModuleCache; // { get; set; }
+
+		/// <summary>
+		/// Gets or sets the directory for the files of the module cache.
+		/// If empty the cache file of a module is written next to the module file.
+		/// </summary>
+		/*public*/ string ModuleCachePath; // { get; set; }
+
+		/// <summary>
+		/// Gets the registry of the imported modules, used by import to find an imported module
+		/// without probing the file system. Maps the module names used in import and the full
+		/// paths of the module files to the names of the modules in the modules scope.
+		/// </summary>
+		/*public*/ Dictionary<string, string> ModuleRegistry; // { get; }
+
+		/// <summary>
+		/// Gets the index of the symbols defined in the imported modules, maps the symbol id
+		/// to the cell in the scope of the module, see <see cref="LispEnvironment::RebuildModuleIndex"/>.
+		/// A symbol which is not in the index is not defined in any module.
+		/// </summary>
+		/*public*/ HashDictionary<size_t, std::shared_ptr<object> *> ModuleIndex; // { get; }
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="LispRuntime"/> class
+		/// with the default library path and the module cache next to the modules.
+		/// </summary>
+		/*public*/ LispRuntime();
+
+		/*public*/ inline void IncrementDefinitionEpoch()
+		{
+			DefinitionEpoch.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/*public*/ inline uint64_t GetDefinitionEpoch() const
+		{
+			return DefinitionEpoch.load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// Gets the library path for new runtimes.
+		/// </summary>
+		/*public*/ static string GetDefaultLibraryPath();
+
+		/// <summary>
+		/// Sets the library path for new runtimes, i. e. from the command line of the fuel program.
+		/// The library path of an existing runtime is not changed.
+		/// </summary>
+		/// <param name="libraryPath">The library path.</param>
+		/*public*/ static void SetDefaultLibraryPath(const string & libraryPath);
+
+	private:
+		LispRuntime(const LispRuntime & other);
+		LispRuntime & operator=(const LispRuntime & other);
+	};
+}
+
+#endif
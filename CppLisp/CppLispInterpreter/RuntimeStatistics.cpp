@@ -0,0 +1,78 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "RuntimeStatistics.h"
+
+namespace CppLisp
+{
+	thread_local LispRuntimeStatistics LispRuntimeStatistics_Current;
+
+	LispRuntimeStatistics & LispRuntimeStatistics::operator+=(const LispRuntimeStatistics & other)
+	{
+		EvalAstCalls += other.EvalAstCalls;
+		FunctionCalls += other.FunctionCalls;
+		FunctionScopes += other.FunctionScopes;
+		ObjectAllocations += other.ObjectAllocations;
+		ObjectCopies += other.ObjectCopies;
+		PayloadCopies += other.PayloadCopies;
+		MacroExpansions += other.MacroExpansions;
+		LocalResolves += other.LocalResolves;
+		GlobalResolves += other.GlobalResolves;
+		ClosureResolves += other.ClosureResolves;
+		ModuleResolves += other.ModuleResolves;
+		UnresolvedSymbols += other.UnresolvedSymbols;
+		ExceptionsThrown += other.ExceptionsThrown;
+		CallSiteCacheHits += other.CallSiteCacheHits;
+		CallSiteCacheMisses += other.CallSiteCacheMisses;
+		ModuleCacheHits += other.ModuleCacheHits;
+		ModuleCacheMisses += other.ModuleCacheMisses;
+		SymbolTableLocks += other.SymbolTableLocks;
+		return *this;
+	}
+
+	LispRuntimeStatistics LispRuntimeStatistics::GetCurrent()
+	{
+		return LispRuntimeStatistics_Current;
+	}
+
+	bool LispRuntimeStatistics::IsEnabled()
+	{
+#ifdef ENABLE_RUNTIME_STATISTICS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void LispRuntimeStatistics::Reset()
+	{
+		LispRuntimeStatistics_Current = LispRuntimeStatistics();
+	}
+
+	void LispRuntimeStatistics::Add(const LispRuntimeStatistics & statistics)
+	{
+		LispRuntimeStatistics_Current += statistics;
+	}
+}
@@ -0,0 +1,94 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_RUNTIMESTATISTICS_H
+#define _LISP_RUNTIMESTATISTICS_H
+
+#include "cstypes.h"
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Counters for the work done by the interpreter core.
+	/// The counters are only maintained if ENABLE_RUNTIME_STATISTICS is defined (see cstypes.h),
+	/// otherwise the counting code is not compiled and all counters stay zero.
+	/// Every thread counts its own work, so parallel interpreters do not share the counters,
+	/// the counters of the chunks of pmap and preduce are added to the counters of the caller.
+	/// The type has no constructor, so the counters of a thread are accessed without 
+	/// initialization check, use LispRuntimeStatistics() for a zero initialized object.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispRuntimeStatistics
+	{
+	public:
+		/*public*/ size_t EvalAstCalls;			// calls of LispInterpreter::EvalAst
+		/*public*/ size_t FunctionCalls;		// calls of user defined functions
+		/*public*/ size_t FunctionScopes;		// scopes created for calls of user defined functions (compiled calls create the scope only if needed)
+		/*public*/ size_t ObjectAllocations;	// all created objects
+		/*public*/ size_t ObjectCopies;			// objects created by the copy constructor
+		/*public*/ size_t PayloadCopies;		// copies of shared list and dictionary payloads before modification
+		/*public*/ size_t MacroExpansions;		// expanded compile time macros and expanded run time macros (once for each call site of compiled code)
+		/*public*/ size_t LocalResolves;		// symbols resolved in the current scope
+		/*public*/ size_t GlobalResolves;		// symbols resolved in the global scope
+		/*public*/ size_t ClosureResolves;		// symbols resolved in the closure chain
+		/*public*/ size_t ModuleResolves;		// symbols resolved in the loaded modules
+		/*public*/ size_t UnresolvedSymbols;	// symbols not found in any scope
+		/*public*/ size_t ExceptionsThrown;		// created LispException objects
+		/*public*/ size_t CallSiteCacheHits;	// calls which used the function cached at the call site, see LispVirtualMachine
+		/*public*/ size_t CallSiteCacheMisses;	// calls of cacheable call sites which resolved the function
+		/*public*/ size_t ModuleCacheHits;		// imported modules with tokens read from the module cache, see LispModuleCache
+		/*public*/ size_t ModuleCacheMisses;	// imported modules without valid cache file
+		/*public*/ size_t SymbolTableLocks;		// symbols interned with the lock of the symbol table (new names), see LispSymbolTable
+
+		/*public*/ LispRuntimeStatistics & operator+=(const LispRuntimeStatistics & other);
+
+		/// <summary>
+		/// Returns the counters of the calling thread.
+		/// </summary>
+		/*public*/ static LispRuntimeStatistics GetCurrent();
+
+		/*public*/ static bool IsEnabled();
+
+		/// <summary>
+		/// Sets all counters of the calling thread to zero.
+		/// </summary>
+		/*public*/ static void Reset();
+
+		/// <summary>
+		/// Adds the given counters to the counters of the calling thread.
+		/// </summary>
+		/*public*/ static void Add(const LispRuntimeStatistics & statistics);
+	};
+
+	// the counters of the current thread, see COUNT_RUNTIME_STATISTIC
+	extern thread_local LispRuntimeStatistics LispRuntimeStatistics_Current FAST_THREAD_LOCAL;
+}
+
+#ifdef ENABLE_RUNTIME_STATISTICS
+#define COUNT_RUNTIME_STATISTIC(counter) (CppLisp::LispRuntimeStatistics_Current.counter++)
+#else
+#define COUNT_RUNTIME_STATISTIC(counter)
+#endif
+
+#endif
@@ -26,15 +26,18 @@
 #include "Scope.h"
 #include "Exception.h"
 #include "Interpreter.h"
+#include "Symbol.h"
 
 namespace CppLisp
 {
 	LispScope::LispScope(const string & fcnName, std::shared_ptr<LispScope> globalScope, std::shared_ptr<string> moduleName, std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp)
 	{
 		Debugger = null;
+		RemovedCount = 0;
 		IsInEval = false;
 		IsInReturn = false;
 		NeedsLValue = false;
+		Tracing = false;
 		Name = fcnName;
 		ModuleName = moduleName ? *moduleName : string::Empty;
 		//GlobalScope = globalScope != null ? globalScope : shared_from_this();
@@ -42,6 +45,10 @@ namespace CppLisp
 		{
 			GlobalScope = globalScope;
 		}
+		else
+		{
+			Runtime = std::make_shared<LispRuntime>();
+		}
 		if (ModuleName == string::Empty && globalScope != null)
 		{
 			ModuleName = globalScope->ModuleName;
@@ -78,7 +85,199 @@ namespace CppLisp
 		}
 	}
 
+	std::shared_ptr<object> & LispScope::operator[](const string & key)
+	{
+		auto item = find(key);
+		if (item != end())
+		{
+			return item->second;
+		}
+		// a new symbol in a local scope may hide a function of the global scope cached at a call site
+		// (the global scope is not set while the builtin functions are defined)
+		if (GlobalScope != null && GlobalScope.get() != this)
+		{
+			GlobalScope->Runtime->IncrementDefinitionEpoch();
+		}
+		return CreateCell(key);
+	}
+
+	std::shared_ptr<object> & LispScope::LocalCell(const string & key, size_t symbolId)
+	{
+		auto item = find(key);
+		if (item != end())
+		{
+			return item->second;
+		}
+		return CreateCell(key, symbolId);
+	}
+
+	std::shared_ptr<object> & LispScope::CreateCell(const string & key, size_t symbolId)
+	{
+		std::shared_ptr<object> & cell = HashDictionary<string, std::shared_ptr<object>>::operator[](key);
+		if (m_SymbolIndex.IsValid)
+		{
+			m_SymbolIndex.Cells[symbolId != LispSymbolTable::NoSymbol ? symbolId : LispSymbolTable::Intern(key)] = &cell;
+		}
+		return cell;
+	}
+
+	bool LispScope::Remove(const string & key)
+	{
+		RemovedCount++;
+		if (GlobalScope != null)
+		{
+			GlobalScope->Runtime->IncrementDefinitionEpoch();
+		}
+		if (m_SymbolIndex.IsValid)
+		{
+			m_SymbolIndex.Cells.Remove(LispSymbolTable::Find(key));
+		}
+		return HashDictionary<string, std::shared_ptr<object>>::Remove(key);
+	}
+
+	std::shared_ptr<LispScope> LispScope::Fork(std::shared_ptr<TextWriter> outp, std::shared_ptr<TextReader> inp) const
+	{
+		var scope = std::make_shared<LispScope>(Name, std::shared_ptr<LispScope>(), std::make_shared<string>(ModuleName), outp != null ? outp : Output, inp != null ? inp : Input);
+		scope->PrivateInitForCpp();
+		if (GlobalScope != null)
+		{
+			scope->Runtime->LibraryPath = GlobalScope->Runtime->LibraryPath;
+			scope->Runtime->UseModuleCache = GlobalScope->Runtime->UseModuleCache;
+			scope->Runtime->ModuleCachePath = GlobalScope->Runtime->ModuleCachePath;
+			scope->Runtime->ModuleRegistry = GlobalScope->Runtime->ModuleRegistry;
+		}
+		ForkSymbols(*scope, scope);
+		// the index refers to the cells of the forked modules
+		LispEnvironment::RebuildModuleIndex(scope);
+		return scope;
+	}
+
+	void LispScope::ForkSymbols(LispScope & target, std::shared_ptr<LispScope> globalScope) const
+	{
+		// copy the dictionary without hashing the keys again, then replace the values by their forks
+		static_cast<HashDictionary<string, std::shared_ptr<object>> &>(target) = *this;
+		for (var & item : target)
+		{
+			item.second = ForkValue(item.second, globalScope);
+		}
+		target.RebuildSymbolIndex();
+	}
+
+	std::shared_ptr<object> LispScope::ForkValue(std::shared_ptr<object> value, std::shared_ptr<LispScope> globalScope)
+	{
+		if (value == null)
+		{
+			return null;
+		}
+		if (value->IsLispScope())
+		{
+			// the meta scopes (modules, macros) and the scopes of the modules belong to the new global scope
+			const LispScope * scope = value->GetLispScopeRef();
+			LispScope copy(scope->Name, globalScope, std::make_shared<string>(scope->ModuleName), globalScope->Output, globalScope->Input);
+			scope->ForkSymbols(copy, globalScope);
+			return std::make_shared<object>(copy);
+		}
+		if (value->IsLispVariant())
+		{
+			// functions are never modified, a new definition replaces the value of the cell
+			const LispVariant & variant = value->ToLispVariantRef();
+			if (variant.IsFunction())
+			{
+				return value;
+			}
+			// a new value object, so modifications of the value in the fork are not visible in this scope
+			LispVariant copy(variant);
+			if (copy.Value != null)
+			{
+				copy.Value = std::make_shared<object>(*(copy.Value));
+			}
+			return std::make_shared<object>(copy);
+		}
+		return std::make_shared<object>(*value);
+	}
+
+	void LispScope::RebuildSymbolIndex()
+	{
+		m_SymbolIndex.Cells.Clear();
+		for (var & item : *this)
+		{
+			m_SymbolIndex.Cells[LispSymbolTable::Intern(item.first)] = &(item.second);
+		}
+		m_SymbolIndex.IsValid = true;
+	}
+
+	std::shared_ptr<object> * LispScope::FindCell(size_t symbolId)
+	{
+		if (!m_SymbolIndex.IsValid)
+		{
+			RebuildSymbolIndex();
+		}
+		std::shared_ptr<object> ** cell = m_SymbolIndex.Cells.FindValue(symbolId);
+		return cell != null ? *cell : null;
+	}
+
 	std::shared_ptr<object> LispScope::ResolveInScopes(std::shared_ptr<object> elem, bool isFirst)
+	{
+		// symbols are resolved with their interned id, the name is only needed if the symbol is not found
+		if (elem->IsLispVariant() && elem->ToLispVariantRef().IsSymbol())
+		{
+			std::shared_ptr<object> * cell = FindCellInScopes(elem->ToLispVariantRef().SymbolId());
+			if (cell != null)
+			{
+				return *cell;
+			}
+		}
+		return ResolveInScopes(elem, elem->ToString(), isFirst);
+	}
+
+	std::shared_ptr<object> * LispScope::FindCellInScopes(const string & name)
+	{
+		// names which were never interned are not available in any scope
+		size_t symbolId = LispSymbolTable::Find(name);
+		return symbolId != LispSymbolTable::NoSymbol ? FindCellInScopes(symbolId) : null;
+	}
+
+	std::shared_ptr<object> * LispScope::FindCellInScopes(size_t symbolId, /*out*/ LispScope ** closureScope)
+	{
+		if (closureScope != null)
+		{
+			*closureScope = null;
+		}
+		// first try to resolve in this scope
+		std::shared_ptr<object> * cell = FindCell(symbolId);
+		if (cell != null)
+		{
+			COUNT_RUNTIME_STATISTIC(LocalResolves);
+			return cell;
+		}
+		// then try to resolve in global scope
+		if (GlobalScope != null)
+		{
+			cell = GlobalScope->FindCell(symbolId);
+			if (cell != null)
+			{
+				COUNT_RUNTIME_STATISTIC(GlobalResolves);
+				return cell;
+			}
+		}
+		// then try to resolve in closure chain scope(s)
+		for (LispScope * closure = ClosureChain.get(); closure != null; closure = closure->ClosureChain.get())
+		{
+			cell = closure->FindCell(symbolId);
+			if (cell != null)
+			{
+				COUNT_RUNTIME_STATISTIC(ClosureResolves);
+				if (closureScope != null)
+				{
+					*closureScope = closure;
+				}
+				return cell;
+			}
+		}
+		return null;
+	}
+
+	std::shared_ptr<object> LispScope::ResolveInScopes(std::shared_ptr<object> elem, const string & name, bool isFirst)
 	{
 		std::shared_ptr<object> result;
 
@@ -92,37 +291,23 @@ namespace CppLisp
 		//	}
 		//}
 
-		var name = elem->ToString();
-		std::shared_ptr<LispScope> foundClosureScope;
-		std::shared_ptr<object> value;
-		// first try to resolve in this scope
-		auto item = find(name);
-		if (item != end())
-		{
-			result = item->second;
-//			UpdateFunctionCache(elem->ToLispVariantNotConstRef(), result, isFirst);
-		}
-		// then try to resolve in global scope
-		else if (GlobalScope != null && GlobalScope->ContainsKey(name, &value))
+		// try to resolve in this scope, global scope and closure chain scope(s),
+		// symbols are resolved with their interned id
+		size_t symbolId = elem->IsLispVariant() && elem->ToLispVariantRef().IsSymbol() ? elem->ToLispVariantRef().SymbolId() : LispSymbolTable::Find(name);
+		std::shared_ptr<object> * cell = symbolId != LispSymbolTable::NoSymbol ? FindCellInScopes(symbolId) : null;
+		if (cell != null)
 		{
-			//result = (*GlobalScope)[name];
-			result = value;
-//			UpdateFunctionCache(elem->ToLispVariantNotConstRef(), result, isFirst);
-		}
-		// then try to resolve in closure chain scope(s)
-		else if (IsInClosureChain(name, foundClosureScope, &value))
-		{
-			//result = (*foundClosureScope)[name];
-			result = value;
+			result = *cell;
 //			UpdateFunctionCache(elem->ToLispVariantNotConstRef(), result, isFirst);
 		}
 		// then try to resolve in scope of loaded modules
-		else if (LispEnvironment::IsInModules(name, GlobalScope))
+		else if (symbolId != LispSymbolTable::NoSymbol && LispEnvironment::FindFunctionInModules(symbolId, GlobalScope, result))
 		{
-			result = LispEnvironment::GetFunctionInModules(name, GlobalScope);
+			COUNT_RUNTIME_STATISTIC(ModuleResolves);
 		}
 		else
 		{
+			COUNT_RUNTIME_STATISTIC(UnresolvedSymbols);
 			// activate this code if symbols must be resolved in parameter evaluation --> (println blub)
 			//if (elem->IsLispVariant() && elem->ToLispVariantRef().IsSymbol() && name != "fuellib")
             //{
@@ -134,25 +319,30 @@ namespace CppLisp
 		return result;
 	}
 
-	void LispScope::SetInScopes(const string & symbolName, std::shared_ptr<object> value)
+	std::shared_ptr<object> * LispScope::FindCellToSet(size_t symbolId)
 	{
-		std::shared_ptr<LispScope> foundClosureScope;
-		if (!string::IsNullOrEmpty(symbolName) && ContainsKey(symbolName))
+		// search in this scope, then in the closure chain and then in the global scope
+		std::shared_ptr<object> * cell = FindCell(symbolId);
+		for (LispScope * closure = ClosureChain.get(); cell == null && closure != null; closure = closure->ClosureChain.get())
 		{
-			(*this)[symbolName] = value;
+			cell = closure->FindCell(symbolId);
 		}
-		else if (!string::IsNullOrEmpty(symbolName) && IsInClosureChain(symbolName, foundClosureScope))
+		if (cell == null && GlobalScope != null)
 		{
-			(*foundClosureScope)[symbolName] = value;
+			cell = GlobalScope->FindCell(symbolId);
 		}
-		else if (!string::IsNullOrEmpty(symbolName) && GlobalScope != null && GlobalScope->ContainsKey(symbolName))
-		{
-			(*GlobalScope)[symbolName] = value;
-		}
-		else
+		return cell;
+	}
+
+	void LispScope::SetInScopes(const string & symbolName, std::shared_ptr<object> value)
+	{
+		size_t symbolId = !string::IsNullOrEmpty(symbolName) ? LispSymbolTable::Find(symbolName) : LispSymbolTable::NoSymbol;
+		std::shared_ptr<object> * cell = symbolId != LispSymbolTable::NoSymbol ? FindCellToSet(symbolId) : null;
+		if (cell == null)
 		{
 			throw LispException("Symbol " + symbolName + " not found", this);
 		}
+		*cell = value;
 	}
 
 	std::shared_ptr<LispToken> LispScope::GetPreviousToken(std::shared_ptr<LispToken> token)
@@ -277,9 +467,11 @@ namespace CppLisp
 			var items = (*this)[metaScope]; // as LispScope;
 			if (items->IsLispScope())
 			{
-				for (/*KeyValuePair<string, std::shared_ptr<object>>*/auto const & item : *(items->GetLispScopeRef()))
+				var scope = items->GetLispScopeRef();
+				// process the items in the sorted order of their names
+				for (const string & key : scope->GetKeys())
 				{
-					KeyValuePair<string, std::shared_ptr<object>> temp(item.first, item.second);
+					KeyValuePair<string, std::shared_ptr<object>> temp(key, scope->find(key)->second);
 					action(temp);
 				}
 			}
@@ -38,6 +38,8 @@
 #include "Variant.h"
 #include "Environment.h"
 #include "DebuggerInterface.h"
+#include "Runtime.h"
+#include "Symbol.h"
 
 #include <algorithm>
 #include <memory>
@@ -48,13 +50,39 @@ namespace CppLisp
     /// <summary>
     /// The lisp runtime scope. That is something like a stack item.
     /// </summary>
-    /*public*/ class DLLEXPORT LispScope : public Dictionary<string, std::shared_ptr<object>>, public std::enable_shared_from_this<LispScope>
+    /*public*/ class DLLEXPORT LispScope : public HashDictionary<string, std::shared_ptr<object>>, public std::enable_shared_from_this<LispScope>
     {
 	private:
 
 		// disable assignment operator
 		LispScope & operator=(const LispScope & other);
 
+		/// <summary>
+		/// Index of the value cells of this scope by the interned symbol id.
+		/// A copied index is invalid, because its cells belong to the source scope,
+		/// it is rebuilt on first use.
+		/// </summary>
+		struct SymbolIndex
+		{
+			HashDictionary<size_t, std::shared_ptr<object> *> Cells;
+			bool IsValid;
+
+			SymbolIndex()
+				: IsValid(true)
+			{
+			}
+
+			SymbolIndex(const SymbolIndex & /*other*/)
+				: IsValid(false)
+			{
+			}
+
+		private:
+			SymbolIndex & operator=(const SymbolIndex & other);
+		};
+
+		SymbolIndex m_SymbolIndex;
+
 	public:
         //#region debugging support
 
@@ -143,6 +171,22 @@ namespace CppLisp
 
         //#endregion
 
+        //#region lexical addressing support
+
+        /// <summary>
+        /// Gets the number of symbols removed from this scope.
+        /// Used to invalidate the value cells cached by the <see cref="LispVirtualMachine"/>.
+        /// </summary>
+		/*public*/ size_t RemovedCount; // { get; private set; }
+
+        /// <summary>
+        /// Gets the runtime of the global scope, see <see cref="LispRuntime"/>.
+        /// Only set for global scopes (scopes created without global scope), use GlobalScope->Runtime.
+        /// </summary>
+		/*public*/ std::shared_ptr<LispRuntime> Runtime; // { get; private set; }
+
+        //#endregion
+
         //#region properties
 
         /// <summary>
@@ -206,6 +250,66 @@ namespace CppLisp
             Next = null;
         }
 
+        /// <summary>
+        /// Creates a new global scope with copies of all symbols of this global scope:
+        /// builtin functions, global variables, imported modules and macros.
+        /// Prepare a global scope once (i. e. import modules) and fork it for every 
+        /// request, so the request does not create the builtin functions and does 
+        /// not load the modules again. The fork has its own runtime and does not change 
+        /// this scope, the payloads of strings, lists and dictionaries are shared copy 
+        /// on write and the functions are shared. This scope may be forked by different 
+        /// threads in parallel, but must not be modified while it is forked.
+        /// </summary>
+        /// <param name="outp">The output stream of the new scope, the output of this scope if null.</param>
+        /// <param name="inp">The input stream of the new scope, the input of this scope if null.</param>
+        /// <returns>The new global scope</returns>
+		/*public*/ std::shared_ptr<LispScope> Fork(std::shared_ptr<TextWriter> outp = null, std::shared_ptr<TextReader> inp = null) const;
+
+        /// <summary>
+        /// Returns the value cell for the given name, the cell is created if needed.
+        /// Hides the map operator to keep the symbol index and the definition epoch up to date.
+        /// </summary>
+        /// <param name="key">The name.</param>
+        /// <returns>Reference to the value cell</returns>
+		/*public*/ std::shared_ptr<object> & operator[](const string & key);
+
+        /// <summary>
+        /// Returns the value cell for a local variable (formal argument or def) 
+        /// of a compiled function body, the cell is created if needed.
+        /// Local variables are never cached at call sites ==> the definition epoch is not changed.
+        /// </summary>
+        /// <param name="key">The name of the local variable.</param>
+        /// <param name="symbolId">The interned id of the name, avoids interning the name again for a new cell.</param>
+        /// <returns>Reference to the value cell</returns>
+		/*public*/ std::shared_ptr<object> & LocalCell(const string & key, size_t symbolId = LispSymbolTable::NoSymbol);
+
+        /*public*/ bool Remove(const string & key);
+
+        /// <summary>
+        /// Searches the value cell of the given symbol in this scope only.
+        /// </summary>
+        /// <param name="symbolId">The interned id of the symbol.</param>
+        /// <returns>Pointer to the value cell or null</returns>
+		/*public*/ std::shared_ptr<object> * FindCell(size_t symbolId);
+
+        /// <summary>
+        /// Searches the value cell of the given name in this scope, the global scope 
+        /// and the closure chain (in the same order as <see cref="ResolveInScopes"/>).
+        /// The cell is valid as long as the name is not removed from its scope.
+        /// </summary>
+        /// <param name="name">The name of the element.</param>
+        /// <returns>Pointer to the value cell or null</returns>
+		/*public*/ std::shared_ptr<object> * FindCellInScopes(const string & name);
+
+        /// <summary>
+        /// Searches the value cell of the given symbol in this scope, the global scope 
+        /// and the closure chain by comparing the interned symbol ids.
+        /// </summary>
+        /// <param name="symbolId">The interned id of the symbol.</param>
+        /// <param name="closureScope">Output: the scope of the closure chain with the cell, null if the cell is not in the closure chain.</param>
+        /// <returns>Pointer to the value cell or null</returns>
+		/*public*/ std::shared_ptr<object> * FindCellInScopes(size_t symbolId, /*out*/ LispScope ** closureScope = null);
+
         /// <summary>
         /// Resolves the given element in this scope.
         /// </summary>
@@ -214,6 +318,23 @@ namespace CppLisp
 		/// <returns>Resolved value or null</returns>
 		/*public*/ std::shared_ptr<object> ResolveInScopes(std::shared_ptr<object> elem, bool isFirst);
 
+        /// <summary>
+        /// Resolves the given element with the already known name in this scope.
+        /// </summary>
+        /// <param name="elem">The element.</param>
+        /// <param name="name">The name of the element.</param>
+		/// <param name="isFirst">Is the element the first one in the list.</param>
+		/// <returns>Resolved value or null</returns>
+		/*public*/ std::shared_ptr<object> ResolveInScopes(std::shared_ptr<object> elem, const string & name, bool isFirst);
+
+        /// <summary>
+        /// Searches the value cell of the given symbol in this scope, the closure chain 
+        /// and the global scope (in the same order as <see cref="SetInScopes"/>).
+        /// </summary>
+        /// <param name="symbolId">The interned id of the symbol.</param>
+        /// <returns>Pointer to the value cell or null</returns>
+		/*public*/ std::shared_ptr<object> * FindCellToSet(size_t symbolId);
+
         /// <summary>
         /// Searches the given symbol in the scope environment and 
         /// sets the value if found.
@@ -285,6 +406,11 @@ namespace CppLisp
 		/// <returns>True if name was found.</returns>
 		/*private*/ bool IsInClosureChain(const string & name, /*out*/ std::shared_ptr<LispScope> & closureScopeFound, std::shared_ptr<object> * pValue = 0);
 
+		/*private*/ void RebuildSymbolIndex();
+		/*private*/ void ForkSymbols(LispScope & target, std::shared_ptr<LispScope> globalScope) const;
+		/*private*/ static std::shared_ptr<object> ForkValue(std::shared_ptr<object> value, std::shared_ptr<LispScope> globalScope);
+		/*private*/ std::shared_ptr<object> & CreateCell(const string & key, size_t symbolId = LispSymbolTable::NoSymbol);
+
 		/*private*/ void ProcessMetaScope(const string & metaScope, /*Action<KeyValuePair<string, std::shared_ptr<object>>>*/std::function<void(KeyValuePair<string, std::shared_ptr<object>>)> action);
 
 		/*private*/ void Dump(std::function<bool(const LispVariant &)>/*Func<LispVariant, bool>*/ select, std::function<string(const LispVariant &)>/*Func<LispVariant, string>*/ show = null, bool showHelp = false, bool sort = false, std::function<string(const LispVariant &)>/*Func<LispVariant, string>*/ format = null);
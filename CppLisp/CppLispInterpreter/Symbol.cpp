@@ -0,0 +1,213 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+#include "Symbol.h"
+#include "RuntimeStatistics.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace CppLisp
+{
+	struct LispSymbolEntry
+	{
+		string Name;
+		std::shared_ptr<object> Value;
+	};
+
+	// the entries are stored in blocks which are never moved or released,
+	// so returned names stay valid and readers need no lock
+	const size_t EntryBlockBits = 12;
+	const size_t EntryBlockSize = (size_t)1 << EntryBlockBits;
+
+	/// <summary>
+	/// Open addressing hash table from names to symbol ids, the slots contain id + 1 (0 is an empty slot).
+	/// A slot is written only once, a full table is replaced by a larger table.
+	/// </summary>
+	struct LispSymbolIdTable
+	{
+		size_t Mask;
+		std::unique_ptr<std::atomic<size_t>[]> Slots;
+
+		explicit LispSymbolIdTable(size_t capacity)
+			: Mask(capacity - 1), Slots(new std::atomic<size_t>[capacity])
+		{
+			for (size_t i = 0; i < capacity; i++)
+			{
+				Slots[i].store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	/// <summary>
+	/// The data of the symbol table: Find, GetName and GetValue are lock free,
+	/// only the interning of a new name takes the lock. Replaced hash tables and
+	/// block directories are kept until the end of the process, because a reader
+	/// may still use them (their size is bounded by the size of the current ones).
+	/// </summary>
+	struct LispSymbolTableData
+	{
+		std::mutex Lock;
+		std::atomic<size_t> Count;
+		std::atomic<LispSymbolEntry **> Blocks;
+		std::atomic<LispSymbolIdTable *> Ids;
+		size_t BlockCapacity;
+		std::vector<std::unique_ptr<LispSymbolEntry[]>> OwnedBlocks;
+		std::vector<std::unique_ptr<LispSymbolEntry *[]>> OwnedDirectories;
+		std::vector<std::unique_ptr<LispSymbolIdTable>> OwnedIdTables;
+
+		LispSymbolTableData()
+			: Count(0), Blocks(null), Ids(null), BlockCapacity(0)
+		{
+			OwnedIdTables.push_back(std::unique_ptr<LispSymbolIdTable>(new LispSymbolIdTable(4096)));
+			Ids.store(OwnedIdTables.back().get(), std::memory_order_release);
+		}
+
+		inline LispSymbolEntry & GetEntry(size_t symbolId) const
+		{
+			return Blocks.load(std::memory_order_acquire)[symbolId >> EntryBlockBits][symbolId & (EntryBlockSize - 1)];
+		}
+
+		size_t FindId(const std::string & name, size_t hash) const
+		{
+			const LispSymbolIdTable * ids = Ids.load(std::memory_order_acquire);
+			for (size_t i = hash & ids->Mask; ; i = (i + 1) & ids->Mask)
+			{
+				size_t slot = ids->Slots[i].load(std::memory_order_acquire);
+				if (slot == 0)
+				{
+					return LispSymbolTable::NoSymbol;
+				}
+				if (GetEntry(slot - 1).Name == name)
+				{
+					return slot - 1;
+				}
+			}
+		}
+
+		// only called with the lock
+		void InsertId(LispSymbolIdTable & ids, size_t symbolId, size_t hash)
+		{
+			size_t i = hash & ids.Mask;
+			while (ids.Slots[i].load(std::memory_order_relaxed) != 0)
+			{
+				i = (i + 1) & ids.Mask;
+			}
+			ids.Slots[i].store(symbolId + 1, std::memory_order_release);
+		}
+
+		// only called with the lock
+		size_t Add(const string & name, size_t hash)
+		{
+			size_t symbolId = Count.load(std::memory_order_relaxed);
+			if ((symbolId >> EntryBlockBits) == BlockCapacity)
+			{
+				// the directory of the blocks is full ==> publish a copy with twice the capacity
+				size_t capacity = BlockCapacity == 0 ? 16 : BlockCapacity * 2;
+				std::unique_ptr<LispSymbolEntry *[]> directory(new LispSymbolEntry *[capacity]());
+				for (size_t i = 0; i < BlockCapacity; i++)
+				{
+					directory[i] = OwnedBlocks[i].get();
+				}
+				OwnedDirectories.push_back(std::move(directory));
+				BlockCapacity = capacity;
+			}
+			LispSymbolEntry ** directory = OwnedDirectories.back().get();
+			if ((symbolId & (EntryBlockSize - 1)) == 0)
+			{
+				OwnedBlocks.push_back(std::unique_ptr<LispSymbolEntry[]>(new LispSymbolEntry[EntryBlockSize]));
+				directory[symbolId >> EntryBlockBits] = OwnedBlocks.back().get();
+			}
+			LispSymbolEntry & entry = directory[symbolId >> EntryBlockBits][symbolId & (EntryBlockSize - 1)];
+			entry.Name = name;
+			entry.Value = std::make_shared<object>(name);
+			Blocks.store(directory, std::memory_order_release);
+			Count.store(symbolId + 1, std::memory_order_release);
+
+			LispSymbolIdTable * ids = Ids.load(std::memory_order_relaxed);
+			if ((symbolId + 1) * 2 > ids->Mask + 1)
+			{
+				// keep the load factor below 1/2 ==> publish a larger table with all ids
+				OwnedIdTables.push_back(std::unique_ptr<LispSymbolIdTable>(new LispSymbolIdTable((ids->Mask + 1) * 2)));
+				LispSymbolIdTable * newIds = OwnedIdTables.back().get();
+				for (size_t id = 0; id < symbolId; id++)
+				{
+					InsertId(*newIds, id, std::hash<std::string>()(GetEntry(id).Name));
+				}
+				InsertId(*newIds, symbolId, hash);
+				Ids.store(newIds, std::memory_order_release);
+			}
+			else
+			{
+				InsertId(*ids, symbolId, hash);
+			}
+			return symbolId;
+		}
+	};
+
+	static LispSymbolTableData & GetTable()
+	{
+		// initialized on first use, symbols are already needed for static initialization
+		static LispSymbolTableData table;
+		return table;
+	}
+
+	size_t LispSymbolTable::Intern(const string & name)
+	{
+		LispSymbolTableData & table = GetTable();
+		size_t hash = std::hash<std::string>()(name);
+		size_t symbolId = table.FindId(name, hash);
+		if (symbolId != NoSymbol)
+		{
+			return symbolId;
+		}
+		COUNT_RUNTIME_STATISTIC(SymbolTableLocks);
+		std::lock_guard<std::mutex> guard(table.Lock);
+		// another thread may have added the name in the meantime
+		symbolId = table.FindId(name, hash);
+		return symbolId != NoSymbol ? symbolId : table.Add(name, hash);
+	}
+
+	size_t LispSymbolTable::Find(const string & name)
+	{
+		return GetTable().FindId(name, std::hash<std::string>()(name));
+	}
+
+	const string & LispSymbolTable::GetName(size_t symbolId)
+	{
+		return GetTable().GetEntry(symbolId).Name;
+	}
+
+	std::shared_ptr<object> LispSymbolTable::GetValue(size_t symbolId)
+	{
+		return GetTable().GetEntry(symbolId).Value;
+	}
+
+	size_t LispSymbolTable::Count()
+	{
+		return GetTable().Count.load(std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,85 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_SYMBOL_H
+#define _LISP_SYMBOL_H
+
+#include "cstypes.h"
+#include "csstring.h"
+#include "csobject.h"
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Global table of interned symbol names.
+	/// Every name gets an unique integer id, so symbols can be
+	/// compared and looked up in scopes by comparing integers.
+	/// Ids are never released and are valid for all scopes and threads.
+	/// Looking up an already interned name or id is lock free, only interning
+	/// a new name takes the lock of the table, so parallel runtimes do not
+	/// contend for the table while they run.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispSymbolTable
+	{
+	public:
+		/*public*/ const static size_t NoSymbol = (size_t)-1;
+
+		/// <summary>
+		/// Returns the id of the given name, the name is added to the table if needed.
+		/// </summary>
+		/// <param name="name">The name.</param>
+		/// <returns>The symbol id</returns>
+		/*public*/ static size_t Intern(const string & name);
+
+		/// <summary>
+		/// Returns the id of the given name without adding it to the table.
+		/// </summary>
+		/// <param name="name">The name.</param>
+		/// <returns>The symbol id or NoSymbol if the name was never interned</returns>
+		/*public*/ static size_t Find(const string & name);
+
+		/// <summary>
+		/// Returns the name of the symbol with the given id.
+		/// </summary>
+		/// <param name="symbolId">The symbol id.</param>
+		/// <returns>The name</returns>
+		/*public*/ static const string & GetName(size_t symbolId);
+
+		/// <summary>
+		/// Returns the shared string value of the symbol with the given id,
+		/// all tokens of a symbol share this value.
+		/// </summary>
+		/// <param name="symbolId">The symbol id.</param>
+		/// <returns>The string value</returns>
+		/*public*/ static std::shared_ptr<object> GetValue(size_t symbolId);
+
+		/// <summary>
+		/// Returns the number of interned symbols.
+		/// </summary>
+		/*public*/ static size_t Count();
+	};
+}
+
+#endif
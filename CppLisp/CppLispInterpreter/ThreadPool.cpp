@@ -0,0 +1,236 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CppLisp
+{
+	struct LispParallelBatch
+	{
+		const std::function<void(size_t)> * Task;
+		std::atomic<size_t> Remaining;
+		std::atomic<bool> Failed;
+		std::mutex ErrorLock;
+		std::exception_ptr Error;
+	};
+
+	struct LispParallelJob
+	{
+		LispParallelBatch * Batch;
+		size_t Index;
+	};
+
+	struct LispJobQueue
+	{
+		std::mutex Lock;
+		std::deque<LispParallelJob> Jobs;
+	};
+
+	struct LispThreadPoolData
+	{
+		// one queue per worker thread and one for the threads outside of the pool
+		std::vector<std::unique_ptr<LispJobQueue>> Queues;
+		std::vector<std::thread> Workers;
+		std::atomic<size_t> QueuedJobs;
+		std::mutex WakeLock;
+		std::condition_variable WakeSignal;
+
+		LispThreadPoolData()
+			: QueuedJobs(0)
+		{
+		}
+	};
+
+	const static size_t NoQueue = (size_t)-1;
+
+	// the queue of the current thread, only worker threads of the pool have an own queue
+	static thread_local size_t t_QueueNo = NoQueue;
+
+	static void WorkerLoop(LispThreadPoolData & pool, size_t queueNo);
+
+	static LispThreadPoolData & GetPool()
+	{
+		// created on first use and never destroyed, the workers wait for jobs until the process ends
+		static LispThreadPoolData * pool = null;
+		static std::once_flag created;
+		std::call_once(created, []()
+		{
+			// without parallel hardware no threads are started, the calling thread runs all jobs
+			size_t hardwareThreads = std::thread::hardware_concurrency();
+			size_t workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+			pool = new LispThreadPoolData();
+			for (size_t i = 0; i <= workerCount; i++)
+			{
+				pool->Queues.push_back(std::unique_ptr<LispJobQueue>(new LispJobQueue()));
+			}
+			for (size_t i = 0; i < workerCount; i++)
+			{
+				pool->Workers.push_back(std::thread(WorkerLoop, std::ref(*pool), i));
+				pool->Workers.back().detach();
+			}
+		});
+		return *pool;
+	}
+
+	static void RunJob(LispThreadPoolData & pool, const LispParallelJob & job)
+	{
+		LispParallelBatch * batch = job.Batch;
+		try
+		{
+			// the remaining jobs of a failed batch are skipped
+			if (!batch->Failed)
+			{
+				(*batch->Task)(job.Index);
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> guard(batch->ErrorLock);
+			if (!batch->Error)
+			{
+				batch->Error = std::current_exception();
+			}
+			batch->Failed = true;
+		}
+		if (--batch->Remaining == 0)
+		{
+			// wake up the thread waiting for the batch
+			std::lock_guard<std::mutex> guard(pool.WakeLock);
+			pool.WakeSignal.notify_all();
+		}
+	}
+
+	static bool TryRunJob(LispThreadPoolData & pool, size_t queueNo)
+	{
+		LispParallelJob job;
+		bool found = false;
+		size_t queueCount = pool.Queues.size();
+		// the last job of the own queue first, then steal the first job of the other queues
+		for (size_t i = 0; i < queueCount && !found; i++)
+		{
+			LispJobQueue & queue = *(pool.Queues[(queueNo + i) % queueCount]);
+			std::lock_guard<std::mutex> guard(queue.Lock);
+			if (!queue.Jobs.empty())
+			{
+				if (i == 0)
+				{
+					job = queue.Jobs.back();
+					queue.Jobs.pop_back();
+				}
+				else
+				{
+					job = queue.Jobs.front();
+					queue.Jobs.pop_front();
+				}
+				found = true;
+			}
+		}
+		if (found)
+		{
+			pool.QueuedJobs--;
+			RunJob(pool, job);
+		}
+		return found;
+	}
+
+	static void WorkerLoop(LispThreadPoolData & pool, size_t queueNo)
+	{
+		t_QueueNo = queueNo;
+		while (true)
+		{
+			if (!TryRunJob(pool, queueNo))
+			{
+				std::unique_lock<std::mutex> lock(pool.WakeLock);
+				pool.WakeSignal.wait(lock, [&pool]() { return pool.QueuedJobs > 0; });
+			}
+		}
+	}
+
+	size_t LispThreadPool::GetThreadCount()
+	{
+		return GetPool().Workers.size() + 1;
+	}
+
+	void LispThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> & task)
+	{
+		if (count <= 1 || GetThreadCount() == 1)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				task(i);
+			}
+			return;
+		}
+
+		LispThreadPoolData & pool = GetPool();
+		LispParallelBatch batch;
+		batch.Task = &task;
+		batch.Remaining = count;
+		batch.Failed = false;
+
+		// a worker thread puts the jobs in its own queue, the other workers steal them,
+		// all other threads distribute the jobs to the queues of the workers
+		size_t queueNo = t_QueueNo != NoQueue ? t_QueueNo : pool.Workers.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t targetQueueNo = t_QueueNo != NoQueue ? t_QueueNo : i % pool.Queues.size();
+			LispJobQueue & queue = *(pool.Queues[targetQueueNo]);
+			std::lock_guard<std::mutex> guard(queue.Lock);
+			LispParallelJob job;
+			job.Batch = &batch;
+			job.Index = i;
+			queue.Jobs.push_back(job);
+		}
+		{
+			std::lock_guard<std::mutex> guard(pool.WakeLock);
+			pool.QueuedJobs += count;
+			pool.WakeSignal.notify_all();
+		}
+
+		// work until all jobs of the batch are finished
+		while (batch.Remaining > 0)
+		{
+			if (!TryRunJob(pool, queueNo))
+			{
+				std::unique_lock<std::mutex> lock(pool.WakeLock);
+				pool.WakeSignal.wait(lock, [&]() { return batch.Remaining == 0 || pool.QueuedJobs > 0; });
+			}
+		}
+
+		if (batch.Error)
+		{
+			std::rethrow_exception(batch.Error);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_THREADPOOL_H
+#define _LISP_THREADPOOL_H
+
+#include "cstypes.h"
+
+#include <functional>
+
+namespace CppLisp
+{
+	/// <summary>
+	/// Work stealing thread pool for the parallel builtins (pmap, preduce).
+	/// The pool is created at the first use with one thread less than the
+	/// hardware supports, because the calling thread works too, so no
+	/// thread is started on a machine with one core.
+	/// Every thread has its own queue of jobs, a thread takes the last job 
+	/// of its own queue and steals the first job of the other queues if its
+	/// queue is empty. A thread waiting for its jobs runs other jobs in the
+	/// meantime, so nested parallel calls do not block the pool.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispThreadPool
+	{
+	public:
+		/// <summary>
+		/// Returns the number of threads which run jobs, including the calling thread.
+		/// </summary>
+		/*public*/ static size_t GetThreadCount();
+
+		/// <summary>
+		/// Runs task(0) ... task(count - 1) in parallel and returns if all tasks are finished.
+		/// If a task throws an exception, the tasks which are not started yet are skipped
+		/// and the first exception is rethrown after the running tasks are finished.
+		/// </summary>
+		/// <param name="count">The number of tasks.</param>
+		/// <param name="task">The task, called with the number of the task.</param>
+		/*public*/ static void ParallelFor(size_t count, const std::function<void(size_t)> & task);
+	};
+}
+
+#endif
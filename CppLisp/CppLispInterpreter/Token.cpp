@@ -24,6 +24,9 @@
 * */
 
 #include "Token.h"
+#include "Symbol.h"
+#include <climits>
+#include <cstdlib>
 #include <string>
 
 const CppLisp::string CppLisp::LispToken::StringStart = "\"";
@@ -39,38 +42,48 @@ namespace CppLisp
 {
 	bool Int32_TryParse(const string & txt, size_t & outValue)
 	{
-		try
+		// same syntax as std::stoi(), but without exceptions for the many texts which are no numbers
+		size_t i = 0;
+		while (i < txt.length() && Char_IsWhiteSpace(txt[i]))
 		{
-			size_t errPos;
-			outValue = std::stoi(std::string(txt), &errPos, 10);
-			if (errPos < txt.length())
-			{
-				return false;
-			}
-			return true;
+			i++;
+		}
+		bool isNegative = i < txt.length() && txt[i] == '-';
+		if (i < txt.length() && (txt[i] == '-' || txt[i] == '+'))
+		{
+			i++;
 		}
-		catch (const std::invalid_argument &)
+		if (i == txt.length())
 		{
 			return false;
 		}
-	}
-
-	bool Double_TryParse(const string & txt, const string & /*NumberStyles_Any*/, const string & /*CultureInfo_InvariantCulture*/, double & doubleValue)
-	{
-		try
+		long long value = 0;
+		for (; i < txt.length(); i++)
 		{
-			size_t errPos;
-			doubleValue = std::stod(txt, &errPos);
-			if (errPos < txt.length())
+			if (txt[i] < '0' || txt[i] > '9')
+			{
+				return false;
+			}
+			value = value * 10 + (txt[i] - '0');
+			if (value > (long long)INT_MAX + 1)
 			{
 				return false;
 			}
-			return true;
 		}
-		catch (const std::invalid_argument &)
+		if (value > (long long)INT_MAX && !isNegative)
 		{
 			return false;
 		}
+		outValue = (size_t)(int)(isNegative ? -value : value);
+		return true;
+	}
+
+	bool Double_TryParse(const string & txt, const string & /*NumberStyles_Any*/, const string & /*CultureInfo_InvariantCulture*/, double & doubleValue)
+	{
+		// same syntax as std::stod(), values out of range are converted to inf or zero
+		char * end;
+		doubleValue = strtod(txt.c_str(), &end);
+		return end != txt.c_str() && end == txt.c_str() + txt.length();
 	}
 
 	LispToken::LispToken(const string & text, size_t start, size_t stop, size_t lineNo)
@@ -81,72 +94,105 @@ namespace CppLisp
 		StartPos = start;
 		StopPos = stop;
 		LineNo = lineNo;
-		Value = std::make_shared<object>(text);
+		SymbolId = LispSymbolTable::NoSymbol;
+		Type = GetTokenType(text);
 
-		if (text.StartsWith(StringStart))
+		switch (Type)
 		{
-			Type = /*LispTokenType::*/String;
+		case /*LispTokenType::*/String:
 			Value = std::make_shared<object>(text.Substring(1, text.Length() - 2));
+			break;
+		case /*LispTokenType::*/Int:
+			Int32_TryParse(text, /*out*/ intValue);
+			Value = std::make_shared<object>((int)intValue);
+			break;
+		case /*LispTokenType::*/Double:
+			Double_TryParse(text, "NumberStyles.Any", "CultureInfo.InvariantCulture", /*out*/ doubleValue);
+			Value = std::make_shared<object>(doubleValue);
+			break;
+		case /*LispTokenType::*/True:
+			Value = std::make_shared<object>(true);
+			break;
+		case /*LispTokenType::*/False:
+			Value = std::make_shared<object>(false);
+			break;
+		case /*LispTokenType::*/Nil:
+			Value = std::make_shared<object>(null);
+			break;
+		case /*LispTokenType::*/Symbol:
+			// all tokens of a symbol share the interned name
+			SymbolId = LispSymbolTable::Intern(text);
+			Value = LispSymbolTable::GetValue(SymbolId);
+			break;
+		default:
+			Value = std::make_shared<object>(text);
+			break;
 		}
-		else if (text == QuoteConst)
+	}
+
+	LispToken::LispToken(LispTokenType type, std::shared_ptr<object> value, size_t symbolId, size_t start, size_t stop, size_t lineNo)
+		: Type(type), Value(value), StartPos(start), StopPos(stop), LineNo(lineNo), SymbolId(symbolId)
+	{
+	}
+
+	LispTokenType LispToken::GetTokenType(const string & text)
+	{
+		size_t intValue;
+		double doubleValue;
+
+		if (text.StartsWith(StringStart))
 		{
-			Type = /*LispTokenType::*/Quote;
+			return /*LispTokenType::*/String;
 		}
-		else if (text == Quasiquote)
+		if (text == QuoteConst)
 		{
-			Type = /*LispTokenType::*/QuasiQuote;
+			return /*LispTokenType::*/Quote;
 		}
-		else if (text == Unquote)
+		if (text == Quasiquote)
 		{
-			Type = /*LispTokenType::*/UnQuote;
+			return /*LispTokenType::*/QuasiQuote;
 		}
-		else if (text == Unquotesplicing)
+		if (text == Unquote)
 		{
-			Type = /*LispTokenType::*/UnQuoteSplicing;
+			return /*LispTokenType::*/UnQuote;
 		}
-		else if (text == "(")
+		if (text == Unquotesplicing)
 		{
-			Type = /*LispTokenType::*/ListStart;
+			return /*LispTokenType::*/UnQuoteSplicing;
 		}
-		else if (text == ")")
+		if (text == "(")
 		{
-			Type = /*LispTokenType::*/ListEnd;
+			return /*LispTokenType::*/ListStart;
 		}
-		else if (Int32_TryParse(text, /*out*/ intValue))
+		if (text == ")")
 		{
-			Type = /*LispTokenType::*/Int;
-			Value = std::make_shared<object>((int)intValue);
+			return /*LispTokenType::*/ListEnd;
 		}
-		else if (Double_TryParse(text, "NumberStyles.Any", "CultureInfo.InvariantCulture", /*out*/ doubleValue))
+		if (Int32_TryParse(text, /*out*/ intValue))
 		{
-			Type = /*LispTokenType::*/Double;
-			Value = std::make_shared<object>(doubleValue);
+			return /*LispTokenType::*/Int;
 		}
-		else if (text.Equals("true") || text.Equals("#t"))
+		if (Double_TryParse(text, "NumberStyles.Any", "CultureInfo.InvariantCulture", /*out*/ doubleValue))
 		{
-			Type = /*LispTokenType::*/True;
-			Value = std::make_shared<object>(true);
+			return /*LispTokenType::*/Double;
 		}
-		else if (text.Equals("false") || text.Equals("#f"))
+		if (text.Equals("true") || text.Equals("#t"))
 		{
-			Type = /*LispTokenType::*/False;
-			Value = std::make_shared<object>(false);
+			return /*LispTokenType::*/True;
 		}
-		else if (text.ToUpper().Equals(NilConst))
+		if (text.Equals("false") || text.Equals("#f"))
 		{
-			Type = /*LispTokenType::*/Nil;
-			Value = std::make_shared<object>(null);
+			return /*LispTokenType::*/False;
 		}
-		else if (text.StartsWith(";"))
+		if (text.ToUpper().Equals(NilConst))
 		{
-			Type = /*LispTokenType::*/Comment;
-			Value = std::make_shared<object>(text);
+			return /*LispTokenType::*/Nil;
 		}
-		else
+		if (text.StartsWith(";"))
 		{
-			Type = /*LispTokenType::*/Symbol;
-			Value = std::make_shared<object>(text);
+			return /*LispTokenType::*/Comment;
 		}
+		return /*LispTokenType::*/Symbol;
 	}
 
 	bool LispToken::operator ==(const LispToken & other) const
@@ -124,6 +124,14 @@ namespace CppLisp
 		/// </value>
 		/*public*/ size_t LineNo; // { get; set; }
 
+		/// <summary>
+		/// Gets the interned id of a symbol token.
+		/// </summary>
+		/// <value>
+		/// The symbol id or LispSymbolTable::NoSymbol for other tokens.
+		/// </value>
+		/*public*/ size_t SymbolId; // { get; private set; }
+
 		//#endregion
 
 		//#region constructor
@@ -137,12 +145,31 @@ namespace CppLisp
 		/// <param name="lineNo">The line no.</param>
 		/*public*/ LispToken(const string & text, size_t start, size_t stop, size_t lineNo);
 
+		/// <summary>
+		/// Initializes a new instance of the <see cref="LispToken"/> class with an already converted value,
+		/// used for the tokens read from the <see cref="LispModuleCache"/>.
+		/// </summary>
+		/// <param name="type">The type of the token.</param>
+		/// <param name="value">The value of the token.</param>
+		/// <param name="symbolId">The interned id of a symbol token or LispSymbolTable::NoSymbol.</param>
+		/// <param name="start">The start position.</param>
+		/// <param name="stop">The stop position.</param>
+		/// <param name="lineNo">The line no.</param>
+		/*public*/ LispToken(LispTokenType type, std::shared_ptr<object> value, size_t symbolId, size_t start, size_t stop, size_t lineNo);
+
 		//#endregion
 
 		bool operator ==(const LispToken & other) const;
 
 		//#region public methods
 
+		/// <summary>
+		/// Returns the type of a token with the given text.
+		/// </summary>
+		/// <param name="text">The text of the token.</param>
+		/// <returns>The token type</returns>
+		/*public*/ static LispTokenType GetTokenType(const string & text);
+
 		/// <summary>
 		/// Returns a <see cref="System.String" /> that represents this instance.
 		/// </summary>
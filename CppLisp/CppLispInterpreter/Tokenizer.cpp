@@ -22,161 +22,588 @@
 * OTHER DEALINGS IN THE SOFTWARE.
 *
 * */
-
 #include "Tokenizer.h"
+#include "Symbol.h"
 #include "Exception.h"
 
+#include <cstring>
+
 namespace CppLisp
 {
-	IEnumerable<std::shared_ptr<LispToken>> LispTokenizer::Tokenize(const string & code, size_t offset)
+	/// <summary>
+	/// Classes of the characters, all characters without special meaning belong to symbols.
+	/// </summary>
+	enum LispCharClass
+	{
+		SymbolChar = 0,
+		WhiteSpaceChar = 1,
+		BackslashChar = 2,
+		ListChar = 3,
+		CommentChar = 4,
+		QuoteChar = 5,
+		StringChar = 6
+	};
+
+	struct LispCharClassTable
+	{
+		unsigned char Classes[256];
+
+		LispCharClassTable()
+		{
+			memset(Classes, SymbolChar, sizeof(Classes));
+			// the white space characters of isspace() in the C locale
+			for (char ch : { ' ', '\t', '\n', '\v', '\f', '\r' })
+			{
+				Classes[(unsigned char)ch] = WhiteSpaceChar;
+			}
+			Classes[(unsigned char)'\\'] = BackslashChar;
+			Classes[(unsigned char)'('] = ListChar;
+			Classes[(unsigned char)')'] = ListChar;
+			Classes[(unsigned char)';'] = CommentChar;
+			Classes[(unsigned char)'\''] = QuoteChar;
+			Classes[(unsigned char)'`'] = QuoteChar;
+			Classes[(unsigned char)','] = QuoteChar;
+			Classes[(unsigned char)'"'] = StringChar;
+		}
+	};
+
+	static const unsigned char * GetCharClasses()
+	{
+		static const LispCharClassTable table;
+		return table.Classes;
+	}
+
+	static bool IsText(const char * text, size_t length, const char * constText)
+	{
+		return length == strlen(constText) && memcmp(text, constText, length) == 0;
+	}
+
+	static bool IsTextIgnoreCase(const char * text, size_t length, const char * constText)
+	{
+		if (length != strlen(constText))
+		{
+			return false;
+		}
+		for (size_t i = 0; i < length; i++)
+		{
+			if (toupper((unsigned char)text[i]) != toupper((unsigned char)constText[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// numbers (including inf and nan) are converted by the token constructor
+	static bool MayBeNumber(const char * text, size_t length)
+	{
+		size_t i = text[0] == '+' || text[0] == '-' ? 1 : 0;
+		if (i == length)
+		{
+			return false;
+		}
+		if ((text[i] >= '0' && text[i] <= '9') || text[i] == '.')
+		{
+			return true;
+		}
+		return length - i >= 3 && (IsTextIgnoreCase(text + i, 3, "inf") || IsTextIgnoreCase(text + i, 3, "nan"));
+	}
+
+	static bool IsDigit(char ch)
+	{
+		return ch >= '0' && ch <= '9';
+	}
+
+	// detects the common numbers without calling the conversion functions
+	static bool IsSimpleNumber(const char * text, size_t length, /*out*/ LispTokenType & type)
+	{
+		size_t i = text[0] == '+' || text[0] == '-' ? 1 : 0;
+		size_t digits = 0;
+		while (i < length && IsDigit(text[i]))
+		{
+			i++;
+			digits++;
+		}
+		// larger numbers may not fit into an int
+		if (i == length && digits > 0 && digits < 10)
+		{
+			type = /*LispTokenType::*/Int;
+			return true;
+		}
+		if (i < length && text[i] == '.' && digits > 0)
+		{
+			i++;
+			while (i < length && IsDigit(text[i]))
+			{
+				i++;
+			}
+			if (i == length)
+			{
+				type = /*LispTokenType::*/Double;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static LispTokenType GetAtomType(const char * text, size_t length)
+	{
+		LispTokenType type;
+		// same order as in the token constructor, the other types can not occur in the text
+		if (MayBeNumber(text, length))
+		{
+			if (IsSimpleNumber(text, length, /*out*/ type))
+			{
+				return type;
+			}
+			string number(text, length);
+			size_t intValue;
+			double doubleValue;
+			if (Int32_TryParse(number, /*out*/ intValue))
+			{
+				return /*LispTokenType::*/Int;
+			}
+			if (Double_TryParse(number, "NumberStyles.Any", "CultureInfo.InvariantCulture", /*out*/ doubleValue))
+			{
+				return /*LispTokenType::*/Double;
+			}
+		}
+		if (IsText(text, length, "true") || IsText(text, length, "#t"))
+		{
+			return /*LispTokenType::*/True;
+		}
+		if (IsText(text, length, "false") || IsText(text, length, "#f"))
+		{
+			return /*LispTokenType::*/False;
+		}
+		if (IsTextIgnoreCase(text, length, "nil"))
+		{
+			return /*LispTokenType::*/Nil;
+		}
+		return /*LispTokenType::*/Symbol;
+	}
+
+	static std::shared_ptr<object> CreateValue(LispTokenType type, const char * text, size_t length, /*out*/ size_t & symbolId)
+	{
+		// the list and quote tokens share their values like the tokens of a symbol
+		static const std::shared_ptr<object> listStart = std::make_shared<object>("(");
+		static const std::shared_ptr<object> listEnd = std::make_shared<object>(")");
+		static const std::shared_ptr<object> quote = std::make_shared<object>(LispToken::QuoteConst);
+		static const std::shared_ptr<object> quasiQuote = std::make_shared<object>(LispToken::Quasiquote);
+		static const std::shared_ptr<object> unQuote = std::make_shared<object>(LispToken::Unquote);
+		static const std::shared_ptr<object> unQuoteSplicing = std::make_shared<object>(LispToken::Unquotesplicing);
+
+		symbolId = LispSymbolTable::NoSymbol;
+		switch (type)
+		{
+		case /*LispTokenType::*/ListStart:
+			return listStart;
+		case /*LispTokenType::*/ListEnd:
+			return listEnd;
+		case /*LispTokenType::*/Quote:
+			return quote;
+		case /*LispTokenType::*/QuasiQuote:
+			return quasiQuote;
+		case /*LispTokenType::*/UnQuote:
+			return unQuote;
+		case /*LispTokenType::*/UnQuoteSplicing:
+			return unQuoteSplicing;
+		case /*LispTokenType::*/Symbol:
+			symbolId = LispSymbolTable::Intern(string(text, length));
+			return LispSymbolTable::GetValue(symbolId);
+		case /*LispTokenType::*/Int:
+		{
+			size_t intValue = 0;
+			Int32_TryParse(string(text, length), /*out*/ intValue);
+			return std::make_shared<object>((int)intValue);
+		}
+		case /*LispTokenType::*/Double:
+		{
+			double doubleValue = 0.0;
+			Double_TryParse(string(text, length), "NumberStyles.Any", "CultureInfo.InvariantCulture", /*out*/ doubleValue);
+			return std::make_shared<object>(doubleValue);
+		}
+		case /*LispTokenType::*/True:
+			return std::make_shared<object>(true);
+		case /*LispTokenType::*/False:
+			return std::make_shared<object>(false);
+		case /*LispTokenType::*/Nil:
+			return std::make_shared<object>(null);
+		default:
+			return std::make_shared<object>(text, length);
+		}
+	}
+
+	// ************************************************************************
+
+	/// <summary>
+	/// Collects the token views for the tokenizer.
+	/// The text of the current token is a view into the code, it is only
+	/// copied into a buffer if escaped characters are appended.
+	/// </summary>
+	class LispTokenViewBuilder
+	{
+	public:
+		size_t CurrentTokenStartPos;
+		bool IsInString;
+		bool IsInSymbol;
+
+		LispTokenViewBuilder(const string & code, size_t offset, std::vector<LispTokenView> & tokens, std::vector<string> & escapedTexts)
+			: CurrentTokenStartPos(0), IsInString(false), IsInSymbol(false),
+			  m_Code(code.c_str()), m_Offset(offset), m_Tokens(tokens), m_EscapedTexts(escapedTexts), m_Begin(0), m_Length(0), m_IsEscaped(false)
+		{
+		}
+
+		bool IsEmpty() const
+		{
+			return m_IsEscaped ? m_Buffer.empty() : m_Length == 0;
+		}
+
+		string GetText() const
+		{
+			return m_IsEscaped ? m_Buffer : string(m_Code + m_Begin, m_Length);
+		}
+
+		void Append(size_t pos, size_t length)
+		{
+			if (m_IsEscaped)
+			{
+				m_Buffer.append(m_Code + pos, length);
+			}
+			else if (m_Length == 0)
+			{
+				m_Begin = pos;
+				m_Length = length;
+			}
+			else if (m_Begin + m_Length == pos)
+			{
+				m_Length += length;
+			}
+			else
+			{
+				CopyToBuffer();
+				m_Buffer.append(m_Code + pos, length);
+			}
+		}
+
+		void AppendEscaped(char ch)
+		{
+			CopyToBuffer();
+			m_Buffer += ch;
+		}
+
+		void StartString()
+		{
+			IsInString = true;
+			Clear();
+		}
+
+		void AddCurrentToken(size_t pos, size_t lineNo)
+		{
+			if (m_IsEscaped)
+			{
+				AddTextToken(m_Buffer, pos, lineNo);
+			}
+			else
+			{
+				AddToken(GetAtomType(m_Code + m_Begin, m_Length), m_Begin, m_Length, pos, lineNo);
+			}
+		}
+
+		void AddStringToken(size_t pos, size_t lineNo)
+		{
+			if (m_IsEscaped)
+			{
+				AddEscapedToken(/*LispTokenType::*/String, m_Buffer, pos, lineNo);
+			}
+			else
+			{
+				AddToken(/*LispTokenType::*/String, m_Begin, m_Length, pos, lineNo);
+			}
+		}
+
+		void AddListToken(char ch, size_t pos, size_t lineNo)
+		{
+			AddToken(ch == '(' ? /*LispTokenType::*/ListStart : /*LispTokenType::*/ListEnd, pos, 1, pos, lineNo);
+		}
+
+		void AddQuoteToken(char ch, size_t pos, size_t lineNo)
+		{
+			AddToken(ch == ',' ? /*LispTokenType::*/UnQuote : (ch == '`' ? /*LispTokenType::*/QuasiQuote : /*LispTokenType::*/Quote), pos, 1, pos, lineNo);
+		}
+
+		void AddUnQuoteSplicingToken(char ch, size_t pos, size_t lineNo)
+		{
+			if (ch == ',')
+			{
+				AddToken(/*LispTokenType::*/UnQuoteSplicing, pos - 1, 2, pos, lineNo);
+			}
+			else
+			{
+				// '@ and `@ are symbols
+				AddTextToken(string(ch) + "@", pos, lineNo);
+			}
+		}
+
+		void AddCommentToken(size_t pos, size_t stop, size_t lineNo)
+		{
+			AddToken(/*LispTokenType::*/Comment, pos, stop - pos + 1, pos, lineNo);
+		}
+
+		void AddTextToken(const string & text, size_t pos, size_t lineNo)
+		{
+			// the text can be any token, it is classified like in the token constructor
+			LispTokenType type = LispToken::GetTokenType(text);
+			AddEscapedToken(type, type == /*LispTokenType::*/String ? text.Substring(1, text.Length() - 2) : text, pos, lineNo);
+		}
+
+	private:
+		const char * m_Code;
+		size_t m_Offset;
+		std::vector<LispTokenView> & m_Tokens;
+		std::vector<string> & m_EscapedTexts;
+		size_t m_Begin;
+		size_t m_Length;
+		bool m_IsEscaped;
+		string m_Buffer;
+
+		void AddToken(LispTokenType type, size_t textOffset, size_t textLength, size_t pos, size_t lineNo)
+		{
+			LispTokenView token;
+			token.Type = type;
+			token.TextOffset = textOffset;
+			token.TextLength = textLength;
+			token.EscapedText = LispTokenView::NoEscapedText;
+			token.StartPos = CurrentTokenStartPos - m_Offset;
+			token.StopPos = pos - m_Offset;
+			token.LineNo = lineNo;
+			m_Tokens.push_back(token);
+			FinishToken(pos);
+		}
+
+		void AddEscapedToken(LispTokenType type, const string & text, size_t pos, size_t lineNo)
+		{
+			m_EscapedTexts.push_back(text);
+			AddToken(type, 0, text.Length(), pos, lineNo);
+			m_Tokens.back().EscapedText = m_EscapedTexts.size() - 1;
+		}
+
+		void FinishToken(size_t pos)
+		{
+			IsInSymbol = false;
+			IsInString = false;
+			Clear();
+			CurrentTokenStartPos = pos + 1;
+		}
+
+		void Clear()
+		{
+			m_Length = 0;
+			m_IsEscaped = false;
+			m_Buffer.clear();
+		}
+
+		void CopyToBuffer()
+		{
+			if (!m_IsEscaped)
+			{
+				m_Buffer.assign(m_Code + m_Begin, m_Length);
+				m_IsEscaped = true;
+			}
+		}
+	};
+
+	// ************************************************************************
+
+	IEnumerable<std::shared_ptr<LispToken>> LispTokenizer::Tokenize(const string & code, size_t offset, std::shared_ptr<LispArena> arena, size_t lineNo)
 	{
+		std::vector<LispTokenView> views;
+		std::vector<string> escapedTexts;
+		Scan(code, offset, /*out*/ views, /*out*/ escapedTexts, lineNo);
+
 		IEnumerable<std::shared_ptr<LispToken>> tokens; // = new List<LispToken>();
-		string currentToken = string::Empty;
-		size_t currentTokenStartPos = 0;
-		size_t lineCount = 1;
-		bool isInString = false;
-		bool isInSymbol = false;
+		tokens.reserve(views.size());
+		for (const LispTokenView & view : views)
+		{
+			const char * text = view.EscapedText != LispTokenView::NoEscapedText ? escapedTexts[view.EscapedText].c_str() : code.c_str() + view.TextOffset;
+			size_t symbolId;
+			std::shared_ptr<object> value = CreateValue(view.Type, text, view.TextLength, /*out*/ symbolId);
+			if (arena != null)
+			{
+				tokens.Add(MakeArenaShared<LispToken>(arena, view.Type, value, symbolId, view.StartPos, view.StopPos, view.LineNo));
+			}
+			else
+			{
+				tokens.Add(std::make_shared<LispToken>(view.Type, value, symbolId, view.StartPos, view.StopPos, view.LineNo));
+			}
+		}
+		return tokens;
+	}
+
+	void LispTokenizer::Scan(const string & code, size_t offset, /*out*/ std::vector<LispTokenView> & tokens, /*out*/ std::vector<string> & escapedTexts, size_t lineNo)
+	{
+		const unsigned char * charClasses = GetCharClasses();
+		const char * text = code.c_str();
+		size_t length = code.Length();
+		LispTokenViewBuilder builder(code, offset, tokens, escapedTexts);
+		size_t lineCount = lineNo;
 		bool wasLastBackslash = false;
 
-		/*Action<string, int, int>*/
-		std::function<void(const string &, size_t, size_t)> addToken = [&tokens, offset, &isInSymbol, &isInString, &currentToken, &currentTokenStartPos](const string & currentTok, size_t pos, size_t line)
-		{
-			tokens.Add(std::make_shared<LispToken>(currentTok, currentTokenStartPos - offset, pos - offset, line));
-			isInSymbol = false;
-			isInString = false;
-			currentToken = string::Empty;
-			currentTokenStartPos = pos + 1;
-		};
+		tokens.clear();
+		escapedTexts.clear();
+		// a rough estimate to avoid most reallocations
+		tokens.reserve(length / 4);
 
-		for (size_t i = 0; i < code.Length(); i++)
+		for (size_t i = 0; i < length; i++)
 		{
-			char ch = code[i];
-			if (Char_IsWhiteSpace(ch))
+			if (builder.IsInString && !wasLastBackslash)
+			{
+				// all characters up to the next quote or backslash belong to the string
+				size_t stop = i;
+				while (stop < length && text[stop] != '"' && text[stop] != '\\')
+				{
+					if (text[stop] == '\n')
+					{
+						lineCount++;
+					}
+					stop++;
+				}
+				if (stop > i)
+				{
+					builder.Append(i, stop - i);
+					i = stop;
+					if (i == length)
+					{
+						break;
+					}
+				}
+			}
+
+			char ch = text[i];
+			switch (charClasses[(unsigned char)ch])
 			{
-				if (isInString)
+			case WhiteSpaceChar:
+				if (builder.IsInString)
 				{
-					currentToken += ch;
+					builder.Append(i, 1);
 				}
-				else if (isInSymbol)
+				else if (builder.IsInSymbol)
 				{
-					addToken(currentToken, i, lineCount);
+					builder.AddCurrentToken(i, lineCount);
 				}
 				wasLastBackslash = false;
 				if (ch == '\n')
 				{
 					lineCount++;
 				}
-			}
-			else if (ch == '\\')
-			{
+				break;
+			case BackslashChar:
 				if (wasLastBackslash)
 				{
-					currentToken += ch;
+					builder.AppendEscaped(ch);
 					wasLastBackslash = false;
 				}
 				else
 				{
 					wasLastBackslash = true;
 				}
-			}
-			else if (ch == '(' || ch == ')')
-			{
-				if (isInString)
-				{
-					currentToken += ch;
-				}
-				else if (isInSymbol)
+				break;
+			case ListChar:
+				if (builder.IsInString)
 				{
-					addToken(currentToken, i, lineCount);
-					addToken(string::Empty + string(ch), i, lineCount);
+					builder.Append(i, 1);
 				}
 				else
 				{
-					addToken(string::Empty + string(ch), i, lineCount);
+					if (builder.IsInSymbol)
+					{
+						builder.AddCurrentToken(i, lineCount);
+					}
+					builder.AddListToken(ch, i, lineCount);
 				}
 				wasLastBackslash = false;
-			}
-			else if (ch == ';')
-			{
-				if (isInString)
+				break;
+			case CommentChar:
+				if (builder.IsInString)
 				{
-					currentToken += ch;
-				}
-				else if (isInSymbol)
-				{
-					addToken(currentToken, i, lineCount);
-					i = ProcessComment(code, i, lineCount, ch, addToken);
+					builder.Append(i, 1);
 				}
 				else
 				{
-					i = ProcessComment(code, i, lineCount, ch, addToken);
+					if (builder.IsInSymbol)
+					{
+						builder.AddCurrentToken(i, lineCount);
+					}
+					size_t stop = GetEndOfComment(code, i);
+					builder.AddCommentToken(i, stop, lineCount);
+					i = stop;
+					// comment ends always with new line
+					lineCount++;
 				}
 				wasLastBackslash = false;
-				// comment ends always with new line
-				lineCount++;
-			}
-			else if (ch == '\'' || ch == '`' || ch == ',')
-			{
-				if (isInString)
+				break;
+			case QuoteChar:
+				if (builder.IsInString)
 				{
-					currentToken += ch;
+					builder.Append(i, 1);
+				}
+				else if (text[i + 1] == '@')
+				{
+					// process unquotesplicing
+					i++;
+					builder.AddUnQuoteSplicingToken(ch, i, lineCount);
 				}
 				else
 				{
-					if (code[i + 1] == '@')
-					{
-						// process unquotesplicing
-						string s = string::Empty;
-						s += ch;
-						i++;
-						s += code[i];
-						addToken(s, i, lineCount);
-					}
-					else
-					{
-						addToken(string::Empty + string(ch), i, lineCount);
-					}
+					builder.AddQuoteToken(ch, i, lineCount);
 				}
 				wasLastBackslash = false;
-			}
-			else if (ch == '"')
-			{
+				break;
+			case StringChar:
 				if (wasLastBackslash)
 				{
-					currentToken += ch;
+					builder.AppendEscaped(ch);
 				}
-				else if (isInString)
+				else if (builder.IsInString)
 				{
 					// finish string
-					addToken(string("\"") + currentToken + string("\""), i, lineCount);
+					builder.AddStringToken(i, lineCount);
 				}
 				else
 				{
-					// start string
-					isInString = true;
-					currentToken = string::Empty;
+					builder.StartString();
 				}
 				wasLastBackslash = false;
-			}
-			else
-			{
-				if (!isInSymbol && !isInString)
+				break;
+			default:
+				if (!builder.IsInSymbol && !builder.IsInString)
 				{
-					isInSymbol = true;
+					builder.IsInSymbol = true;
 				}
 				if (wasLastBackslash)
 				{
-					ch = ProcessCharAfterBackslash(ch);
+					builder.AppendEscaped(ProcessCharAfterBackslash(ch));
+					wasLastBackslash = false;
 				}
-				currentToken += ch;
-				wasLastBackslash = false;
+				else
+				{
+					// append all following symbol characters at once
+					size_t stop = i + 1;
+					while (stop < length && charClasses[(unsigned char)text[stop]] == SymbolChar)
+					{
+						stop++;
+					}
+					builder.Append(i, stop - i);
+					i = stop - 1;
+				}
+				break;
 			}
 		}
-		if (currentToken != string::Empty)
+		if (!builder.IsEmpty())
 		{
-			addToken(currentToken, -1, lineCount);
+			// the last symbol or the text of an unterminated string
+			builder.AddTextToken(builder.GetText(), (size_t)-1, lineCount);
 		}
-		return tokens;
 	}
 
 	char LispTokenizer::ProcessCharAfterBackslash(char ch)
@@ -195,25 +622,10 @@ namespace CppLisp
 		throw LispExceptionBase(string::Format(string("Invalid character after backslash {0}"), string(ch)));
 	}
 
-	size_t LispTokenizer::ProcessComment(const string & code, size_t i, size_t lineCount, char ch, /*Action<string, size_t, size_t>*/std::function<void(const string &, size_t, size_t)> addToken)
+	size_t LispTokenizer::GetEndOfComment(const string & code, size_t i)
 	{
-		size_t newIndex;
-		string comment = string::Empty + string(ch) + GetRestOfLine(code, i + 1, /*out*/ newIndex);
-		addToken(comment, i, lineCount);
-		i = newIndex;
-		return i;
-	}
-
-	string LispTokenizer::GetRestOfLine(const string & code, size_t i, /*out*/ size_t & newIndex)
-	{
-		string rest = code.Substring(i);
-		size_t pos = rest.IndexOf("\n", "StringComparison.InvariantCulture");
-		if (pos > 0)
-		{
-			newIndex = i + pos;
-			return rest.Substring(0, pos + 1);
-		}
-		newIndex = i + rest.Length() - 1;
-		return rest;
+		// a comment ends with the next new line or with the code
+		const char * newLine = (const char *)memchr(code.c_str() + i, '\n', code.Length() - i);
+		return newLine != null ? (size_t)(newLine - code.c_str()) : code.Length() - 1;
 	}
-}
\ No newline at end of file
+}
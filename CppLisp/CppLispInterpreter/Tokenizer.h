@@ -27,12 +27,62 @@
 #define _TOKENIZER_H
 
 #include "Token.h"
+#include "Arena.h"
 #include "cstypes.h"
 
 namespace CppLisp
 {
 	/// <summary>
-	/// The FUEL lisp tokenizer
+	/// A token found by <see cref="LispTokenizer::Scan"/>.
+	/// The text of the token is a view into the scanned code, only the texts
+	/// of tokens with escaped characters are copied into a separate container.
+	/// The text is the content of a string without quotes, the complete comment,
+	/// the name of a symbol or the text of all other tokens.
+	/// </summary>
+	struct DLLEXPORT LispTokenView
+	{
+		/*public*/ const static size_t NoEscapedText = (size_t)-1;
+
+		/// <summary>
+		/// The type of the token.
+		/// </summary>
+		/*public*/ LispTokenType Type;
+
+		/// <summary>
+		/// The position of the text in the code.
+		/// </summary>
+		/*public*/ size_t TextOffset;
+
+		/// <summary>
+		/// The length of the text.
+		/// </summary>
+		/*public*/ size_t TextLength;
+
+		/// <summary>
+		/// The index of the text in the escaped texts or NoEscapedText.
+		/// </summary>
+		/*public*/ size_t EscapedText;
+
+		/// <summary>
+		/// The start position, see <see cref="LispToken::StartPos"/>.
+		/// </summary>
+		/*public*/ size_t StartPos;
+
+		/// <summary>
+		/// The stop position, see <see cref="LispToken::StopPos"/>.
+		/// </summary>
+		/*public*/ size_t StopPos;
+
+		/// <summary>
+		/// The line no of the token.
+		/// </summary>
+		/*public*/ size_t LineNo;
+	};
+
+	/// <summary>
+	/// The FUEL lisp tokenizer.
+	/// The code is scanned with a table of character classes, the text of
+	/// a token is only copied if the token contains escaped characters.
 	/// </summary>
 	/*public*/ class DLLEXPORT LispTokenizer
 	{
@@ -44,8 +94,20 @@ namespace CppLisp
 		/// </summary>
 		/// <param name="code">The code.</param>
 		/// <param name="offset">The position offset (decorated code).</param>
+		/// <param name="arena">The arena for the tokens, tokens are allocated on the heap if no arena is given.</param>
+		/// <param name="lineNo">The line number of the first line of the code.</param>
 		/// <returns>Container with tokens</returns>
-		/*public*/ static IEnumerable<std::shared_ptr<LispToken>> Tokenize(const string & code, size_t offset = 0);
+		/*public*/ static IEnumerable<std::shared_ptr<LispToken>> Tokenize(const string & code, size_t offset = 0, std::shared_ptr<LispArena> arena = null, size_t lineNo = 1);
+
+		/// <summary>
+		/// Scans the specified code without creating token objects.
+		/// </summary>
+		/// <param name="code">The code.</param>
+		/// <param name="offset">The position offset (decorated code).</param>
+		/// <param name="tokens">Receives the tokens.</param>
+		/// <param name="escapedTexts">Receives the texts of the tokens with escaped characters.</param>
+		/// <param name="lineNo">The line number of the first line of the code.</param>
+		/*public*/ static void Scan(const string & code, size_t offset, /*out*/ std::vector<LispTokenView> & tokens, /*out*/ std::vector<string> & escapedTexts, size_t lineNo = 1);
 
 		//#endregion
 
@@ -54,9 +116,7 @@ namespace CppLisp
 	
 		/*private*/ static char ProcessCharAfterBackslash(char ch);
 
-		/*private*/ static size_t ProcessComment(const string & code, size_t i, size_t lineCount, char ch, /*Action<string, size_t, size_t>*/std::function<void(const string &, size_t, size_t)> addToken);
-
-		/*private*/ static string GetRestOfLine(const string & code, size_t i, /*out*/ size_t & newIndex);
+		/*private*/ static size_t GetEndOfComment(const string & code, size_t i);
 
 		//#endregion
 	};
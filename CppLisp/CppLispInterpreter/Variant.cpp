@@ -24,14 +24,16 @@
 * */
 
 #include "Variant.h"
+#include "Dictionary.h"
 #include "Exception.h"
+#include "Symbol.h"
 #include "cstypes.h"
 
 #include <math.h>
 
 namespace CppLisp
 {
-	double LispVariant::Tolerance = 1e-8;
+	const double LispVariant::Tolerance = 1e-8;
 
 	const string LispVariant::CanNotConvertTo = "can not convert {0} to {1}";
 	const string LispVariant::NoOperatorForTypes = "no {0} operator for types {1} and {2}";
@@ -44,11 +46,39 @@ namespace CppLisp
 	LispVariant::LispVariant(LispType type, std::shared_ptr<object> value, LispUnQuoteModus unQuoted)
 	{
 		Token = null;
+		m_SymbolId = LispSymbolTable::NoSymbol;
 		Type = type;
-		Value = value;
+		SetValue(value);
 		IsUnQuoted = unQuoted;
 	}
 
+	LispVariant::LispVariant(bool value)
+	{
+		Token = null;
+		m_SymbolId = LispSymbolTable::NoSymbol;
+		Type = LispType::_Bool;
+		m_Immediate.b = value;
+		IsUnQuoted = LispUnQuoteModus::_None;
+	}
+
+	LispVariant::LispVariant(int value)
+	{
+		Token = null;
+		m_SymbolId = LispSymbolTable::NoSymbol;
+		Type = LispType::_Int;
+		m_Immediate.i = value;
+		IsUnQuoted = LispUnQuoteModus::_None;
+	}
+
+	LispVariant::LispVariant(double value)
+	{
+		Token = null;
+		m_SymbolId = LispSymbolTable::NoSymbol;
+		Type = LispType::_Double;
+		m_Immediate.d = value;
+		IsUnQuoted = LispUnQuoteModus::_None;
+	}
+
 	LispVariant::LispVariant(std::function<void(std::shared_ptr<object>)> action)
 		: LispVariant(LispType::_LValue, std::make_shared<object>(action), LispUnQuoteModus::_None)
 	{
@@ -65,13 +95,15 @@ namespace CppLisp
 			Token = value.Token;
 			Type = value.Type;
 			Value = value.Value;
+			m_Immediate = value.m_Immediate;
+			m_SymbolId = value.m_SymbolId;
 			IsUnQuoted = value.IsUnQuoted;
 		}
 		else
 		{
 			Token = null;
 			Type = ConvertObjectTypeToVariantType(val->GetType());
-			Value = val;
+			SetValue(val);
 			IsUnQuoted = unQuoted;
 		}
 	}
@@ -81,9 +113,35 @@ namespace CppLisp
 		Token = other.Token;
 		Type = other.Type;
 		Value = other.Value;
+		m_Immediate = other.m_Immediate;
+		m_SymbolId = other.m_SymbolId;
 		IsUnQuoted = other.IsUnQuoted;
 	}
 
+	void LispVariant::SetValue(std::shared_ptr<object> value)
+	{
+		// store bool, int and double values as immediate values
+		if (value != null && Type == LispType::_Int && value->IsInt())
+		{
+			m_Immediate.i = (int)(*value);
+			Value = null;
+		}
+		else if (value != null && Type == LispType::_Double && value->IsDouble())
+		{
+			m_Immediate.d = (double)(*value);
+			Value = null;
+		}
+		else if (value != null && Type == LispType::_Bool && value->IsBool())
+		{
+			m_Immediate.b = (bool)(*value);
+			Value = null;
+		}
+		else
+		{
+			Value = value;
+		}
+	}
+
 	LispVariant::LispVariant(std::shared_ptr<LispToken> token, LispUnQuoteModus unQuoted)
 		: LispVariant(TypeOf(token->Value), token->Value, unQuoted)
 	{
@@ -95,6 +153,7 @@ namespace CppLisp
 		if (token->Type == LispTokenType::Symbol)
 		{
 			Type = LispType::_Symbol;
+			m_SymbolId = token->SymbolId;
 		}
 	}
 
@@ -133,6 +192,10 @@ namespace CppLisp
 			{
 				return "NativeDictionary";
 			}
+			if (Value->IsSortedDictionary())
+			{
+				return "NativeSortedDictionary";
+			}
 			return /*Type+*/string("NativeObject<") + Value->GetTypeName() + string(">");
 			//_Array = 10,
 		case _Error:
@@ -210,6 +273,19 @@ namespace CppLisp
 		{
 			return Value->ToString();
 		}
+		// same representation as for the boxed values
+		if (IsInt())
+		{
+			return std::to_string(m_Immediate.i);
+		}
+		if (IsDouble())
+		{
+			return std::to_string(m_Immediate.d);
+		}
+		if (IsBool())
+		{
+			return m_Immediate.b ? "true" : "false";
+		}
 		return "null";	// string::Empty;
 						//}
 	}
@@ -320,16 +396,69 @@ namespace CppLisp
 		return false;
 	}
 
+	size_t LispVariant::GetHash() const
+	{
+		switch (Type)
+		{
+			case LispType::_Bool:
+				return std::hash<bool>{}(BoolValue());
+			case LispType::_Int:
+				return std::hash<int>{}(IntValue());
+			case LispType::_Double:
+				return std::hash<double>{}(DoubleValue());
+			case LispType::_Symbol:
+				return std::hash<std::string>{}(ToString());
+			default:
+				return Value != null ? Value->GetHash(null) : std::hash<int>{}((int)Type);
+		}
+	}
+
+	bool LispVariant::KeyEquals(const LispVariant & other) const
+	{
+		if (Type != other.Type)
+		{
+			return false;
+		}
+		switch (Type)
+		{
+			case LispType::_Bool:
+				return BoolValue() == other.BoolValue();
+			case LispType::_Int:
+				return IntValue() == other.IntValue();
+			case LispType::_Double:
+				return DoubleValue() == other.DoubleValue();
+			default:
+				if (Value == null || other.Value == null)
+				{
+					return Value == other.Value;
+				}
+				return Value->Equals(*(other.Value));
+		}
+	}
+
 	bool LispVariant::SymbolCompare(std::shared_ptr<object> other) const
 	{
 		if (other->IsLispVariant())
 		{
 			const LispVariant & otherVariant = other->ToLispVariantRef();
-			return Value->Equals(*(otherVariant.Value));
+			if (IsSymbol() && otherVariant.IsSymbol())
+			{
+				return SymbolId() == otherVariant.SymbolId();
+			}
+			return Value != null && otherVariant.Value != null && Value->Equals(*(otherVariant.Value));
 		}
 		return false;
 	}
 
+	size_t LispVariant::SymbolId() const
+	{
+		if (m_SymbolId == LispSymbolTable::NoSymbol && IsSymbol() && Value != null)
+		{
+			m_SymbolId = LispSymbolTable::Intern(Value->ToString());
+		}
+		return m_SymbolId;
+	}
+
 	int LispVariant::CompareTo(std::shared_ptr<object> other)
 	{
 		if (other->IsLispVariant())
@@ -364,7 +493,7 @@ namespace CppLisp
 		list->Add(value);
 	}
 
-	LispVariant LispVariant::operator+(const LispVariant & r)
+	LispVariant LispVariant::operator+(const LispVariant & r) const
 	{
 		if (IsString() || r.IsString())
 		{
@@ -372,11 +501,11 @@ namespace CppLisp
 		}
 		if (IsDouble() || r.IsDouble())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToDouble() + r.ToDouble()));
+			return /*new*/ LispVariant(ToDouble() + r.ToDouble());
 		}
 		if (IsInt() || r.IsInt())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToInt() + r.ToInt()));
+			return /*new*/ LispVariant(ToInt() + r.ToInt());
 		}
 		if (IsList() && r.IsList())
 		{
@@ -388,54 +517,54 @@ namespace CppLisp
 		throw CreateInvalidOperationException("+", *this, r);
 	}
 
-	LispVariant LispVariant::operator -(const LispVariant & r)
+	LispVariant LispVariant::operator -(const LispVariant & r) const
 	{
 		if (IsDouble() || r.IsDouble())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToDouble() - r.ToDouble()));
+			return /*new*/ LispVariant(ToDouble() - r.ToDouble());
 		}
 		if (IsInt() || r.IsInt())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToInt() - r.ToInt()));
+			return /*new*/ LispVariant(ToInt() - r.ToInt());
 		}
 		throw CreateInvalidOperationException("-", *this, r);
 	}
 
-	LispVariant LispVariant::operator *(const LispVariant & r)
+	LispVariant LispVariant::operator *(const LispVariant & r) const
 	{
 		if (IsDouble() || r.IsDouble())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToDouble() * r.ToDouble()));
+			return /*new*/ LispVariant(ToDouble() * r.ToDouble());
 		}
 		if (IsInt() || r.IsInt())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToInt() * r.ToInt()));
+			return /*new*/ LispVariant(ToInt() * r.ToInt());
 		}
 		throw CreateInvalidOperationException("*", *this, r);
 	}
 
-	LispVariant LispVariant::operator /(const LispVariant & r)
+	LispVariant LispVariant::operator /(const LispVariant & r) const
 	{
 		if (IsDouble() || r.IsDouble())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToDouble() / r.ToDouble()));
+			return /*new*/ LispVariant(ToDouble() / r.ToDouble());
 		}
 		if (IsInt() || r.IsInt())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToInt() / r.ToInt()));
+			return /*new*/ LispVariant(ToInt() / r.ToInt());
 		}
 		throw CreateInvalidOperationException("/", *this, r);
 	}
 
-	LispVariant LispVariant::operator %(const LispVariant & r)
+	LispVariant LispVariant::operator %(const LispVariant & r) const
 	{
 		if (IsDouble() || r.IsDouble())
 		{
-            return /*new*/ LispVariant(std::make_shared<object>(fmod(ToDouble(),r.ToDouble())));
+            return /*new*/ LispVariant(fmod(ToDouble(),r.ToDouble()));
 		}
 		if (IsInt() || r.IsInt())
 		{
-			return /*new*/ LispVariant(std::make_shared<object>(ToInt() % r.ToInt()));
+			return /*new*/ LispVariant(ToInt() % r.ToInt());
 		}
 		throw CreateInvalidOperationException("%", *this, r);
 	}
@@ -629,6 +758,36 @@ namespace CppLisp
 		//}
 	}
 
+	LispList g_EmptyListValue;
+
+	const LispList & LispVariant::LispListValueRef() const
+	{
+		// Nil is an empty list () !
+		if (Type == LispType::_Nil)
+		{
+			return g_EmptyListValue;
+		}
+		if (Type != LispType::_List)
+		{
+			throw CreateInvalidCastException("list");
+		}
+		return Value->ToLispListRef();
+	}
+
+	LispList & LispVariant::LispListValueNotConstRef()
+	{
+		// Nil is an empty list () !
+		if (Type == LispType::_Nil)
+		{
+			return g_EmptyListValue;
+		}
+		if (Type != LispType::_List)
+		{
+			throw CreateInvalidCastException("list");
+		}
+		return Value->ToLispListNotConstRef();
+	}
+
 	IEnumerable<std::shared_ptr<object>> & LispVariant::ListValueNotConstRef()
 	{
 		//get
@@ -658,7 +817,7 @@ namespace CppLisp
 		{
 			throw CreateInvalidCastException("double");
 		}
-			return (double)(*Value);
+			return Value != null ? (double)(*Value) : m_Immediate.d;
 		//}
 	}
 
@@ -670,7 +829,7 @@ namespace CppLisp
 		{
 			throw CreateInvalidCastException("int");
 		}
-		return (int)(*Value);
+		return Value != null ? (int)(*Value) : m_Immediate.i;
 		//}
 	}
 
@@ -682,7 +841,7 @@ namespace CppLisp
 		{
 			throw CreateInvalidCastException("bool");
 		}
-		return (bool)(*Value);
+		return Value != null ? (bool)(*Value) : m_Immediate.b;
 		//}
 	}
 
@@ -694,10 +853,49 @@ namespace CppLisp
 		{
 			throw CreateInvalidCastException("native object");
 		}
-		return Value;
+		return BoxedValue();
 		//}
 	}
 
+	std::shared_ptr<object> LispVariant::BoxedValue() const
+	{
+		if (Value == null)
+		{
+			if (IsInt())
+			{
+				return std::make_shared<object>(m_Immediate.i);
+			}
+			if (IsDouble())
+			{
+				return std::make_shared<object>(m_Immediate.d);
+			}
+			if (IsBool())
+			{
+				return std::make_shared<object>(m_Immediate.b);
+			}
+		}
+		return Value;
+	}
+
+	static string GetNativeObjectStringRepresentation(std::shared_ptr<object> obj);
+
+	template <class DictionaryType> static string GetDictionaryStringRepresentation(const DictionaryType & container)
+	{
+		string result = string::Empty;
+		//foreach(KeyValuePair<object, object> element in container)
+		for (const auto & element : container)
+		{
+			if (result.Length() > 0)
+			{
+				result += ", ";
+			}
+
+			result += "[" + GetNativeObjectStringRepresentation(element.first.BoxedValue()) + " : " + GetNativeObjectStringRepresentation(element.second) + "]";
+		}
+
+		return "{ " + result + " }";
+	}
+
 	static string GetNativeObjectStringRepresentation(std::shared_ptr<object> obj)
 	{
 		//get
@@ -720,19 +918,11 @@ namespace CppLisp
 		}
 		else if (native->IsDictionary())
 		{
-			var container = native->ToDictionary();
-			//foreach(KeyValuePair<object, object> element in container)
-			for (var element : container)
-			{
-				if (result.Length() > 0)
-				{
-					result += ", ";
-				}
-
-				result += "[" + GetNativeObjectStringRepresentation(element.first.Value) + " : " + GetNativeObjectStringRepresentation(element.second) + "]";
-			}
-
-			result = "{ " + result + " }";
+			result = GetDictionaryStringRepresentation(native->ToDictionaryRef());
+		}
+		else if (native->IsSortedDictionary())
+		{
+			result = GetDictionaryStringRepresentation(native->ToSortedDictionaryRef());
 		}
 		else if (native->IsString())
 		{
@@ -783,7 +973,26 @@ namespace CppLisp
 
 	bool LispVariant::operator==(const LispVariant & r) const
 	{
-		return *Value == *(r.Value);
+		if (Value != null && r.Value != null)
+		{
+			return *Value == *(r.Value);
+		}
+		// compare the immediate values like the boxed values
+		if (Value == null && r.Value == null && Type == r.Type)
+		{
+			switch (Type)
+			{
+				case LispType::_Bool:
+					return m_Immediate.b == r.m_Immediate.b;
+				case LispType::_Int:
+					return m_Immediate.i == r.m_Immediate.i;
+				case LispType::_Double:
+					return m_Immediate.d == r.m_Immediate.d;
+				default:
+					return true;
+			}
+		}
+		return false;
 	}
 
 	bool LispVariant::operator!=(const LispVariant & other) const
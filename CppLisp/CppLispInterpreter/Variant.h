@@ -101,6 +101,37 @@ namespace CppLisp
 		}
 	}
 
+	// **********************************************************************
+	/// <summary>
+	/// A bool, int or double value which is not allocated on the heap,
+	/// used for the operands and results of the native operations.
+	/// </summary>
+	struct LispImmediate
+	{
+		LispType Type;
+
+		union
+		{
+			bool b;
+			int i;
+			double d;
+		} Value;
+
+		inline bool IsNumber() const
+		{
+			return Type == LispType::_Int || Type == LispType::_Double;
+		}
+
+		inline double ToDouble() const
+		{
+			return Type == LispType::_Int ? (double)Value.i : Value.d;
+		}
+
+		inline std::shared_ptr<LispVariant> ToLispVariant() const;
+
+		inline std::shared_ptr<object> ToObject() const;
+	};
+
     /// <summary>
     /// Generic data container for lisp data types.
     /// </summary>
@@ -119,7 +150,24 @@ namespace CppLisp
 		// disable assignment operator
 		LispVariant & operator=(const LispVariant & other);
 		
-		/*private*/ static double Tolerance; //{ get; set; }
+		/*private*/ const static double Tolerance;
+
+		/// <summary>
+		/// The value of bool, int and double values. These immediate values
+		/// are stored inline and not in a heap allocated object, 
+		/// <see cref="Value"/> is null for immediate values.
+		/// </summary>
+		union ImmediateValue
+		{
+			bool b;
+			int i;
+			double d;
+		} m_Immediate;
+
+		/// <summary>
+		/// The interned id of a symbol, determined on first use.
+		/// </summary>
+		mutable size_t m_SymbolId;
 
     public:
 		/*public*/ std::shared_ptr<LispVariant> CachedFunction; //{ get; set; }
@@ -199,6 +247,11 @@ namespace CppLisp
 			/*get {*/ return Type == LispType::_LValue; //}
 		}
 
+		/*public*/ inline bool IsImmediate() const
+		{
+			/*get {*/ return Value == null && (IsBool() || IsInt() || IsDouble()); //}
+		}
+
 
         //#endregion
 
@@ -236,6 +289,15 @@ namespace CppLisp
 
 		explicit LispVariant(std::function<void(std::shared_ptr<object>)> action);
 
+        /// <summary>
+        /// Initializes a new instance of the <see cref="LispVariant"/> class 
+        /// with an immediate value (no heap allocation for the value).
+        /// </summary>
+        /// <param name="value">The value.</param>
+		explicit LispVariant(bool value);
+		explicit LispVariant(int value);
+		explicit LispVariant(double value);
+
 		LispVariant(const LispVariant & other);
 
 	//protected:
@@ -278,6 +340,12 @@ namespace CppLisp
 		/*public*/ const IEnumerable<std::shared_ptr<object>> & ListValueRef() const;
 		/*public*/ IEnumerable<std::shared_ptr<object>> & ListValueNotConstRef();
 
+		/// <summary>
+		/// Returns the list without copying, rest and cons of the returned list are O(1).
+		/// </summary>
+		/*public*/ const LispList & LispListValueRef() const;
+		/*public*/ LispList & LispListValueNotConstRef();
+
         /*public*/ double DoubleValue() const;
 
         /*public*/ int IntValue() const;
@@ -286,6 +354,12 @@ namespace CppLisp
 
         /*public*/ std::shared_ptr<object> NativeObjectValue() const;
 
+        /// <summary>
+        /// Returns the value as object, immediate values are boxed into a new object.
+        /// </summary>
+        /// <returns>The value as object</returns>
+		/*public*/ std::shared_ptr<object> BoxedValue() const;
+
         /*public*/ string NativeObjectStringRepresentation() const;
 
 		/*public*/ bool ToBool() const;
@@ -340,6 +414,12 @@ namespace CppLisp
 
 		/*public*/ bool SymbolCompare(std::shared_ptr<object> other) const;
 
+		/// <summary>
+		/// Returns the interned id of this symbol, see <see cref="LispSymbolTable"/>.
+		/// </summary>
+		/// <returns>The symbol id or LispSymbolTable::NoSymbol if this is not a symbol</returns>
+		/*public*/ size_t SymbolId() const;
+
         //#region overloaded methods
 
         /// <summary>
@@ -351,6 +431,20 @@ namespace CppLisp
         /// <param name="other">The object to compare with the current object. </param><filterpriority>2</filterpriority>
 		/*public override*/ bool Equals(std::shared_ptr<object>  other) const;
 
+		/// <summary>
+		/// Returns the hash value of this value, used for the keys of a <see cref="LispDictionary"/>.
+		/// </summary>
+		/// <returns>The hash value</returns>
+		size_t GetHash() const;
+
+		/// <summary>
+		/// Determines whether this value and the other value are the same key of a <see cref="LispDictionary"/>.
+		/// The values must have the same type and must be equal, 1 and 1.0 are different keys.
+		/// </summary>
+		/// <param name="other">The other value.</param>
+		/// <returns>True if the values are the same key</returns>
+		bool KeyEquals(const LispVariant & other) const;
+
         //#endregion
 
         //#region Operations
@@ -360,11 +454,11 @@ namespace CppLisp
 		bool operator==(const LispVariant & other) const;
 		bool operator!=(const LispVariant & other) const;
 
-		/*public static*/ LispVariant operator+(const LispVariant & r);
-		/*public static*/ LispVariant operator -(const LispVariant & r);
-		/*public static*/ LispVariant operator *(const LispVariant & r);
-		/*public static*/ LispVariant operator /(const LispVariant & r);
-		/*public static*/ LispVariant operator %(const LispVariant & r);
+		/*public static*/ LispVariant operator+(const LispVariant & r) const;
+		/*public static*/ LispVariant operator -(const LispVariant & r) const;
+		/*public static*/ LispVariant operator *(const LispVariant & r) const;
+		/*public static*/ LispVariant operator /(const LispVariant & r) const;
+		/*public static*/ LispVariant operator %(const LispVariant & r) const;
 		/*public static*/ bool operator <(const LispVariant & r) const;
 		/*public static*/ inline bool operator >(const LispVariant & r) const
         {
@@ -383,6 +477,95 @@ namespace CppLisp
 
 		/*public*/ static bool EqualOp(const LispVariant & l, const LispVariant & r);
 
+		/// <summary>
+		/// Gets the value of a bool, int or double variant as immediate value.
+		/// </summary>
+		/// <param name="value">The immediate value.</param>
+		/// <returns>False if the variant is not a bool, int or double value.</returns>
+		/*public*/ inline bool ToImmediate(LispImmediate & value) const
+		{
+			switch (Type)
+			{
+				case LispType::_Int:
+					value.Type = LispType::_Int;
+					value.Value.i = Value != null ? (int)(*Value) : m_Immediate.i;
+					return true;
+				case LispType::_Double:
+					value.Type = LispType::_Double;
+					value.Value.d = Value != null ? (double)(*Value) : m_Immediate.d;
+					return true;
+				case LispType::_Bool:
+					value.Type = LispType::_Bool;
+					value.Value.b = Value != null ? (bool)(*Value) : m_Immediate.b;
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		/// <summary>
+		/// Executes an arithmetic or compare operation without heap allocation.
+		/// The kernels for int/int, int/double and double/double operands have the 
+		/// same semantics like the operators of this class, bool operands are 
+		/// supported by == and != only.
+		/// </summary>
+		/// <param name="op">The operation.</param>
+		/// <param name="l">The left operand.</param>
+		/// <param name="r">The right operand.</param>
+		/// <param name="result">The result of the operation.</param>
+		/// <returns>False if the operation must be executed by the operators of this class.</returns>
+		/*public*/ static inline bool NativeOperation(LispOperator op, const LispImmediate & l, const LispImmediate & r, LispImmediate & result)
+		{
+			if (l.Type == LispType::_Int && r.Type == LispType::_Int)
+			{
+				int a = l.Value.i;
+				int b = r.Value.i;
+				switch (op)
+				{
+					case OperatorAdd:			result.Type = LispType::_Int; result.Value.i = a + b; return true;
+					case OperatorSubtract:		result.Type = LispType::_Int; result.Value.i = a - b; return true;
+					case OperatorMultiply:		result.Type = LispType::_Int; result.Value.i = a * b; return true;
+					// division by zero is handled by the operators
+					case OperatorDivide:		if (b == 0) return false; result.Type = LispType::_Int; result.Value.i = a / b; return true;
+					case OperatorModulo:		if (b == 0) return false; result.Type = LispType::_Int; result.Value.i = a % b; return true;
+					case OperatorLess:			result.Type = LispType::_Bool; result.Value.b = a < b; return true;
+					case OperatorGreater:		result.Type = LispType::_Bool; result.Value.b = a > b; return true;
+					case OperatorLessEqual:		result.Type = LispType::_Bool; result.Value.b = a <= b; return true;
+					case OperatorGreaterEqual:	result.Type = LispType::_Bool; result.Value.b = a >= b; return true;
+					case OperatorEqual:			result.Type = LispType::_Bool; result.Value.b = a == b; return true;
+					case OperatorNotEqual:		result.Type = LispType::_Bool; result.Value.b = a != b; return true;
+					default:					return false;
+				}
+			}
+			if (l.IsNumber() && r.IsNumber())
+			{
+				double a = l.ToDouble();
+				double b = r.ToDouble();
+				switch (op)
+				{
+					case OperatorAdd:			result.Type = LispType::_Double; result.Value.d = a + b; return true;
+					case OperatorSubtract:		result.Type = LispType::_Double; result.Value.d = a - b; return true;
+					case OperatorMultiply:		result.Type = LispType::_Double; result.Value.d = a * b; return true;
+					case OperatorDivide:		result.Type = LispType::_Double; result.Value.d = a / b; return true;
+					case OperatorModulo:		result.Type = LispType::_Double; result.Value.d = fmod(a, b); return true;
+					case OperatorLess:			result.Type = LispType::_Bool; result.Value.b = a < b; return true;
+					case OperatorGreater:		result.Type = LispType::_Bool; result.Value.b = a > b; return true;
+					case OperatorLessEqual:		result.Type = LispType::_Bool; result.Value.b = a <= b; return true;
+					case OperatorGreaterEqual:	result.Type = LispType::_Bool; result.Value.b = a >= b; return true;
+					case OperatorEqual:			result.Type = LispType::_Bool; result.Value.b = fabs(a - b) < Tolerance; return true;
+					case OperatorNotEqual:		result.Type = LispType::_Bool; result.Value.b = !(fabs(a - b) < Tolerance); return true;
+					default:					return false;
+				}
+			}
+			if (l.Type == LispType::_Bool && r.Type == LispType::_Bool && (op == OperatorEqual || op == OperatorNotEqual))
+			{
+				result.Type = LispType::_Bool; 
+				result.Value.b = (l.Value.b == r.Value.b) == (op == OperatorEqual);
+				return true;
+			}
+			return false;
+		}
+
         //#endregion
 
     private:
@@ -390,12 +573,62 @@ namespace CppLisp
 
 		/*private*/ static LispType TypeOf(std::shared_ptr<object> obj);
 
+		/*private*/ void SetValue(std::shared_ptr<object> value);
+
 		/*private*/ LispException CreateInvalidCastException(const string & name, const string & msg = "no") const;
 	    /*private*/ static LispException CreateInvalidOperationException(const string & operation, const LispVariant & l, const LispVariant & r);
 
         //#endregion
     };
 
+	/// <summary>
+	/// Hash function for the keys of a <see cref="LispDictionary"/>.
+	/// </summary>
+	struct LispVariantKeyHash
+	{
+		inline size_t operator()(const LispVariant & key) const
+		{
+			return key.GetHash();
+		}
+	};
+
+	/// <summary>
+	/// Equality of the keys of a <see cref="LispDictionary"/>.
+	/// </summary>
+	struct LispVariantKeyEqual
+	{
+		inline bool operator()(const LispVariant & l, const LispVariant & r) const
+		{
+			return l.KeyEquals(r);
+		}
+	};
+
+	inline std::shared_ptr<LispVariant> LispImmediate::ToLispVariant() const
+	{
+		switch (Type)
+		{
+			case LispType::_Int:
+				return std::make_shared<LispVariant>(Value.i);
+			case LispType::_Double:
+				return std::make_shared<LispVariant>(Value.d);
+			default:
+				return std::make_shared<LispVariant>(Value.b);
+		}
+	}
+
+	inline std::shared_ptr<object> LispImmediate::ToObject() const
+	{
+		switch (Type)
+		{
+			case LispType::_Int:
+				return std::make_shared<object>(LispVariant(Value.i));
+			case LispType::_Double:
+				return std::make_shared<object>(LispVariant(Value.d));
+			default:
+				return std::make_shared<object>(LispVariant(Value.b));
+		}
+	}
+
 	template <class T>
     inline T ToType(const LispVariant & variant)
     {
@@ -0,0 +1,1152 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#include "VirtualMachine.h"
+#include "Interpreter.h"
+#include "Environment.h"
+#include "Exception.h"
+#include "Profiler.h"
+
+namespace CppLisp
+{
+	// **********************************************************************
+	// A register holds an object (resolved symbol or constant argument), 
+	// a variant (result of an evaluation) or an immediate value (result of 
+	// a native operation, not allocated on the heap), the conversion is 
+	// done on demand.
+	struct LispRegister
+	{
+		std::shared_ptr<object> Object;
+		std::shared_ptr<LispVariant> Variant;
+		LispImmediate Immediate;
+		bool IsImmediate;
+
+		inline LispRegister()
+			: IsImmediate(false)
+		{
+		}
+
+		inline void Set(std::shared_ptr<object> value)
+		{
+			Object = std::move(value);
+			Variant.reset();
+			IsImmediate = false;
+		}
+
+		inline void Set(std::shared_ptr<LispVariant> value)
+		{
+			Object.reset();
+			Variant = std::move(value);
+			IsImmediate = false;
+		}
+
+		inline void Set(const LispImmediate & value)
+		{
+			Object.reset();
+			Variant.reset();
+			Immediate = value;
+			IsImmediate = true;
+		}
+
+		inline void Clear()
+		{
+			Object.reset();
+			Variant.reset();
+			IsImmediate = false;
+		}
+
+		inline std::shared_ptr<object> ToObject()
+		{
+			return Object != null ? Object : std::make_shared<object>(ToVariantRef());
+		}
+
+		inline std::shared_ptr<LispVariant> ToVariant() const
+		{
+			return Object != null ? std::make_shared<LispVariant>(Object) : (IsImmediate ? Immediate.ToLispVariant() : Variant);
+		}
+
+		inline const LispVariant & ToVariantRef()
+		{
+			if (IsImmediate)
+			{
+				// the variant is needed for a not native operation
+				Variant = Immediate.ToLispVariant();
+				IsImmediate = false;
+			}
+			return Object != null ? Object->ToLispVariantRef() : *Variant;
+		}
+
+		inline bool ToImmediate(LispImmediate & value) const
+		{
+			if (IsImmediate)
+			{
+				value = Immediate;
+				return true;
+			}
+			if (Object != null)
+			{
+				return Object->IsLispVariant() && Object->ToLispVariantRef().ToImmediate(value);
+			}
+			return Variant != null && Variant->ToImmediate(value);
+		}
+
+		inline bool BoolValue()
+		{
+			return IsImmediate && Immediate.Type == LispType::_Bool ? Immediate.Value.b : ToVariantRef().BoolValue();
+		}
+
+		inline bool ToBool()
+		{
+			return IsImmediate && Immediate.Type == LispType::_Bool ? Immediate.Value.b : ToVariantRef().ToBool();
+		}
+	};
+
+	// **********************************************************************
+	// The lexical addresses of one execution of a code: the value cells of 
+	// the local slots and the value cells of all other symbols. The cells 
+	// point into the dictionaries of the scopes, the dictionaries stay the 
+	// storage for the variables (needed for eval, macros and the debugger).
+	// The slots of a call without scope point into the slot vector of the 
+	// activation until the scope is created (see LispActivation).
+	// A new symbol in the local or global scope may hide an already resolved 
+	// symbol, a removed symbol invalidates its cell ==> the symbol cells are 
+	// rebound if the local or global scope was changed. The same applies to 
+	// the scopes of the closure chain, which were searched to resolve a cell.
+	struct LispFrame
+	{
+		// the state of a scope of the closure chain with resolved cells
+		struct LispClosureState
+		{
+			LispScope * Scope;
+			size_t Count;
+			size_t RemovedCount;
+		};
+
+		// the local scope, null for a call without scope
+		LispScope * Scope;
+		LispScope * GlobalScope;
+		// the first scope of the closure chain
+		LispScope * ClosureChain;
+		const LispCode * Code;
+		std::vector<std::shared_ptr<object> *> Slots;
+		std::vector<std::shared_ptr<object> *> Cells;
+		std::vector<LispClosureState> Closures;
+		size_t LocalCount;
+		size_t LocalRemovedCount;
+		size_t GlobalCount;
+		size_t GlobalRemovedCount;
+
+		inline LispFrame()
+			: Scope(null), GlobalScope(null), ClosureChain(null), Code(null), 
+			  LocalCount(0), LocalRemovedCount(0), GlobalCount(0), GlobalRemovedCount(0)
+		{
+		}
+
+		inline void Init(const LispCode & code, LispScope * scope, LispScope & globalScope, LispScope * closureChain)
+		{
+			Code = &code;
+			GlobalScope = &globalScope;
+			ClosureChain = closureChain;
+			Slots.assign(code.SlotNames.size(), (std::shared_ptr<object> *)null);
+			Cells.assign(code.Symbols.size(), (std::shared_ptr<object> *)null);
+			Closures.clear();
+			GlobalCount = globalScope.size();
+			GlobalRemovedCount = globalScope.RemovedCount;
+			Bind(scope);
+		}
+
+		inline void Bind(LispScope * scope)
+		{
+			Scope = scope;
+			LocalCount = scope != null ? scope->size() : 0;
+			LocalRemovedCount = scope != null ? scope->RemovedCount : 0;
+		}
+
+		inline bool IsClosureChanged() const
+		{
+			for (const LispClosureState & closure : Closures)
+			{
+				if (closure.Count != closure.Scope->size() || closure.RemovedCount != closure.Scope->RemovedCount)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		inline bool IsLocalChanged() const
+		{
+			return Scope != null && (LocalCount != Scope->size() || LocalRemovedCount != Scope->RemovedCount);
+		}
+
+		inline void Validate()
+		{
+			if (IsLocalChanged() || GlobalCount != GlobalScope->size() || GlobalRemovedCount != GlobalScope->RemovedCount || IsClosureChanged())
+			{
+				if (Scope != null && LocalRemovedCount != Scope->RemovedCount)
+				{
+					std::fill(Slots.begin(), Slots.end(), (std::shared_ptr<object> *)null);
+				}
+				std::fill(Cells.begin(), Cells.end(), (std::shared_ptr<object> *)null);
+				Bind(Scope);
+				GlobalCount = GlobalScope->size();
+				GlobalRemovedCount = GlobalScope->RemovedCount;
+				Closures.clear();
+			}
+		}
+
+		// watches the scopes of the closure chain up to the scope with the resolved cell
+		inline void WatchClosures(LispScope * closureScope)
+		{
+			size_t index = 0;
+			for (LispScope * closure = ClosureChain; closure != null; closure = closure->ClosureChain.get(), index++)
+			{
+				if (index == Closures.size())
+				{
+					Closures.push_back({ closure, closure->size(), closure->RemovedCount });
+				}
+				if (closure == closureScope)
+				{
+					break;
+				}
+			}
+		}
+
+		// the local variable of a call without scope which has the name of the symbol,
+		// the symbol may be compiled before the def of the local variable
+		inline std::shared_ptr<object> * FindSlotOfSymbol(size_t symbol) const
+		{
+			size_t slot = Code->SymbolSlots[symbol];
+			return slot != NoSlot ? Slots[slot] : null;
+		}
+
+		// searches the cell like LispScope::FindCellInScopes, the local scope 
+		// of a call without scope has no other variables than the slots
+		inline std::shared_ptr<object> * FindCellInScopes(size_t symbolId, /*out*/ LispScope ** closureScope)
+		{
+			if (Scope != null)
+			{
+				return Scope->FindCellInScopes(symbolId, closureScope);
+			}
+			*closureScope = null;
+			std::shared_ptr<object> * cell = GlobalScope->FindCell(symbolId);
+			if (cell != null)
+			{
+				COUNT_RUNTIME_STATISTIC(GlobalResolves);
+				return cell;
+			}
+			for (LispScope * closure = ClosureChain; closure != null; closure = closure->ClosureChain.get())
+			{
+				cell = closure->FindCell(symbolId);
+				if (cell != null)
+				{
+					COUNT_RUNTIME_STATISTIC(ClosureResolves);
+					*closureScope = closure;
+					return cell;
+				}
+			}
+			return null;
+		}
+
+		inline std::shared_ptr<object> Resolve(size_t symbol)
+		{
+			if (Scope == null)
+			{
+				std::shared_ptr<object> * local = FindSlotOfSymbol(symbol);
+				if (local != null)
+				{
+					return *local;
+				}
+			}
+			Validate();
+			std::shared_ptr<object> * cell = Cells[symbol];
+			if (cell == null)
+			{
+				LispScope * closureScope;
+				cell = FindCellInScopes(Code->SymbolIds[symbol], /*out*/ &closureScope);
+				if (cell == null)
+				{
+					// symbols of modules are not cached
+					return (Scope != null ? Scope : GlobalScope)->ResolveInScopes(Code->Symbols[symbol], Code->SymbolNames[symbol], false);
+				}
+				if (closureScope != null)
+				{
+					WatchClosures(closureScope);
+				}
+				Cells[symbol] = cell;
+			}
+			return *cell;
+		}
+
+		inline std::shared_ptr<object> * FindLocal(size_t slot)
+		{
+			if (Scope == null)
+			{
+				return Slots[slot];
+			}
+			Validate();
+			std::shared_ptr<object> * cell = Slots[slot];
+			if (cell == null)
+			{
+				auto item = Scope->find(Code->SlotNames[slot]);
+				if (item != Scope->end())
+				{
+					cell = &(item->second);
+					Slots[slot] = cell;
+				}
+			}
+			return cell;
+		}
+
+		inline std::shared_ptr<object> ResolveLocal(size_t symbol, size_t slot)
+		{
+			std::shared_ptr<object> * cell = FindLocal(slot);
+			// not (yet) defined in the local scope ==> resolve in the other scopes
+			return cell != null ? *cell : Resolve(symbol);
+		}
+
+		// searches the cell of a symbol to set in a call without scope (in the same 
+		// order as LispScope::SetInScopes: local scope, closure chain, global scope)
+		inline std::shared_ptr<object> * FindCellToSet(size_t symbol)
+		{
+			std::shared_ptr<object> * cell = FindSlotOfSymbol(symbol);
+			size_t symbolId = Code->SymbolIds[symbol];
+			for (LispScope * closure = ClosureChain; cell == null && closure != null; closure = closure->ClosureChain.get())
+			{
+				cell = closure->FindCell(symbolId);
+			}
+			return cell != null ? cell : GlobalScope->FindCell(symbolId);
+		}
+	};
+
+	// **********************************************************************
+	// One execution of a code: the scope, the lexical addresses, the registers 
+	// and the program counter. The calls of user defined functions with a 
+	// compiled body are executed in a new activation on the activation stack 
+	// of the virtual machine (and not by a recursive call of Execute), a tail 
+	// call replaces the current activation ==> the recursion depth of fuel 
+	// functions is not limited by the native stack and tail recursive 
+	// functions run with constant memory.
+	// A call starts without a scope: the formal arguments and the local 
+	// variables are stored in the slot vector of the activation. The scope 
+	// of the call is created from the slots if it is needed (see Materialize):
+	// for eval, macros, special forms (fn captures the scope in a closure), 
+	// builtin functions, lists evaluated as arguments, the debugger and the 
+	// profiler. The scopes of the calling activations are created too, they 
+	// are the call stack of the scope. Functions which only calculate values 
+	// and call other user defined functions do not create a scope. The 
+	// activations are reused for the following calls.
+	struct LispActivation
+	{
+		std::shared_ptr<LispCode> Code;
+		// the scope of the call, null until it is needed
+		std::shared_ptr<LispScope> Scope;
+		// the called function and the arguments, the scope is created from them
+		std::shared_ptr<object> Function;
+		const LispUserFunction * UserFunction;
+		std::vector<std::shared_ptr<object>> Arguments;
+		// the values of the local slots of a call without scope
+		std::vector<std::shared_ptr<object>> Locals;
+		// the state of the scope of a call without scope
+		std::shared_ptr<LispToken> CurrentToken;
+		bool NeedsLValue;
+		// the previous scope in the call stack of the first activation after a tail call
+		std::shared_ptr<LispScope> PreviousScope;
+		LispFrame Frame;
+		std::vector<LispRegister> Registers;
+		size_t Pc;
+		// register of the calling activation for the result
+		size_t Target;
+
+		inline LispActivation()
+			: UserFunction(null), NeedsLValue(false), Pc(0), Target(0)
+		{
+		}
+
+		// starts the execution of the code in the given scope
+		inline void Start(std::shared_ptr<LispCode> code, std::shared_ptr<LispScope> scope, size_t target)
+		{
+			Code = code;
+			Scope = scope;
+			Frame.Init(*Code, Scope.get(), *Scope->GlobalScope, Scope->ClosureChain.get());
+			Registers.resize(Code->RegisterCount);
+			Pc = 0;
+			Target = target;
+		}
+
+		// starts a call of the compiled body of the user defined function without scope, 
+		// the formal arguments are stored in the first slots
+		inline void StartCall(std::shared_ptr<object> function, const LispUserFunction & userFunction, std::vector<std::shared_ptr<object>> & args, LispScope & globalScope, size_t target)
+		{
+			Code = userFunction.Code;
+			Function = function;
+			UserFunction = &userFunction;
+			NeedsLValue = userFunction.Scope->NeedsLValue;
+
+			// fill all not given arguments with nil (like CreateCallScope)
+			size_t formalArgsCount = userFunction.FormalArgNames.size();
+			while (args.size() < formalArgsCount)
+			{
+				args.push_back(std::make_shared<object>(LispVariant(LispType::_Nil)));
+			}
+			Arguments.swap(args);
+
+			Frame.Init(*Code, null, globalScope, userFunction.Scope.get());
+			if (!Code->NeedsCallScope)
+			{
+				Locals.resize(Code->SlotNames.size());
+				for (size_t i = 0; i < formalArgsCount; i++)
+				{
+					Locals[i] = Arguments[i];
+					Frame.Slots[i] = &Locals[i];
+				}
+			}
+			Registers.resize(Code->RegisterCount);
+			Pc = 0;
+			Target = target;
+		}
+
+		inline bool & NeedsLValueRef()
+		{
+			return Scope != null ? Scope->NeedsLValue : NeedsLValue;
+		}
+
+		inline void SetCurrentToken(const std::shared_ptr<LispToken> & token)
+		{
+			if (Scope != null)
+			{
+				Scope->CurrentToken = token;
+			}
+			else
+			{
+				CurrentToken = token;
+			}
+		}
+
+		// creates the scope of a call without scope, the slots are moved into the scope
+		inline void CreateScope(const std::shared_ptr<LispScope> & previous, const std::shared_ptr<LispScope> & globalScope)
+		{
+			Scope = UserFunction->CreateCallScope(Arguments, globalScope);
+			Scope->NeedsLValue = NeedsLValue;
+			Scope->CurrentToken = CurrentToken;
+			for (size_t slot = 0; slot < Frame.Slots.size(); slot++)
+			{
+				if (Frame.Slots[slot] != null)
+				{
+					std::shared_ptr<object> & cell = Scope->LocalCell(Code->SlotNames[slot]);
+					cell = *(Frame.Slots[slot]);
+					Frame.Slots[slot] = &cell;
+				}
+			}
+			if (previous != null)
+			{
+				previous->PushNextScope(Scope);
+			}
+			Arguments.clear();
+			Locals.clear();
+			CurrentToken.reset();
+			PreviousScope.reset();
+
+			// the local variables may hide resolved symbols
+			std::fill(Frame.Cells.begin(), Frame.Cells.end(), (std::shared_ptr<object> *)null);
+			Frame.Closures.clear();
+			Frame.Bind(Scope.get());
+		}
+
+		// releases the values of the finished execution, the activation is reused for the next call
+		inline void Release()
+		{
+			Code.reset();
+			Scope.reset();
+			Function.reset();
+			UserFunction = null;
+			Arguments.clear();
+			Locals.clear();
+			CurrentToken.reset();
+			PreviousScope.reset();
+			for (LispRegister & reg : Registers)
+			{
+				reg.Clear();
+			}
+		}
+	};
+
+	// returns the scope of the activation at the given index, the scope and the scopes 
+	// of the calling activations (the call stack of the scope) are created if needed
+	static const std::shared_ptr<LispScope> & Materialize(std::vector<std::unique_ptr<LispActivation>> & activations, size_t index, const std::shared_ptr<LispScope> & globalScope)
+	{
+		size_t first = index;
+		while (first > 0 && activations[first]->Scope == null)
+		{
+			first--;
+		}
+		for (size_t i = first; i <= index; i++)
+		{
+			LispActivation & activation = *activations[i];
+			if (activation.Scope == null)
+			{
+				activation.CreateScope(i > 0 ? activations[i - 1]->Scope : activation.PreviousScope, globalScope);
+			}
+		}
+		return activations[index]->Scope;
+	}
+
+	static inline bool IsDebuggingOrTracing(const LispScope & globalScope)
+	{
+#ifndef _DISABLE_DEBUGGER
+		return globalScope.Debugger != null || globalScope.Tracing;
+#else
+		return false;
+#endif
+	}
+
+	static inline bool IsSymbolObject(const std::shared_ptr<object> & elem)
+	{
+		return elem->IsLispVariant() && elem->ToLispVariantRef().IsSymbol();
+	}
+
+	// collects the values of the registers as arguments of a call,
+	// process statemens like this: `,@l  with l = (1 2 3)
+	static void CollectArguments(LispRegister * registers, size_t count, std::vector<std::shared_ptr<object>> & arguments)
+	{
+		arguments.clear();
+		arguments.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			var result = registers[i].ToObject();
+
+			if (result->IsLispVariant())
+			{
+				const LispVariant & variant = result->ToLispVariantRef();
+				if (variant.IsUnQuoted == LispUnQuoteModus::_UnQuoteSplicing && variant.IsList())
+				{
+					var lst = variant.ListValueRef();
+					arguments.resize(arguments.size() + lst.size() - 1);
+					for (var elem : lst)
+					{
+						arguments[i] = elem;
+						i++;
+					}
+
+					break;
+				}
+			}
+
+			arguments[i] = result;
+		}
+	}
+
+	// the arithmetic and compare operations for numbers are executed without a call of the builtin function,
+	// the arithmetic operations with more arguments are evaluated from left to right (like the builtin functions)
+	// (the argument i is converted with toImmediate(i, value))
+	template<class ToImmediate>
+	static bool NativeOperation(const LispFunctionWrapper & functionWrapper, size_t count, ToImmediate toImmediate, LispImmediate & result)
+	{
+		if (functionWrapper.Operator != OperatorNone && count >= 2 && (count == 2 || functionWrapper.Operator <= OperatorModulo))
+		{
+			LispImmediate right;
+			size_t i = 1;
+			if (toImmediate(0, result))
+			{
+				while (i < count && toImmediate(i, right) && 
+					   LispVariant::NativeOperation(functionWrapper.Operator, result, right, result))
+				{
+					i++;
+				}
+			}
+			return i == count;
+		}
+		return false;
+	}
+
+	// the compiled expansion of the macro called at the call site, null if the macro is not evaluated at run time
+	static std::shared_ptr<LispCode> GetMacroCode(const LispCallSite & callSite, const std::shared_ptr<LispScope> & scope)
+	{
+		var macro = LispEnvironment::GetMacro(callSite.Function, scope->GlobalScope);
+		if (macro == null || !macro->IsLispMacroRuntimeEvaluate())
+		{
+			return null;
+		}
+		var expansion = std::atomic_load(&callSite.MacroExpansion);
+		if (expansion == null || expansion->Macro != macro)
+		{
+			// first execution of the call site or the macro was redefined
+			expansion = std::make_shared<LispMacroExpansion>();
+			expansion->Macro = macro;
+			expansion->Code = LispCompiler::Compile(LispInterpreter::ExpandRuntimeMacro(callSite.Ast, macro, scope), scope);
+			std::atomic_store(&callSite.MacroExpansion, expansion);
+		}
+		return expansion->Code;
+	}
+
+	std::shared_ptr<LispVariant> LispVirtualMachine::Execute(std::shared_ptr<LispCode> code, std::shared_ptr<LispScope> scope)
+	{
+		var globalScope = scope->GlobalScope;
+
+		// debugging and tracing is supported by the ast interpreter only
+		if (IsDebuggingOrTracing(*globalScope))
+		{
+			return LispInterpreter::EvalAst(code->Ast, scope);
+		}
+
+		// the activation stack, activations[depth - 1] is the current activation
+		std::vector<std::unique_ptr<LispActivation>> activations;
+		activations.push_back(std::unique_ptr<LispActivation>(new LispActivation()));
+		activations.back()->Start(code, scope, 0);
+		size_t depth = 1;
+		// the state of the current activation
+		LispActivation * activation = activations.back().get();
+		LispFrame * frame = &activation->Frame;
+		LispRegister * registers = activation->Registers.data();
+		const LispInstruction * instructions = code->Instructions.data();
+		size_t pc = 0;
+		// the arguments of the calls, reused to avoid an allocation for each call
+		std::vector<std::shared_ptr<object>> arguments;
+		// the elements of an evaluated list, see OpEvalList
+		std::vector<std::shared_ptr<object>> elements;
+
+		// the scope of the current activation, created if needed
+		var currentScope = [&]() -> const std::shared_ptr<LispScope> &
+		{
+			return activation->Scope != null ? activation->Scope : Materialize(activations, depth - 1, globalScope);
+		};
+
+		for (;;)
+		{
+			const LispInstruction & instruction = instructions[pc++];
+			switch (instruction.OpCode)
+			{
+				case OpConstant:
+					registers[instruction.A].Set(code->Constants[instruction.B]);
+					break;
+
+				case OpValue:
+					registers[instruction.A].Set(code->Constants[instruction.B]->ToLispVariant());
+					break;
+
+				case OpResolve:
+				case OpResolveLocal:
+				{
+					// the value is converted to a variant only if needed
+					var value = instruction.OpCode == OpResolveLocal ? frame->ResolveLocal(instruction.B, instruction.C) : frame->Resolve(instruction.B);
+					if (value->IsLispVariant())
+					{
+						registers[instruction.A].Set(value);
+					}
+					else
+					{
+						registers[instruction.A].Set(std::make_shared<LispVariant>(value));
+					}
+					break;
+				}
+
+				case OpResolveArgument:
+				case OpResolveLocalArgument:
+				{
+					var value = instruction.OpCode == OpResolveLocalArgument ? frame->ResolveLocal(instruction.B, instruction.C) : frame->Resolve(instruction.B);
+					if (value->IsList())
+					{
+						registers[instruction.A].Set(LispInterpreter::EvalAst(value, currentScope()));
+					}
+					else
+					{
+						registers[instruction.A].Set(value);
+					}
+					break;
+				}
+
+				case OpEval:
+					registers[instruction.A].Set(LispInterpreter::EvalAst(code->Constants[instruction.B], currentScope()));
+					break;
+
+				case OpEnter:
+				{
+					const LispCallSite & callSite = code->CallSites[instruction.A];
+					// the function is used via the cached cell, a resolved function is hold in resolvedFunction
+					std::shared_ptr<object> resolvedFunction;
+					const std::shared_ptr<object> * function;
+
+					// inline cache: no symbol was added or removed since the function was resolved at this call site
+					std::shared_ptr<object> * cachedCell = callSite.IsCacheable ? callSite.Cache.Find(globalScope.get(), globalScope->Runtime->GetDefinitionEpoch()) : null;
+					if (cachedCell != null)
+					{
+						COUNT_RUNTIME_STATISTIC(CallSiteCacheHits);
+						function = cachedCell;
+					}
+					else
+					{
+						// is this function a macro ==> execute the compiled expansion of the macro
+						if (callSite.IsSymbol ? LispEnvironment::IsMacro(code->SymbolIds[callSite.Symbol], globalScope) : LispEnvironment::IsMacro(callSite.FunctionName, globalScope))
+						{
+							const std::shared_ptr<LispScope> & scope = currentScope();
+							var macroCode = GetMacroCode(callSite, scope);
+							registers[callSite.Target].Set(macroCode != null ? Execute(macroCode, scope) : LispInterpreter::EvalAst(callSite.Ast, scope));
+							pc = instruction.B;
+							break;
+						}
+
+						resolvedFunction = callSite.IsSymbol ? (callSite.Slot != NoSlot ? frame->ResolveLocal(callSite.Symbol, callSite.Slot) : frame->Resolve(callSite.Symbol)) : callSite.Function;
+						function = &resolvedFunction;
+
+						// only functions of the global scope are cached, they are the same for all executions of the function body
+						if (callSite.IsCacheable)
+						{
+							COUNT_RUNTIME_STATISTIC(CallSiteCacheMisses);
+							size_t symbolId = code->SymbolIds[callSite.Symbol];
+							std::shared_ptr<object> * cell = activation->Scope == null || activation->Scope->FindCell(symbolId) == null ? globalScope->FindCell(symbolId) : null;
+							if (cell != null)
+							{
+								callSite.Cache.Set(cell, globalScope.get(), globalScope->Runtime->GetDefinitionEpoch());
+							}
+						}
+					}
+
+					// for debugging: update the current line number at the current scope
+					if (callSite.Token != null)
+					{
+						activation->SetCurrentToken(callSite.Token);
+					}
+					if (LispProfiler::SampleRequested.load(std::memory_order_relaxed))
+					{
+						LispProfiler::TakeSample(currentScope().get());
+					}
+
+					bool isSpecialForm = false;
+					try
+					{
+						isSpecialForm = (*function)->ToLispVariantRef().FunctionValue().IsSpecialForm();
+					}
+					catch (LispExceptionBase exc)
+					{
+						string name = (*function)->ToString();
+						throw LispException("Function \"" + name + "\" not found", currentScope().get());
+					}
+
+					// special forms are called with the not evaluated arguments
+					if (isSpecialForm)
+					{
+						// hold the function, the special form may change the cell of the function
+						var specialForm = *function;
+						registers[callSite.Target].Set(specialForm->ToLispVariantRef().FunctionValue().Function(callSite.Arguments, currentScope()));
+						pc = instruction.B;
+					}
+					else
+					{
+						registers[callSite.Base].Set(*function);
+					}
+					break;
+				}
+
+				case OpCall:
+				{
+					const LispCallSite & callSite = code->CallSites[instruction.A];
+					const LispFunctionWrapper & functionWrapper = registers[callSite.Base].Object->ToLispVariantRef().FunctionValue();
+
+					LispImmediate result;
+					LispRegister * argumentRegisters = registers + callSite.Base + 1;
+					if (NativeOperation(functionWrapper, callSite.ArgumentCount, [argumentRegisters](size_t i, LispImmediate & value) -> bool { return argumentRegisters[i].ToImmediate(value); }, result))
+					{
+						registers[callSite.Target].Set(result);
+						break;
+					}
+
+					// hold the function, the registers may be changed while the function is called 
+					var function = registers[callSite.Base].Object;
+
+					CollectArguments(registers + callSite.Base + 1, callSite.ArgumentCount, arguments);
+
+					var userFunction = functionWrapper.UserFunction.get();
+					if (userFunction == null || userFunction->Code == null || IsDebuggingOrTracing(*globalScope))
+					{
+						registers[callSite.Target].Set(functionWrapper.Function(arguments, currentScope()));
+						arguments.clear();
+						break;
+					}
+
+					// call the compiled body of a user defined function in a new activation (without scope)
+					COUNT_RUNTIME_STATISTIC(FunctionCalls);
+					if (instruction.B != 0)
+					{
+						// tail call: the called function replaces the current function in the call stack
+						size_t target = activation->Target;
+						var previous = activation->PreviousScope;
+						if (activation->Scope != null)
+						{
+							previous = activation->Scope->Previous;
+							activation->Scope->Previous = null;
+						}
+						activation->Release();
+						activation->StartCall(function, *userFunction, arguments, *globalScope, target);
+						if (depth == 1)
+						{
+							activation->PreviousScope = previous;
+						}
+					}
+					else
+					{
+						activation->Pc = pc;
+						if (depth == activations.size())
+						{
+							activations.push_back(std::unique_ptr<LispActivation>(new LispActivation()));
+						}
+						activation = activations[depth++].get();
+						activation->StartCall(function, *userFunction, arguments, *globalScope, callSite.Target);
+					}
+					arguments.clear();
+					if (activation->Code->NeedsCallScope)
+					{
+						Materialize(activations, depth - 1, globalScope);
+					}
+					code = activation->Code;
+					frame = &activation->Frame;
+					registers = activation->Registers.data();
+					instructions = code->Instructions.data();
+					pc = 0;
+					break;
+				}
+
+				case OpDefine:
+				{
+					var value = registers[instruction.A].ToVariant();
+					var ret = std::make_shared<object>(*value);
+					(*(instruction.C != 0 ? globalScope : currentScope()))[code->SymbolNames[instruction.B]] = ret;
+					registers[instruction.A].Set(std::make_shared<LispVariant>(ret));
+					break;
+				}
+
+				case OpDefineLocal:
+				{
+					var value = registers[instruction.A].ToVariant();
+					var ret = std::make_shared<object>(*value);
+					std::shared_ptr<object> * cell = frame->FindLocal(instruction.C);
+					if (cell != null)
+					{
+						*cell = ret;
+					}
+					else if (activation->Scope == null)
+					{
+						activation->Locals[instruction.C] = ret;
+						frame->Slots[instruction.C] = &activation->Locals[instruction.C];
+					}
+					else
+					{
+						std::shared_ptr<object> & newCell = activation->Scope->LocalCell(code->SymbolNames[instruction.B], code->SymbolIds[instruction.B]);
+						newCell = ret;
+						frame->Slots[instruction.C] = &newCell;
+					}
+					registers[instruction.A].Set(std::make_shared<LispVariant>(ret));
+					break;
+				}
+
+				case OpSetf:
+				case OpSetfLocal:
+				{
+					std::shared_ptr<object> * cell = instruction.OpCode == OpSetfLocal ? frame->FindLocal(instruction.C) : null;
+					if (cell == null && activation->Scope == null)
+					{
+						cell = frame->FindCellToSet(instruction.B);
+					}
+					if (cell != null && registers[instruction.A].IsImmediate)
+					{
+						// the result of a native operation is stored without a temporary variant
+						*cell = registers[instruction.A].Immediate.ToObject();
+						break;
+					}
+					var value = registers[instruction.A].ToVariant();
+					if (cell != null)
+					{
+						*cell = std::make_shared<object>(*value);
+					}
+					else
+					{
+						// reports an unknown symbol
+						currentScope()->SetInScopes(code->SymbolNames[instruction.B], std::make_shared<object>(*value));
+					}
+					registers[instruction.A].Set(value);
+					break;
+				}
+
+				case OpJump:
+					pc = instruction.A;
+					break;
+
+				case OpJumpIfFalse:
+					if (!registers[instruction.A].BoolValue())
+					{
+						pc = instruction.B;
+					}
+					break;
+
+				case OpJumpIfNotTrue:
+					if (!registers[instruction.A].ToBool())
+					{
+						pc = instruction.B;
+					}
+					break;
+
+				case OpJumpIfReturn:
+					// return is a builtin function, which needs the scope
+					if (activation->Scope != null && activation->Scope->IsInReturn)
+					{
+						pc = instruction.A;
+					}
+					break;
+
+				case OpCheckBool:
+					registers[instruction.A].BoolValue();
+					break;
+
+				case OpBool:
+					registers[instruction.A].Set(std::make_shared<LispVariant>(instruction.B != 0));
+					break;
+
+				case OpUndefined:
+					registers[instruction.A].Set(std::make_shared<LispVariant>(LispType::_Undefined));
+					break;
+
+				case OpNull:
+					registers[instruction.A].Set(std::shared_ptr<LispVariant>());
+					break;
+
+				case OpToken:
+					activation->SetCurrentToken(code->Tokens[instruction.A]);
+					break;
+
+				case OpReturn:
+				{
+					var result = registers[instruction.A].ToVariant();
+					if (depth == 1)
+					{
+						return result;
+					}
+
+					// return to the calling activation
+					size_t target = activation->Target;
+					activation->Release();
+					depth--;
+					activation = activations[depth - 1].get();
+					code = activation->Code;
+					frame = &activation->Frame;
+					registers = activation->Registers.data();
+					instructions = code->Instructions.data();
+					pc = activation->Pc;
+					if (activation->Scope != null && activation->Scope->Next != null)
+					{
+						activation->Scope->PopNextScope();
+					}
+					registers[target].Set(result);
+					break;
+				}
+
+				case OpQuote:
+					registers[instruction.A].Set(std::make_shared<LispVariant>(std::make_shared<object>(*(code->Constants[instruction.B]))));
+					break;
+
+				case OpEvalValue:
+				{
+					// like eval: a list is evaluated as call, a symbol is resolved
+					const std::shared_ptr<LispScope> & scope = currentScope();
+					const LispVariant & variant = registers[instruction.A].ToVariantRef();
+					if (variant.IsList())
+					{
+						registers[instruction.A].Set(LispInterpreter::EvalAst(std::make_shared<object>(variant.ListValueRef()), scope));
+					}
+					else if (variant.IsSymbol())
+					{
+						var value = scope->ResolveInScopes(registers[instruction.A].ToObject(), false);
+						if (value->IsLispVariant())
+						{
+							registers[instruction.A].Set(value);
+						}
+						else
+						{
+							registers[instruction.A].Set(std::make_shared<LispVariant>(value));
+						}
+					}
+					// the value of all other atoms is the atom itself
+					break;
+				}
+
+				case OpEvalList:
+				{
+					// evaluates the list like the ast interpreter does, but without creating the list
+					const std::shared_ptr<LispScope> & scope = currentScope();
+					CollectArguments(registers + instruction.B, instruction.C, elements);
+					if (elements.empty())
+					{
+						registers[instruction.A].Set(std::make_shared<LispVariant>(LispVariant(LispType::_Nil)));
+						break;
+					}
+
+					// macros, special forms, debugging and tracing are handled by the ast interpreter
+					std::shared_ptr<object> function = elements[0];
+					// (a function value is not the name of a macro, its name is the signature of the function)
+					bool useInterpreter = IsDebuggingOrTracing(*globalScope) || 
+						(!(function->IsLispVariant() && function->ToLispVariantRef().IsFunction()) && LispEnvironment::IsMacro(function, globalScope));
+					if (!useInterpreter)
+					{
+						// for debugging: update the current line number at the current scope
+						var currentToken = function->ToLispVariantRef().Token;
+						if (currentToken != null)
+						{
+							activation->SetCurrentToken(currentToken);
+						}
+						if (LispProfiler::SampleRequested.load(std::memory_order_relaxed))
+						{
+							LispProfiler::TakeSample(scope.get());
+						}
+
+						if (IsSymbolObject(function))
+						{
+							function = scope->ResolveInScopes(function, true);
+						}
+						try
+						{
+							useInterpreter = function->ToLispVariantRef().FunctionValue().IsSpecialForm();
+						}
+						catch (LispExceptionBase exc)
+						{
+							throw LispException("Function \"" + function->ToString() + "\" not found", scope.get());
+						}
+					}
+					if (useInterpreter)
+					{
+						IEnumerable<std::shared_ptr<object>> list;
+						list.swap(elements);
+						registers[instruction.A].Set(LispInterpreter::EvalAst(std::make_shared<object>(list), scope));
+						break;
+					}
+
+					// resolve values via local and global scope first, then evaluate the lists
+					for (size_t i = 1; i < elements.size(); i++)
+					{
+						if (IsSymbolObject(elements[i]))
+						{
+							elements[i] = scope->ResolveInScopes(elements[i], false);
+						}
+					}
+					const LispFunctionWrapper & functionWrapper = function->ToLispVariantRef().FunctionValue();
+					arguments.clear();
+					arguments.resize(elements.size() - 1);
+					for (size_t i = 1; i < elements.size(); i++)
+					{
+						var result = elements[i]->IsList() ? std::make_shared<object>(*LispInterpreter::EvalAst(elements[i], scope)) : elements[i];
+
+						// process statemens like this: `,@l  with l = (1 2 3)
+						if (result->IsLispVariant())
+						{
+							const LispVariant & variant = result->ToLispVariantRef();
+							if (variant.IsUnQuoted == LispUnQuoteModus::_UnQuoteSplicing && variant.IsList())
+							{
+								var lst = variant.ListValueRef();
+								arguments.resize(arguments.size() + lst.size() - 1);
+								for (var elem : lst)
+								{
+									arguments[i - 1] = elem;
+									i++;
+								}
+
+								break;
+							}
+						}
+
+						arguments[i - 1] = result;
+					}
+					elements.clear();
+
+					LispImmediate result;
+					const std::vector<std::shared_ptr<object>> & values = arguments;
+					if (NativeOperation(functionWrapper, values.size(), [&values](size_t i, LispImmediate & value) -> bool { return values[i]->IsLispVariant() && values[i]->ToLispVariantRef().ToImmediate(value); }, result))
+					{
+						registers[instruction.A].Set(result);
+					}
+					else
+					{
+						registers[instruction.A].Set(functionWrapper.Function(arguments, scope));
+					}
+					arguments.clear();
+					break;
+				}
+
+				case OpNeedsLValue:
+				{
+					bool & needsLValue = activation->NeedsLValueRef();
+					LispImmediate value;
+					value.Type = LispType::_Bool;
+					value.Value.b = needsLValue;
+					registers[instruction.A].Set(value);
+					needsLValue = instruction.B != 0;
+					break;
+				}
+
+				case OpRestoreLValue:
+					activation->NeedsLValueRef() = registers[instruction.A].Immediate.Value.b;
+					break;
+
+				case OpSetfValue:
+				{
+					// like setf: an lvalue is set with its setter, otherwise the symbol is set in the scopes
+					const LispVariant & symbol = registers[instruction.B].ToVariantRef();
+					std::shared_ptr<object> * cell = !symbol.IsLValue() && symbol.IsSymbol() ? currentScope()->FindCellToSet(symbol.SymbolId()) : null;
+					if (cell != null && registers[instruction.A].IsImmediate)
+					{
+						// the result of a native operation is stored without a temporary variant
+						*cell = registers[instruction.A].Immediate.ToObject();
+						break;
+					}
+					var value = registers[instruction.A].ToVariant();
+					if (cell != null)
+					{
+						*cell = std::make_shared<object>(*value);
+					}
+					else if (symbol.IsLValue())
+					{
+						std::function<void(std::shared_ptr<object>)> action = symbol.Value->ToSetterAction();
+						action(std::make_shared<object>(*value));
+					}
+					else
+					{
+						// reports an unknown symbol
+						currentScope()->SetInScopes(symbol.ToString(), std::make_shared<object>(*value));
+					}
+					registers[instruction.A].Set(value);
+					break;
+				}
+
+				case OpElement:
+					// like first and nth: the element of the list, an lvalue is created by the function
+					if (!activation->NeedsLValueRef())
+					{
+						registers[instruction.A].Set(code->Constants[instruction.B]);
+						pc = instruction.C;
+					}
+					break;
+
+				default:
+					throw LispExceptionBase("Unexpected byte code!");
+			}
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/*
+* FUEL(isp) is a fast usable embeddable lisp interpreter.
+*
+* Copyright (c) 2016 Michael Neuroth
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* */
+
+#ifndef _LISP_VIRTUALMACHINE_H
+#define _LISP_VIRTUALMACHINE_H
+
+#include "cstypes.h"
+#include "Compiler.h"
+
+namespace CppLisp
+{
+	/// <summary>
+	/// The FUEL virtual machine.
+	/// Executes the byte code created by the <see cref="LispCompiler"/>.
+	/// </summary>
+	/*public*/ class DLLEXPORT LispVirtualMachine
+	{
+	public:
+		//#region public methods
+
+		/// <summary>
+		/// Executes the given code in the given scope.
+		/// If the debugger or tracing is active the ast of the code
+		/// is evaluated by the <see cref="LispInterpreter"/>.
+		/// </summary>
+		/// <param name="code">The compiled code.</param>
+		/// <param name="scope">The scope.</param>
+		/// <returns>The result of the code execution.</returns>
+		/*public*/ static std::shared_ptr<LispVariant> Execute(std::shared_ptr<LispCode> code, std::shared_ptr<LispScope> scope);
+
+		//#endregion
+	};
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include "csobject.h"
 #include "Exception.h"
 #include "Variant.h"
+#include "Dictionary.h"
 #include "Scope.h"
 #include "Token.h"
 
@@ -34,52 +35,75 @@ namespace CppLisp
 	object::object(const LispVariant & value)
 		: m_Type(ObjectType::__LispVariant)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		m_Data.pVariant = new LispVariant(value);
 	}
 
 	object::object(const IEnumerable<std::shared_ptr<object>> & value)
 		: m_Type(ObjectType::__List)
 	{
-		m_Data.pList = new IEnumerable<std::shared_ptr<object>>(value);
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+		m_Data.pList = SetSharedData(std::make_shared<LispList>(value));
+	}
+
+	object::object(std::shared_ptr<IEnumerable<std::shared_ptr<object>>> value)
+		: m_Type(ObjectType::__List)
+	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+		m_Data.pList = SetSharedData(std::make_shared<LispList>(*value));
+	}
+
+	object::object(const LispList & value)
+		: m_Type(ObjectType::__List)
+	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+		m_Data.pList = SetSharedData(std::make_shared<LispList>(value));
 	}
 
 	object::object(const LispFunctionWrapper & value)
 		: m_Type(ObjectType::__LispFunctionWrapper)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		m_Data.pFunctionWrapper = new LispFunctionWrapper(value);
 	}
 
 	object::object(const LispMacroRuntimeEvaluate & value)
 		: m_Type(ObjectType::__LispMacroRuntimeEvaluate)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		m_Data.pMacro = new LispMacroRuntimeEvaluate(value);
 	}
 
 	object::object(const LispMacroCompileTimeExpand & value)
 		: m_Type(ObjectType::__LispMacroCompileTimeExpand)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		m_Data.pCompileMacro = new LispMacroCompileTimeExpand(value);
 	}
 
 	object::object(const LispScope & value)
 		: m_Type(ObjectType::__LispScope)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		m_Data.pScope = new LispScope(value);
 	}
 
 	object::object(std::function<void(std::shared_ptr<object>)> action)
 		: m_Type(ObjectType::__LValue)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		m_Data.pAction = new std::function<void(std::shared_ptr<object>)>(action);
 	}
 
 	object::object(const object & other)
 	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+		COUNT_RUNTIME_STATISTIC(ObjectCopies);
 		m_Type = other.m_Type;
 
 		if (other.IsLispVariant())
 		{
-			m_Data.pVariant = new LispVariant(*(other.ToLispVariant()));
+			m_Data.pVariant = new LispVariant(other.ToLispVariantRef());
 		}
 		else if (other.IsLispScope())
 		{
@@ -93,9 +117,11 @@ namespace CppLisp
 		{
 			m_Data.pToken = new LispToken(*(other.ToLispToken()));
 		}
-		else if (other.IsList())
+		else if (other.IsList() || other.IsString() || other.IsDictionary() || other.IsSortedDictionary())
 		{
-			m_Data.pList = new IEnumerable<std::shared_ptr<object>>(*(other.ToList()));
+			// share the payload, it will be copied before the first modification
+			m_Data = other.m_Data;
+			m_SharedData = other.m_SharedData;
 		}
 		else if (IsLispMacroRuntimeEvaluate())
 		{
@@ -109,24 +135,24 @@ namespace CppLisp
 		{
 			m_Data.pAction = new std::function<void(std::shared_ptr<object>)>(*(other.m_Data.pAction));
 		}
-		else if (other.IsString())
-		{
-			m_Data.pString = new string(other.ToString());
-		}
-		else if (other.IsDictionary())
-		{
-			m_Data.pDictionary = new Dictionary<LispVariant, std::shared_ptr<object>>(other.ToDictionary());
-		}
 		else
 		{
 			m_Data = other.m_Data;
 		}
 	}
 
-	object::object(const Dictionary<LispVariant, std::shared_ptr<object>> & value)
+	object::object(const LispDictionary & value)
 		: m_Type(ObjectType::__Dictionary)
 	{
-		m_Data.pDictionary = new Dictionary<LispVariant, std::shared_ptr<object>>(value);
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+		m_Data.pDictionary = SetSharedData(std::make_shared<LispDictionary>(value));
+	}
+
+	object::object(const LispSortedDictionary & value)
+		: m_Type(ObjectType::__SortedDictionary)
+	{
+		COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+		m_Data.pSortedDictionary = SetSharedData(std::make_shared<LispSortedDictionary>(value));
 	}
 
 	object::~object()
@@ -205,10 +231,6 @@ namespace CppLisp
 		{
 			delete m_Data.pToken;
 		}
-		else if (IsList())
-		{
-			delete m_Data.pList;
-		}
 		else if (IsLispMacroRuntimeEvaluate())
 		{
 			delete m_Data.pMacro;
@@ -221,13 +243,29 @@ namespace CppLisp
 		{
 			delete m_Data.pAction;
 		}
-		else if (IsString())
-		{
-			delete m_Data.pString;
-		}
-		else if (IsDictionary())
+		// string, list and dictionary payloads are released by m_SharedData
+	}
+
+	void object::MakeUnique()
+	{
+		// copy on write: detach a payload which is shared with other objects before modifying it
+		if (m_SharedData.use_count() > 1)
 		{
-			delete m_Data.pDictionary;
+			if (IsList())
+			{
+				// the copy shares the elements, they are copied by LispList::MutableElements()
+				m_Data.pList = SetSharedData(std::make_shared<LispList>(*(m_Data.pList)));
+			}
+			else if (IsDictionary())
+			{
+				COUNT_RUNTIME_STATISTIC(PayloadCopies);
+				m_Data.pDictionary = SetSharedData(std::make_shared<LispDictionary>(*(m_Data.pDictionary)));
+			}
+			else if (IsSortedDictionary())
+			{
+				COUNT_RUNTIME_STATISTIC(PayloadCopies);
+				m_Data.pSortedDictionary = SetSharedData(std::make_shared<LispSortedDictionary>(*(m_Data.pSortedDictionary)));
+			}
 		}
 	}
 
@@ -341,7 +379,7 @@ namespace CppLisp
 					string result;
 					if (IsList())
 					{
-						for (var elem : *(m_Data.pList))
+						for (var elem : m_Data.pList->Elements())
 						{
 							if (result.size() > 0)
 							{
@@ -361,6 +399,8 @@ namespace CppLisp
 				//__Array = 10,
 			case __Dictionary:
 				return "Dictionary";
+			case __SortedDictionary:
+				return "SortedDictionary";
 			case __LispVariant:
 				return m_Data.pVariant->ToString();
 			case __LispFunctionWrapper:
@@ -380,16 +420,33 @@ namespace CppLisp
 		}
 	}
 
-	Dictionary<LispVariant, std::shared_ptr<object>> & object::ToDictionary()
+	LispDictionary & object::ToDictionary()
+	{
+		MakeUnique();
+		return *(m_Data.pDictionary);
+	}
+
+	const LispDictionary & object::ToDictionary() const
 	{
 		return *(m_Data.pDictionary);
 	}
 
-	const Dictionary<LispVariant, std::shared_ptr<object>> & object::ToDictionary() const
+	const LispDictionary & object::ToDictionaryRef() const
 	{
 		return *(m_Data.pDictionary);
 	}
 
+	LispSortedDictionary & object::ToSortedDictionary()
+	{
+		MakeUnique();
+		return *(m_Data.pSortedDictionary);
+	}
+
+	const LispSortedDictionary & object::ToSortedDictionaryRef() const
+	{
+		return *(m_Data.pSortedDictionary);
+	}
+
 	std::shared_ptr<LispToken> object::ToLispToken() const
 	{
 		if (IsLispToken())
@@ -448,17 +505,34 @@ namespace CppLisp
 		if (IsList())
 		{
 			// return a reference
-			return *(m_Data.pList);
+			return m_Data.pList->Elements();
 		}
 		return g_EmptyList;
 	}
 
+	LispList g_EmptyLispList;
+
+	const LispList & object::ToLispListRef() const
+	{
+		if (IsList())
+		{
+			return *(m_Data.pList);
+		}
+		return g_EmptyLispList;
+	}
+
+	LispList & object::ToLispListNotConstRef()
+	{
+		MakeUnique();
+		return *(m_Data.pList);
+	}
+
 	std::shared_ptr<IEnumerable<std::shared_ptr<object>>> object::ToList() const
 	{
 		if (IsList())
 		{
 			// return a copy 
-			return std::make_shared<IEnumerable<std::shared_ptr<object>>>(*(m_Data.pList));
+			return std::make_shared<IEnumerable<std::shared_ptr<object>>>(m_Data.pList->Elements());
 		}
 		return null;
 	}
@@ -505,12 +579,13 @@ namespace CppLisp
 
 	const IEnumerable<std::shared_ptr<object>> & object::ToEnumerableOfObjectRef() const
 	{
-		return *(m_Data.pList); // IEnumerable<std::shared_ptr<object>>(*(m_Data.pList));
+		return m_Data.pList->Elements(); // IEnumerable<std::shared_ptr<object>>(*(m_Data.pList));
 	}
 
 	IEnumerable<std::shared_ptr<object>> & object::ToEnumerableOfObjectNotConstRef()
 	{
-		return *(m_Data.pList); // IEnumerable<std::shared_ptr<object>>(*(m_Data.pList));
+		MakeUnique();
+		return m_Data.pList->MutableElements(); // IEnumerable<std::shared_ptr<object>>(*(m_Data.pList));
 	}
 
 	bool object::Equals(const object & other) const
@@ -27,6 +27,8 @@
 #define _CSOBJECT_H
 
 #include "cstypes.h"
+#include "List.h"
+#include "RuntimeStatistics.h"
 
 #if defined( __PIC32MX__ )
 namespace std
@@ -55,6 +57,12 @@ namespace CppLisp
 	struct LispFunctionWrapper;
 	class LispMacroRuntimeEvaluate;
 	class LispMacroCompileTimeExpand;
+	class LispDictionary;
+
+	/// <summary>
+	/// The dictionary of the fuel sorted dict objects, ordered by the keys.
+	/// </summary>
+	typedef Dictionary<LispVariant, std::shared_ptr<object>> LispSortedDictionary;
 
     /// <summary>
     /// Lisp data types.
@@ -97,6 +105,7 @@ namespace CppLisp
 		__LispScope = 16,
 		__LValue = 17,
 		__Dictionary = 18,
+		__SortedDictionary = 19,
 		__LispMacroRuntimeEvaluate = 100,
 		__LispMacroCompileTimeExpand = 101,
         __Error = 999
@@ -118,16 +127,29 @@ namespace CppLisp
 			LispVariant * pVariant;
 			LispScope * pScope;
 			LispToken * pToken;
-			IEnumerable<std::shared_ptr<object>> * pList;
+			LispList * pList;
 			LispFunctionWrapper * pFunctionWrapper;
 			LispMacroRuntimeEvaluate * pMacro;
 			LispMacroCompileTimeExpand * pCompileMacro;
 			std::function<void(std::shared_ptr<object>)> * pAction;
-			Dictionary<LispVariant, std::shared_ptr<object>> * pDictionary;
+			LispDictionary * pDictionary;
+			LispSortedDictionary * pSortedDictionary;
 		} m_Data;
 
+		// owner of the string, list and dictionary payloads,
+		// these payloads are shared between copies of an object (copy on write)
+		std::shared_ptr<void> m_SharedData;
+
 		void CleanUpMemory();
 
+		template<class T> T * SetSharedData(std::shared_ptr<T> value)
+		{
+			m_SharedData = value;
+			return value.get();
+		}
+
+		void MakeUnique();
+
 		// disable assignment operator
 		object & operator=(const object & other);
 
@@ -135,6 +157,7 @@ namespace CppLisp
 		explicit object()
 			: m_Type(ObjectType::__Undefined)
 		{
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 		}
 
 		/*explicit*/ object(const object & other);
@@ -142,35 +165,52 @@ namespace CppLisp
 		explicit object(const std::string & text)
 			: m_Type(ObjectType::__String)
         {
-			m_Data.pString = new std::string(text);
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+			m_Data.pString = SetSharedData(std::make_shared<std::string>(text));
         }
 
 		explicit object(const char * text)
 			: m_Type(ObjectType::__String)
 		{
-			m_Data.pString = new std::string(text);
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+			m_Data.pString = SetSharedData(std::make_shared<std::string>(text));
+		}
+
+		explicit object(const char * text, size_t length)
+			: m_Type(ObjectType::__String)
+		{
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
+			m_Data.pString = SetSharedData(std::make_shared<std::string>(text, length));
 		}
 
 		explicit object(bool value)
 			: m_Type(ObjectType::__Bool)
         {
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 			m_Data.b = value;
         }
         
 		explicit object(int value)
 			: m_Type(ObjectType::__Int)
         {
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 			m_Data.i = value;
 		}
 
 		explicit object(double value)
 			: m_Type(ObjectType::__Double)
         {
+			COUNT_RUNTIME_STATISTIC(ObjectAllocations);
 			m_Data.d = value;
 		}
 
 		explicit object(const IEnumerable<std::shared_ptr<object>> & value);
 
+		// takes a shared list payload without copying it
+		explicit object(std::shared_ptr<IEnumerable<std::shared_ptr<object>>> value);
+
+		explicit object(const LispList & value);
+
 		explicit object(const LispFunctionWrapper & value);
 
 		explicit object(const LispVariant & value);
@@ -183,7 +223,9 @@ namespace CppLisp
 
 		explicit object(std::function<void(std::shared_ptr<object>)> action);
 
-		explicit object(const Dictionary<LispVariant, std::shared_ptr<object>> & value);
+		explicit object(const LispDictionary & value);
+
+		explicit object(const LispSortedDictionary & value);
 
 		~object();
 
@@ -249,6 +291,11 @@ namespace CppLisp
 			return m_Type == ObjectType::__Dictionary;
 		}
 
+		inline bool IsSortedDictionary() const
+		{
+			return m_Type == ObjectType::__SortedDictionary;
+		}
+
 		inline bool IsLispVariant() const
 		{
 			return m_Type == ObjectType::__LispVariant;
@@ -316,14 +363,19 @@ namespace CppLisp
 		LispVariant & ToLispVariantNotConstRef();
 		std::shared_ptr<LispVariant> ToLispVariant() const;
 		const IEnumerable<std::shared_ptr<object>> & ToListRef() const;
+		const LispList & ToLispListRef() const;
+		LispList & ToLispListNotConstRef();
 		std::shared_ptr<IEnumerable<std::shared_ptr<object>>> ToList() const;
 		std::shared_ptr<LispToken> ToLispToken() const;
 		std::shared_ptr<LispMacroRuntimeEvaluate> ToLispMacroRuntimeEvaluate() const;
 		std::shared_ptr<LispMacroCompileTimeExpand> ToLispMacroCompileTimeExpand() const;
 		std::function<void(std::shared_ptr<object>)> ToSetterAction() const;
 		string ToString() const;
-		Dictionary<LispVariant, std::shared_ptr<object>> & ToDictionary();
-		const Dictionary<LispVariant, std::shared_ptr<object>> & ToDictionary() const;
+		LispDictionary & ToDictionary();
+		const LispDictionary & ToDictionary() const;
+		const LispDictionary & ToDictionaryRef() const;
+		LispSortedDictionary & ToSortedDictionary();
+		const LispSortedDictionary & ToSortedDictionaryRef() const;
 	};
 }
 
@@ -42,6 +42,11 @@ namespace CppLisp
 	{
 	}
 
+	string::string(const char * txt, size_t length)
+		: std::string(txt, length)
+	{
+	}
+
 	string::string(char ch)
 	{
 		*this += ch;
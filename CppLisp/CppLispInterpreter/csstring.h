@@ -118,6 +118,7 @@ namespace CppLisp
 	public:
 		string();
 		string(const char * txt);
+		string(const char * txt, size_t length);
         string(char ch);
         string(const string & txt);
 		string(const std::string & txt);
@@ -194,4 +195,15 @@ namespace CppLisp
 	};
 }
 
+namespace std
+{
+	template <> struct hash<CppLisp::string>
+	{
+		size_t operator()(const CppLisp::string & txt) const
+		{
+			return hash<std::string>()(txt);
+		}
+	};
+}
+
 #endif
@@ -26,11 +26,16 @@
 #include "cstypes.h"
 
 #include <iostream>
+#include <mutex>
 
 namespace CppLisp
 {
+	// the output of scripts running in parallel (pmap) is written line by line
+	static std::mutex g_WriterLock;
+
 	void TextWriter::Write(const string & txt)
 	{
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += txt;
@@ -40,6 +45,7 @@ namespace CppLisp
 
 	void TextWriter::WriteLine()
 	{
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += "\n";
@@ -49,6 +55,7 @@ namespace CppLisp
 
 	void TextWriter::WriteLine(const string & txt)
 	{
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += txt + "\n";
@@ -59,6 +66,7 @@ namespace CppLisp
 	void TextWriter::WriteLine(const string & txt, const string & txt1)
 	{
 		string temp = string::Format(txt, txt1);
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += temp + "\n";
@@ -69,6 +77,7 @@ namespace CppLisp
 	void TextWriter::WriteLine(const string & txt, const string & txt1, const string & txt2)
 	{
 		string temp = string::Format(txt, txt1, txt2);
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += temp + "\n";
@@ -79,6 +88,7 @@ namespace CppLisp
 	void TextWriter::WriteLine(const string & txt, const string & txt1, const string & txt2, const string & txt3)
 	{
 		string temp = string::Format(txt, txt1, txt2, txt3);
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += temp + "\n";
@@ -89,6 +99,7 @@ namespace CppLisp
 	void TextWriter::WriteLine(const string & txt, const string & txt1, const string & txt2, const string & txt3, const string & txt4)
 	{
 		string temp = string::Format(txt, txt1, txt2, txt3, txt4);
+		std::lock_guard<std::mutex> guard(g_WriterLock);
 		if (m_bToString)
 		{
 			m_sText += temp + "\n";
@@ -137,6 +148,15 @@ namespace CppLisp
 		return input;
 	}
 
+	bool TextReader::EndOfStream() const
+	{
+		if (m_bFromString)
+		{
+			return m_aCurrentPos == m_aAllLines.end();
+		}
+		return !std::cin.good();
+	}
+
 	string LispFunctionWrapper::GetFormatedDoc() const
 	{
 		const string separator = "\n\n";
@@ -29,13 +29,30 @@
 #include "csstring.h"
 
 #include <vector>
+#include <deque>
+#include <new>
 #include <map>
+#include <algorithm>
+#include <cstdint>
 #include <tuple>
 #include <functional>
 #include <memory>
 
 #define ENABLE_COMPILE_TIME_MACROS
 
+// count the work of the interpreter core, see LispRuntimeStatistics
+#ifndef _DISABLE_RUNTIME_STATISTICS
+#define ENABLE_RUNTIME_STATISTICS
+#endif
+
+// thread local variables of the interpreter library which are accessed very often (i. e. the runtime statistics)
+// use the initial exec model, so an access does not call __tls_get_addr in a shared library
+#if defined(__GNUC__) && !defined(_WIN32)
+#define FAST_THREAD_LOCAL __attribute__((tls_model("initial-exec")))
+#else
+#define FAST_THREAD_LOCAL
+#endif
+
 #define var auto
 
 #define null 0
@@ -45,6 +62,7 @@ namespace CppLisp
 	class LispToken;
 	class LispScope;
 	class LispVariant;
+	class LispUserFunction;
 	class object;
 
 	typedef std::function<void()> Action;
@@ -66,6 +84,12 @@ namespace CppLisp
 		{
 		}
 
+		template <class Iterator>
+		IEnumerable(Iterator first, Iterator last)
+			: std::vector<T>(first, last)
+		{
+		}
+
 		inline size_t Count() const
 		{
 			return std::vector<T>::size();
@@ -115,26 +139,17 @@ namespace CppLisp
 			std::vector<T>::insert(this->begin() + index, elem);
 		}
 
-		IEnumerable<T> Skip(int skipNoOfElements)
+		IEnumerable<T> Skip(size_t skipNoOfElements) const
 		{
-			IEnumerable<T> temp(*this);
-			for (int i = 0; i < skipNoOfElements; i++)
-			{
-				temp.erase(temp.begin());
-			}
-			return temp;
+			size_t count = skipNoOfElements < this->size() ? skipNoOfElements : this->size();
+			return IEnumerable<T>(this->begin() + count, this->end());
 		}
 
-		void RemoveAt(int index)
+		void RemoveAt(size_t index)
 		{
-			typename IEnumerable<T>::iterator iter = std::vector<T>::begin();
-			for (int i = 0; i < index; i++)
-			{
-				++iter;
-			}
-			if (iter != std::vector<T>::end())
+			if (index < this->size())
 			{
-				std::vector<T>::erase(iter);
+				std::vector<T>::erase(this->begin() + index);
 			}
 		}
 
@@ -228,6 +243,339 @@ namespace CppLisp
 		}
 	};
 
+	// **********************************************************************
+	// Open addressing hash table with the methods of the Dictionary class.
+	// The slots are a flat array with linear probing, every slot holds the 
+	// mixed hash of its key, so probing compares keys only if the hash matches
+	// and growing the table does not need to hash the keys again.
+	// The items are stored in a deque and never move, references and pointers 
+	// to the values stay valid until the item is removed.
+	// Iterating visits the items in insertion order, but a new item reuses the 
+	// place of a removed item. GetKeys() returns the keys sorted.
+	template <class K, class V, class Hasher = std::hash<K>, class KeyEqual = std::equal_to<K>>
+	class HashDictionary
+	{
+	public:
+		typedef std::pair<K, V> value_type;
+
+	private:
+		struct Entry
+		{
+			value_type Item;
+			uint32_t Hash;
+			bool IsUsed;
+		};
+
+		struct Slot
+		{
+			uint32_t EntryNo;		// index of the entry + 1, 0 for an empty slot
+			uint32_t Hash;
+		};
+
+		std::deque<Entry> m_Entries;
+		std::vector<uint32_t> m_FreeEntries;
+		std::vector<Slot> m_Slots;
+		size_t m_Count;
+
+		static inline uint32_t MixHash(size_t hash)
+		{
+			// fibonacci hashing spreads sequential hashes (for example of integers) over all slots
+			return (uint32_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ull) >> 32);
+		}
+
+		inline size_t FindSlot(const K & key, uint32_t hash) const
+		{
+			if (m_Slots.empty())
+			{
+				return (size_t)-1;
+			}
+			size_t mask = m_Slots.size() - 1;
+			for (size_t i = hash & mask; m_Slots[i].EntryNo != 0; i = (i + 1) & mask)
+			{
+				if (m_Slots[i].Hash == hash && KeyEqual()(m_Entries[m_Slots[i].EntryNo - 1].Item.first, key))
+				{
+					return i;
+				}
+			}
+			return (size_t)-1;
+		}
+
+		void InsertSlot(uint32_t entryNo, uint32_t hash)
+		{
+			size_t mask = m_Slots.size() - 1;
+			size_t i = hash & mask;
+			while (m_Slots[i].EntryNo != 0)
+			{
+				i = (i + 1) & mask;
+			}
+			m_Slots[i].EntryNo = entryNo;
+			m_Slots[i].Hash = hash;
+		}
+
+		void Rehash(size_t slotCount)
+		{
+			m_Slots.assign(slotCount, Slot{ 0, 0 });
+			for (size_t i = 0; i < m_Entries.size(); i++)
+			{
+				if (m_Entries[i].IsUsed)
+				{
+					InsertSlot((uint32_t)(i + 1), m_Entries[i].Hash);
+				}
+			}
+		}
+
+		static inline void ResetItem(value_type & item, const value_type & newItem)
+		{
+			// the key type may not be assignable (LispVariant), so construct the item again
+			item.~value_type();
+			new (&item) value_type(newItem);
+		}
+
+		void RemoveSlot(size_t i)
+		{
+			// backward shift deletion: move following items of the probe sequence into the gap
+			size_t mask = m_Slots.size() - 1;
+			size_t j = i;
+			for (;;)
+			{
+				j = (j + 1) & mask;
+				if (m_Slots[j].EntryNo == 0)
+				{
+					break;
+				}
+				size_t home = m_Slots[j].Hash & mask;
+				if (((j - home) & mask) >= ((j - i) & mask))
+				{
+					m_Slots[i] = m_Slots[j];
+					i = j;
+				}
+			}
+			m_Slots[i].EntryNo = 0;
+		}
+
+		template <class EntryIterator, class Value>
+		class Iterator
+		{
+		private:
+			EntryIterator m_Current;
+			EntryIterator m_End;
+
+			inline void SkipUnused()
+			{
+				while (m_Current != m_End && !m_Current->IsUsed)
+				{
+					++m_Current;
+				}
+			}
+
+		public:
+			inline Iterator(EntryIterator current, EntryIterator end)
+				: m_Current(current), m_End(end)
+			{
+				SkipUnused();
+			}
+			inline Value & operator*() const
+			{
+				return m_Current->Item;
+			}
+			inline Value * operator->() const
+			{
+				return &(m_Current->Item);
+			}
+			inline Iterator & operator++()
+			{
+				++m_Current;
+				SkipUnused();
+				return *this;
+			}
+			inline bool operator==(const Iterator & other) const
+			{
+				return m_Current == other.m_Current;
+			}
+			inline bool operator!=(const Iterator & other) const
+			{
+				return m_Current != other.m_Current;
+			}
+		};
+
+	public:
+		typedef Iterator<typename std::deque<Entry>::iterator, value_type> iterator;
+		typedef Iterator<typename std::deque<Entry>::const_iterator, const value_type> const_iterator;
+
+		HashDictionary()
+			: m_Count(0)
+		{
+		}
+
+		inline iterator begin()
+		{
+			return iterator(m_Entries.begin(), m_Entries.end());
+		}
+		inline iterator end()
+		{
+			return iterator(m_Entries.end(), m_Entries.end());
+		}
+		inline const_iterator begin() const
+		{
+			return const_iterator(m_Entries.begin(), m_Entries.end());
+		}
+		inline const_iterator end() const
+		{
+			return const_iterator(m_Entries.end(), m_Entries.end());
+		}
+
+		inline size_t size() const
+		{
+			return m_Count;
+		}
+		inline bool empty() const
+		{
+			return m_Count == 0;
+		}
+
+		inline iterator find(const K & key)
+		{
+			size_t i = FindSlot(key, MixHash(Hasher()(key)));
+			return i != (size_t)-1 ? iterator(m_Entries.begin() + (m_Slots[i].EntryNo - 1), m_Entries.end()) : end();
+		}
+		inline const_iterator find(const K & key) const
+		{
+			size_t i = FindSlot(key, MixHash(Hasher()(key)));
+			return i != (size_t)-1 ? const_iterator(m_Entries.begin() + (m_Slots[i].EntryNo - 1), m_Entries.end()) : end();
+		}
+
+		// returns a pointer to the value of the key or null, needs only one probe sequence
+		inline V * FindValue(const K & key)
+		{
+			size_t i = FindSlot(key, MixHash(Hasher()(key)));
+			return i != (size_t)-1 ? &(m_Entries[m_Slots[i].EntryNo - 1].Item.second) : 0;
+		}
+		inline const V * FindValue(const K & key) const
+		{
+			size_t i = FindSlot(key, MixHash(Hasher()(key)));
+			return i != (size_t)-1 ? &(m_Entries[m_Slots[i].EntryNo - 1].Item.second) : 0;
+		}
+
+		V & operator[](const K & key)
+		{
+			uint32_t hash = MixHash(Hasher()(key));
+			size_t i = FindSlot(key, hash);
+			if (i != (size_t)-1)
+			{
+				return m_Entries[m_Slots[i].EntryNo - 1].Item.second;
+			}
+			// keep the load factor below 3/4
+			if ((m_Count + 1) * 4 > m_Slots.size() * 3)
+			{
+				Rehash(m_Slots.empty() ? 8 : m_Slots.size() * 2);
+			}
+			uint32_t entryIndex;
+			if (!m_FreeEntries.empty())
+			{
+				entryIndex = m_FreeEntries.back();
+				m_FreeEntries.pop_back();
+				ResetItem(m_Entries[entryIndex].Item, value_type(key, V()));
+			}
+			else
+			{
+				entryIndex = (uint32_t)m_Entries.size();
+				m_Entries.push_back(Entry{ value_type(key, V()), 0, false });
+			}
+			Entry & entry = m_Entries[entryIndex];
+			entry.Hash = hash;
+			entry.IsUsed = true;
+			InsertSlot(entryIndex + 1, hash);
+			m_Count++;
+			return entry.Item.second;
+		}
+
+		size_t erase(const K & key)
+		{
+			size_t i = FindSlot(key, MixHash(Hasher()(key)));
+			if (i == (size_t)-1)
+			{
+				return 0;
+			}
+			uint32_t entryIndex = m_Slots[i].EntryNo - 1;
+			RemoveSlot(i);
+			Entry & entry = m_Entries[entryIndex];
+			ResetItem(entry.Item, value_type());
+			entry.IsUsed = false;
+			m_FreeEntries.push_back(entryIndex);
+			m_Count--;
+			return 1;
+		}
+
+		inline void clear()
+		{
+			m_Entries.clear();
+			m_FreeEntries.clear();
+			m_Slots.clear();
+			m_Count = 0;
+		}
+
+		bool operator==(const HashDictionary & other) const
+		{
+			if (m_Count != other.m_Count)
+			{
+				return false;
+			}
+			for (auto & kvp : *this)
+			{
+				const V * value = other.FindValue(kvp.first);
+				if (value == 0 || !(*value == kvp.second))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		inline IEnumerable<K> GetKeys() const
+		{
+			IEnumerable<K> keys;
+			for (auto & kvp : *this)
+			{
+				keys.push_back(kvp.first);
+			}
+			// the order of the keys does not depend on the hash values
+			std::sort(keys.begin(), keys.end());
+			return keys;
+		}
+
+		inline bool ContainsKey(const K & key, V * pValue = 0) const
+		{
+			const V * value = FindValue(key);
+			if (value != 0 && pValue != 0)
+			{
+				*pValue = *value;
+			}
+			return value != 0;
+		}
+
+		inline bool ContainsValue(const V & value) const
+		{
+			for (auto & kvp : *this)
+			{
+				if (*(kvp.second) == *(value))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		inline bool Remove(const K & key)
+		{
+			return erase(key) > 0;
+		}
+
+		inline void Clear()
+		{
+			clear();
+		}
+	};
+
 	// **********************************************************************
 	template <class K, class V>
 	class KeyValuePair
@@ -334,6 +682,28 @@ namespace CppLisp
 
 		void SetContent(const string & txt);
 		string ReadLine();
+		bool EndOfStream() const;
+	};
+
+	// **********************************************************************
+	/// <summary>
+	/// The arithmetic and compare operations of the builtin functions, 
+	/// executed natively for numbers (see <see cref="LispVariant::NativeOperation"/>).
+	/// </summary>
+	enum LispOperator
+	{
+		OperatorNone = 0,
+		OperatorAdd = 1,
+		OperatorSubtract = 2,
+		OperatorMultiply = 3,
+		OperatorDivide = 4,
+		OperatorModulo = 5,
+		OperatorLess = 6,
+		OperatorGreater = 7,
+		OperatorLessEqual = 8,
+		OperatorGreaterEqual = 9,
+		OperatorEqual = 10,
+		OperatorNotEqual = 11
 	};
 
 	// **********************************************************************
@@ -348,7 +718,8 @@ namespace CppLisp
 		inline LispFunctionWrapper()
 			: m_bIsSpecialForm(false), 
 			  m_bIsEvalInExpand(false),
-			  m_bIsBuiltin(false)
+			  m_bIsBuiltin(false),
+			  Operator(OperatorNone)
 		{
 		}
 
@@ -358,6 +729,18 @@ namespace CppLisp
 
 		/*public*/ string Documentation; // { get; private set; }
 
+		/// <summary>
+		/// The user defined function (created by fn) which is called by <see cref="Function"/>, 
+		/// null for builtin functions.
+		/// </summary>
+		/*public*/ std::shared_ptr<LispUserFunction> UserFunction;
+
+		/// <summary>
+		/// The operation of an arithmetic or compare builtin function, 
+		/// the virtual machine executes these operations for numbers without calling the function.
+		/// </summary>
+		/*public*/ LispOperator Operator;
+
 		inline bool IsBuiltin() const
 		{
 			return m_bIsBuiltin;
@@ -29,6 +29,10 @@
 //using System.Reflection;
 
 #include "fuel.h"
+#include "Profiler.h"
+#include "Runtime.h"
+
+#include <fstream>
 
 #if defined( _WIN32 )
 #include <windows.h>
@@ -107,8 +111,6 @@ static void DisconnectDebugger()
 
 namespace CppLisp
 {
-	extern string LispUtils_LibraryPath;
-
 	uint64_t Environment_GetTickCount(void);
 
     static bool ContainsOptionAndRemove(std::vector<string> & args, const string & option)
@@ -158,10 +160,13 @@ namespace CppLisp
 		var loadFiles = true;
 		var trace = false;
 		var macroExpand = false;
+		var streamFiles = false;
 		//var compile = false;
 		var wasDebugging = false;
 		//var showCompileOutput = false;
 		var measureTime = false;
+		var profile = false;
+		string profileFile = string::Empty;
 		var lengthyErrorOutput = false;
 		var interactiveLoop = false;
 		var startDebugger = false;
@@ -199,6 +204,10 @@ namespace CppLisp
 		{
 			macroExpand = true;
 		}
+		if (ContainsOptionAndRemove(allArgs, "--stream"))
+		{
+			streamFiles = true;
+		}
 		if (ContainsOptionAndRemove(allArgs, "-x"))
 		{
 			lengthyErrorOutput = true;
@@ -207,6 +216,17 @@ namespace CppLisp
 		{
 			trace = true;
 		}
+		if (ContainsOptionAndRemove(allArgs, "-p"))
+		{
+			profile = true;
+		}
+		var profileOption = std::find_if(allArgs.begin(), allArgs.end(), [](const string & v) -> bool { return v.StartsWith("-p="); });
+		if (profileOption != allArgs.end())
+		{
+			profile = true;
+			profileFile = profileOption->Substring(3);
+			allArgs.erase(profileOption);
+		}
 		if (ContainsOptionAndRemove(allArgs, "-e"))
 		{
 			script = /*LispUtils.*/GetScriptFilesFromProgramArgs(args)[0]/*.FirstOrDefault()*/;
@@ -219,7 +239,7 @@ namespace CppLisp
 			if (libPath.size() == 1)
 			{
 				string libraryPath = libPath.front().Substring(3);
-				LispUtils_LibraryPath = libraryPath;
+				LispRuntime::SetDefaultLibraryPath(libraryPath);
 				ContainsOptionAndRemove(allArgs, *(libPath.begin()));
 			}
 			else
@@ -309,10 +329,22 @@ namespace CppLisp
 		}
 #endif
 
+		if (profile)
+		{
+			LispProfiler::Start();
+		}
+
 		if (loadFiles)
 		{
 			for (var fileName : scriptFiles)
 			{
+				if (streamFiles && !macroExpand)
+				{
+					// evaluate form by form without reading the whole file
+					var reader = std::make_shared<LispReader>(std::make_shared<std::ifstream>(fileName, std::ios::binary));
+					result = Lisp::SaveEvalForms(reader, /*moduleName:*/ fileName, /*verboseErrorOutput:*/ lengthyErrorOutput, /*tracing:*/ trace, output, input);
+					continue;
+				}
 				script = /*LispUtils.*/ReadFileOrEmptyString(fileName);
 				//ILispCompiler compiler = TryGetCompiler();
 				//if (compile && compiler != null)
@@ -336,6 +368,15 @@ namespace CppLisp
 			result = Lisp::SaveEval(script, /*moduleName:*/ "cmdline", /*verboseErrorOutput:*/ false, /*tracing:*/ false, output, input, macroExpand);
 		}
 
+		if (profile)
+		{
+			LispProfiler::Stop();
+			output->WriteLine(LispProfiler::GetFlatReport());
+			if (!string::IsNullOrEmpty(profileFile))
+			{
+				WriteTextFile(profileFile, LispProfiler::GetFoldedStacks());
+			}
+		}
 		if (macroExpand)
 		{
 			output->WriteLine(string("Macro expand: ") + result->ToString());
@@ -367,7 +408,10 @@ namespace CppLisp
 		output->WriteLine("  --doc       : show language documentation");
 		output->WriteLine("  --html      : show language documentation in html");
 		output->WriteLine("  --macro-expand : expand all macros and show resulting code");
+		output->WriteLine("  --stream    : evaluate the script files form by form while reading");
 		output->WriteLine("  -m          : measure execution time");
+		output->WriteLine("  -p          : profile the script and show the samples per function and line");
+		output->WriteLine("  -p=\"file\"   : profile the script and write the samples as folded stacks to file");
 		output->WriteLine("  -t          : enable tracing");
 		output->WriteLine("  -x          : exhaustive error output");
 #ifndef _DISABLE_DEBUGGER
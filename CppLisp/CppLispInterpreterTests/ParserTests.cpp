@@ -62,10 +62,10 @@ namespace QtLispUnitTests
             QCOMPARE("print", value->Value->ToString().c_str());
             value = resultAsArray[1]->ToLispVariant();
             QVERIFY(value->IsInt());
-            QCOMPARE(1, (int)*(value->Value));
+            QCOMPARE(1, value->IntValue());
             value = resultAsArray[2]->ToLispVariant();
             QVERIFY(value->IsDouble());
-            QCOMPARE(2.54, (double)*(value->Value));
+            QCOMPARE(2.54, value->DoubleValue());
             value = resultAsArray[3]->ToLispVariant();
             QVERIFY(value->IsString());
             QCOMPARE("string", value->Value->ToString().c_str());
@@ -87,13 +87,33 @@ namespace QtLispUnitTests
             var resultAsArray = listValue->ToArray();
             value = resultAsArray[1]->ToLispVariant();
             QVERIFY(value->IsBool());
-            QCOMPARE(true, (bool)*(value->Value));
+            QCOMPARE(true, value->BoolValue());
             value = resultAsArray[2]->ToLispVariant();
             QVERIFY(value->IsDouble());
-            QCOMPARE(2.54, (double)*(value->Value));
+            QCOMPARE(2.54, value->DoubleValue());
             value = resultAsArray[3]->ToLispVariant();
             QVERIFY(value->IsString());
             QCOMPARE("string", value->Value->ToString().c_str());
         }
+
+		TEST_METHOD(Test_SingleParserQuote)
+		{
+			std::shared_ptr<object> result = LispParser::Parse("(print '(1 2) `(a ,b))");
+			QVERIFY(result.get() != 0);
+			QVERIFY(result->IsList());
+			var resultAsArray = result->ToEnumerableOfObjectRef();
+			QCOMPARE((size_t)3, resultAsArray.size());
+
+			var quoted = resultAsArray[1]->ToEnumerableOfObjectRef();
+			QCOMPARE((size_t)2, quoted.size());
+			QCOMPARE("quote", quoted[0]->ToLispVariant()->Value->ToString().c_str());
+			QCOMPARE((size_t)2, quoted[1]->ToEnumerableOfObjectRef().size());
+
+			var quasiQuoted = resultAsArray[2]->ToEnumerableOfObjectRef();
+			QCOMPARE("quasiquote", quasiQuoted[0]->ToLispVariant()->Value->ToString().c_str());
+			var unquoted = quasiQuoted[1]->ToEnumerableOfObjectRef()[1]->ToEnumerableOfObjectRef();
+			QCOMPARE("_unquote", unquoted[0]->ToLispVariant()->Value->ToString().c_str());
+			QCOMPARE("b", unquoted[1]->ToLispVariant()->Value->ToString().c_str());
+		}
 	};
 }
@@ -31,6 +31,7 @@
 #include "../CppLispInterpreter/csobject.h"
 #include "../CppLispInterpreter/Tokenizer.h"
 #include "../CppLispInterpreter/Token.h"
+#include "../CppLispInterpreter/Symbol.h"
 #include "../CppLispInterpreter/Tokenizer.h"
 
 #include "FuelUnitTestHelper.h"
@@ -186,5 +187,78 @@ namespace QtLispUnitTests
 			QCOMPARE("blub\nhello", resultAsArray[2]->ToString().c_str());
 			QVERIFY(LispTokenType::String == resultAsArray[2]->Type);
 		}
+
+		TEST_METHOD(Test_TokenizerSymbolIds)
+		{
+			IEnumerable<std::shared_ptr<LispToken>> result = LispTokenizer::Tokenize("(test a test \"test\")");
+			QCOMPARE((size_t)6, result.Count());
+			var resultAsArray = result.ToArray();
+			QVERIFY(resultAsArray[1]->SymbolId != LispSymbolTable::NoSymbol);
+			QVERIFY(resultAsArray[1]->SymbolId == resultAsArray[3]->SymbolId);
+			QVERIFY(resultAsArray[1]->SymbolId != resultAsArray[2]->SymbolId);
+			QVERIFY(resultAsArray[1]->Value.get() == resultAsArray[3]->Value.get());
+			QVERIFY(LispSymbolTable::NoSymbol == resultAsArray[4]->SymbolId);
+			QCOMPARE("test", LispSymbolTable::GetName(resultAsArray[1]->SymbolId).c_str());
+			QVERIFY(resultAsArray[1]->SymbolId == LispSymbolTable::Find("test"));
+		}
+
+		TEST_METHOD(Test_TokenizerComments)
+		{
+			// a comment ends with the new line or with the code
+			IEnumerable<std::shared_ptr<LispToken>> result = LispTokenizer::Tokenize("(+ 1 2) ; comment");
+			QCOMPARE((size_t)6, result.Count());
+			var resultAsArray = result.ToArray();
+			QVERIFY(LispTokenType::Comment == resultAsArray[5]->Type);
+			QCOMPARE("; comment", resultAsArray[5]->ToString().c_str());
+
+			result = LispTokenizer::Tokenize(";\n(+ 1 2)");
+			QCOMPARE((size_t)6, result.Count());
+			resultAsArray = result.ToArray();
+			QCOMPARE(";\n", resultAsArray[0]->ToString().c_str());
+			QVERIFY(LispTokenType::ListStart == resultAsArray[1]->Type);
+			QCOMPARE((size_t)2, resultAsArray[1]->LineNo);
+
+			// a semicolon in a string starts no comment
+			result = LispTokenizer::Tokenize("(print \"a;b\")\n(x)");
+			QCOMPARE((size_t)7, result.Count());
+			resultAsArray = result.ToArray();
+			QCOMPARE("a;b", resultAsArray[2]->ToString().c_str());
+			QCOMPARE((size_t)2, resultAsArray[4]->LineNo);
+		}
+
+		TEST_METHOD(Test_TokenizerScan)
+		{
+			string code = "(test \"a\\tb\" 42 -3.5 2147483648 ; comment\n sym)";
+			std::vector<LispTokenView> tokens;
+			std::vector<string> escapedTexts;
+			LispTokenizer::Scan(code, 0, tokens, escapedTexts);
+			QCOMPARE((size_t)9, tokens.size());
+			QVERIFY(LispTokenType::Symbol == tokens[1].Type);
+			QCOMPARE("test", code.substr(tokens[1].TextOffset, tokens[1].TextLength).c_str());
+			QVERIFY(LispTokenType::String == tokens[2].Type);
+			QCOMPARE((size_t)1, escapedTexts.size());
+			QCOMPARE((size_t)0, tokens[2].EscapedText);
+			QCOMPARE("a\tb", escapedTexts[0].c_str());
+			QVERIFY(LispTokenType::Int == tokens[3].Type);
+			QVERIFY(LispTokenView::NoEscapedText == tokens[3].EscapedText);
+			QVERIFY(LispTokenType::Double == tokens[4].Type);
+			QVERIFY(LispTokenType::Double == tokens[5].Type);
+			QVERIFY(LispTokenType::Comment == tokens[6].Type);
+			QCOMPARE("; comment\n", code.substr(tokens[6].TextOffset, tokens[6].TextLength).c_str());
+			QCOMPARE((size_t)2, tokens[7].LineNo);
+
+			// the tokens are created from the token views
+			IEnumerable<std::shared_ptr<LispToken>> result = LispTokenizer::Tokenize(code);
+			QCOMPARE(tokens.size(), result.Count());
+			for (size_t i = 0; i < tokens.size(); i++)
+			{
+				QVERIFY(tokens[i].Type == result[i]->Type);
+				QCOMPARE(tokens[i].StartPos, result[i]->StartPos);
+				QCOMPARE(tokens[i].StopPos, result[i]->StopPos);
+				QCOMPARE(tokens[i].LineNo, result[i]->LineNo);
+			}
+			QCOMPARE("a\tb", result[2]->ToString().c_str());
+			QCOMPARE(42, (int)*(result[3]->Value));
+		}
 	};
 }
\ No newline at end of file
@@ -9,9 +9,17 @@
 
 #include "../CppLispInterpreter/Variant.h"
 #include "../CppLispInterpreter/Lisp.h"
+#include "../CppLispInterpreter/Symbol.h"
+#include "../CppLispInterpreter/Profiler.h"
+#include "../CppLispInterpreter/ModuleCache.h"
 #include "../CppLispInterpreter/fuel.h"
 #include "../CppLispDebugger/Debugger.h"
 
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
 using namespace CppLisp;
 
 double Math_Round(double val)
@@ -277,6 +285,79 @@ private Q_SLOTS:
         QVERIFY(LispTokenType::String == resultAsArray[2]->Type);
     }
 
+    TEST_METHOD(Test_TokenizerSymbolIds)
+    {
+        IEnumerable<std::shared_ptr<LispToken>> result = LispTokenizer::Tokenize("(test a test \"test\")");
+        QCOMPARE((size_t)6, result.Count());
+        var resultAsArray = result.ToArray();
+        QVERIFY(resultAsArray[1]->SymbolId != LispSymbolTable::NoSymbol);
+        QVERIFY(resultAsArray[1]->SymbolId == resultAsArray[3]->SymbolId);
+        QVERIFY(resultAsArray[1]->SymbolId != resultAsArray[2]->SymbolId);
+        QVERIFY(resultAsArray[1]->Value.get() == resultAsArray[3]->Value.get());
+        QVERIFY(LispSymbolTable::NoSymbol == resultAsArray[4]->SymbolId);
+        QCOMPARE("test", LispSymbolTable::GetName(resultAsArray[1]->SymbolId).c_str());
+        QVERIFY(resultAsArray[1]->SymbolId == LispSymbolTable::Find("test"));
+    }
+
+    TEST_METHOD(Test_TokenizerComments)
+    {
+        // a comment ends with the new line or with the code
+        IEnumerable<std::shared_ptr<LispToken>> result = LispTokenizer::Tokenize("(+ 1 2) ; comment");
+        QCOMPARE((size_t)6, result.Count());
+        var resultAsArray = result.ToArray();
+        QVERIFY(LispTokenType::Comment == resultAsArray[5]->Type);
+        QCOMPARE("; comment", resultAsArray[5]->ToString().c_str());
+
+        result = LispTokenizer::Tokenize(";\n(+ 1 2)");
+        QCOMPARE((size_t)6, result.Count());
+        resultAsArray = result.ToArray();
+        QCOMPARE(";\n", resultAsArray[0]->ToString().c_str());
+        QVERIFY(LispTokenType::ListStart == resultAsArray[1]->Type);
+        QCOMPARE((size_t)2, resultAsArray[1]->LineNo);
+
+        // a semicolon in a string starts no comment
+        result = LispTokenizer::Tokenize("(print \"a;b\")\n(x)");
+        QCOMPARE((size_t)7, result.Count());
+        resultAsArray = result.ToArray();
+        QCOMPARE("a;b", resultAsArray[2]->ToString().c_str());
+        QCOMPARE((size_t)2, resultAsArray[4]->LineNo);
+    }
+
+    TEST_METHOD(Test_TokenizerScan)
+    {
+        string code = "(test \"a\\tb\" 42 -3.5 2147483648 ; comment\n sym)";
+        std::vector<LispTokenView> tokens;
+        std::vector<string> escapedTexts;
+        LispTokenizer::Scan(code, 0, tokens, escapedTexts);
+        QCOMPARE((size_t)9, tokens.size());
+        QVERIFY(LispTokenType::Symbol == tokens[1].Type);
+        QCOMPARE("test", code.substr(tokens[1].TextOffset, tokens[1].TextLength).c_str());
+        QVERIFY(LispTokenType::String == tokens[2].Type);
+        QCOMPARE((size_t)1, escapedTexts.size());
+        QCOMPARE((size_t)0, tokens[2].EscapedText);
+        QCOMPARE("a\tb", escapedTexts[0].c_str());
+        QVERIFY(LispTokenType::Int == tokens[3].Type);
+        QVERIFY(LispTokenView::NoEscapedText == tokens[3].EscapedText);
+        QVERIFY(LispTokenType::Double == tokens[4].Type);
+        QVERIFY(LispTokenType::Double == tokens[5].Type);
+        QVERIFY(LispTokenType::Comment == tokens[6].Type);
+        QCOMPARE("; comment\n", code.substr(tokens[6].TextOffset, tokens[6].TextLength).c_str());
+        QCOMPARE((size_t)2, tokens[7].LineNo);
+
+        // the tokens are created from the token views
+        IEnumerable<std::shared_ptr<LispToken>> result = LispTokenizer::Tokenize(code);
+        QCOMPARE(tokens.size(), result.Count());
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            QVERIFY(tokens[i].Type == result[i]->Type);
+            QCOMPARE(tokens[i].StartPos, result[i]->StartPos);
+            QCOMPARE(tokens[i].StopPos, result[i]->StopPos);
+            QCOMPARE(tokens[i].LineNo, result[i]->LineNo);
+        }
+        QCOMPARE("a\tb", result[2]->ToString().c_str());
+        QCOMPARE(42, (int)*(result[3]->Value));
+    }
+
     // *****************************
 
 
@@ -532,6 +613,462 @@ private Q_SLOTS:
         QCOMPARE("START:34", result->ToString().c_str());
     }
 
+    TEST_METHOD(Test_CompiledWhileWithReturn)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn f (n) (do (def i 0) (while #t (do (if (== i n) (return (* i 2))) (setf i (+ i 1)))))) (f 7))");
+        QCOMPARE(14, result->ToInt());
+    }
+
+    TEST_METHOD(Test_CompiledAndOrIf)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(list (and #t #t) (and #t #f) (or #t #f) (if (and #t #f) 1 2))");
+        QCOMPARE("(#t #f #t 2)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_LocalSlotShadowedByEval)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def x 1) (defn f (a) (do (def r 0) (def i 0) (while (< i 3) (do (setf r (+ r x a)) (setf i (+ i 1)))) (eval (list 'def 'x 10)) (+ r x))) (f 2))");
+        QCOMPARE(19, result->ToInt());
+    }
+
+    TEST_METHOD(Test_LocalSlotDelvar)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn g () (do (def y 5) (def z y) (delvar 'y) (def y 7) (+ y z))) (g))");
+        QCOMPARE(12, result->ToInt());
+    }
+
+    TEST_METHOD(Test_ClosureVariables)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn mk (n) (do (def k 3) (fn (v) (+ v n k)))) (def add (mk 10)) (add 1))");
+        QCOMPARE(14, result->ToInt());
+    }
+
+    TEST_METHOD(Test_TailCallsAndDeepRecursion)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn loop (n acc) (if (> n 0) (loop (- n 1) (+ acc 1)) acc)) (defn deep (n) (if (> n 0) (+ 1 (deep (- n 1))) 0)) (defn even (n) (if (== n 0) #t (odd (- n 1)))) (defn odd (n) (if (== n 0) #f (even (- n 1)))) (list (loop 100000 0) (deep 100000) (even 100001)))");
+        QCOMPARE("(100000 100000 #f)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_CallSiteCache)
+    {
+        Lisp::ResetRuntimeStatistics();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn g (x) (+ x 1)) (defn f (x) (g x)) (def a (f 1)) (def b (f 2)) (defn g (x) (* x 10)) (list a b (f 3)))");
+        QCOMPARE("(2 3 30)", result->ToString().c_str());
+        QCOMPARE((size_t)3, Lisp::GetRuntimeStatistics().CallSiteCacheHits);
+        QCOMPARE((size_t)3, Lisp::GetRuntimeStatistics().CallSiteCacheMisses);
+    }
+
+    TEST_METHOD(Test_NativeOperations)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(list (+ 1 2) (- 7 2.5) (* 2 3.0) (/ 7 2) (/ 7.5 2) (% -7 2) (% 7.5 2) (< 1 2.0) (>= 2 2) (== 1 1.000000001) (!= #t #f) (+ \"a\" 1))");
+        QCOMPARE("(3 4.500000 6.000000 3 3.750000 -1 1.500000 #t #t #t #t \"a1\")", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_Profiler)
+    {
+        LispProfiler::Start(1);
+        for (int i = 0; i < 1000 && LispProfiler::GetSampleCount() == 0; i++)
+        {
+            Lisp::Eval("(do (defn fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2))))) (fib 18))");
+        }
+        LispProfiler::Stop();
+        QVERIFY(LispProfiler::GetSampleCount() > 0);
+        QVERIFY(LispProfiler::GetFlatReport().Contains("fib (test)"));
+        QVERIFY(LispProfiler::GetFoldedStacks().StartsWith("<main> (test:1)"));
+
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (profile-start 5) (profile-stop))");
+        QVERIFY(result->ToString().StartsWith("Profile: "));
+    }
+
+    TEST_METHOD(Test_RuntimeStatistics)
+    {
+        Lisp::ResetRuntimeStatistics();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (define-macro-expand inc (x) '(+ x 1)) (defn f (x) (inc x)) (f 1) (f 2))");
+        QCOMPARE(3, result->IntValue());
+        LispRuntimeStatistics statistics = Lisp::GetRuntimeStatistics();
+        QCOMPARE((size_t)2, statistics.FunctionCalls);
+        // the compiled calls do not need a scope
+        QCOMPARE((size_t)0, statistics.FunctionScopes);
+        QCOMPARE((size_t)1, statistics.MacroExpansions);
+        QCOMPARE((size_t)0, statistics.ExceptionsThrown);
+        QVERIFY(statistics.ObjectAllocations > 0);
+        QVERIFY(statistics.GlobalResolves > 0);
+
+        result = Lisp::Eval("(do (defn f (x) x) (reset-runtime-stats) (f 1) (f 2) (def d (runtime-stats)) (list (dict-get d \"enabled\") (dict-get d \"function-calls\") (dict-get d \"function-scopes\") (dict-get d \"exceptions\")))");
+        QCOMPARE("(#t 2 0 0)", result->ToString().c_str());
+
+        // calls of user functions do not intern their argument names again
+        result = Lisp::Eval("(do (defn g (a b) (+ a b)) (g 1 2) (reset-runtime-stats) (g 3 4) (g 5 6) (dict-get (runtime-stats) \"symbol-table-locks\"))");
+        QCOMPARE(0, result->IntValue());
+    }
+
+    TEST_METHOD(Test_ScopeHashDictionary)
+    {
+        HashDictionary<string, int> dict;
+        for (int i = 0; i < 1000; i++)
+        {
+            dict[std::to_string(i)] = i;
+        }
+        for (int i = 0; i < 1000; i += 2)
+        {
+            QVERIFY(dict.Remove(std::to_string(i)));
+        }
+        QCOMPARE((size_t)500, dict.size());
+        QVERIFY(dict.ContainsKey("999"));
+        QVERIFY(!dict.ContainsKey("998"));
+        QCOMPARE(501, *dict.FindValue("501"));
+        dict["0"] = 42;
+        QCOMPARE((size_t)501, dict.size());
+        QCOMPARE("0", dict.GetKeys()[0].c_str());
+
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def a 1) (def b 2) (delvar a) (setf b (+ b 1)) (def a 4) (+ a b))");
+        QCOMPARE(7, result->IntValue());
+    }
+
+    TEST_METHOD(Test_HashAndSortedDict)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def d (make-dict)) (def s (make-sorted-dict)) (dict-set d \"b\" 1) (dict-set d \"a\" 2) (dict-set s \"b\" 1) (dict-set s \"a\" 2) (dict-set d 1 \"int\") (dict-set d 1.0 \"double\") (list (dict-keys d) (dict-keys s) (len d) (dict-get d 1) (dict-get d 1.0) (dict-get d \"c\") (typestr s)))");
+        QCOMPARE("((\"b\" \"a\" 1 1.000000) (\"a\" \"b\") 4 \"int\" \"double\" <undefined> \"NativeSortedDictionary\")", result->ToString().c_str());
+
+        result = Lisp::Eval("(do (def d (make-dict)) (def i 0) (while (< i 1000) (do (dict-set d (+ \"k\" i) i) (setf i (+ i 1)))) (def i 0) (while (< i 1000) (do (dict-remove d (+ \"k\" i)) (setf i (+ i 2)))) (list (len d) (dict-get d \"k999\") (dict-contains-key d \"k998\")))");
+        QCOMPARE("(500 999 #f)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_DictValueIndexAndViews)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def d (make-dict #t)) (dict-set d \"a\" 1) (dict-set d \"b\" 2) (dict-set d \"c\" 1) (dict-set d \"a\" 3) (def k (dict-keys d)) (dict-remove d \"b\") (list (dict-contains-value d 1) (dict-contains-value d 2) (dict-contains-value d 3) (dict-values d) k (dict-keys d) (dict-get d \"x\" 42) (dict-get d \"a\" 42)))");
+        QCOMPARE("(#t #f #t (3 1) (\"a\" \"b\" \"c\") (\"a\" \"c\") 42 3)", result->ToString().c_str());
+
+        result = Lisp::Eval("(do (def s (make-sorted-dict)) (dict-set s 2 \"two\") (dict-set s 1 \"one\") (list (dict-values s) (dict-get s 3 \"none\") (dict-contains-value s \"one\")))");
+        QCOMPARE("((\"one\" \"two\") \"none\" #t)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_SharedListElements)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def l '(1 2 3)) (def r (rest l)) (def a (cons 0 r)) (def b (cons 9 r)) (setf (first r) 7) (def c (cons 8 a)) (push 5 a) (list l r a b c (append a b) (rest '()) (len (rest (rest (rest (rest l)))))))");
+        QCOMPARE("((1 2 3) (7 3) (5 0 2 3) (9 2 3) (8 0 2 3) (5 0 2 3 9 2 3) () 0)", result->ToString().c_str());
+
+        result = Lisp::Eval("(do (defn rmap (f l) (if (== (len l) 0) '() (cons (f (first l)) (rmap f (rest l))))) (rmap (lambda (x) (* x 2)) '(1 2 3)))");
+        QCOMPARE("(2 4 6)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_ListSliceAndPop)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def l '(1 2 3 4 5)) (def s (slice l 1 3)) (def c (cons 0 s)) (def p (list 1 2 3)) (def e (pop p)) (list s (slice l 2 -1) (slice l 4 10) (slice l 9 1) c l e p (cons 9 p) (slice \"hello\" 1 3)))");
+        QCOMPARE("((2 3 4) (3 4 5) (5) () (0 2 3 4) (1 2 3 4 5) 1 (2 3) (9 2 3) \"ell\")", result->ToString().c_str());
+
+        result = Lisp::Eval("(do (define-macro-eval args (a b) (quoted-macro-args)) (args 7 (+ 1 2)))");
+        QCOMPARE("(7 (+ 1 2))", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_ParallelMapAndReduce)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn sq (x) (* x x)) (def l (list)) (def i 0) (while (< i 1000) (do (setf l (cons i l)) (setf i (+ i 1)))) (list (== (pmap sq l) (map sq l)) (preduce + l 0) (preduce + (list \"a\" \"b\" \"c\" \"d\" \"e\") \"\") (pmap sq '()) (preduce + '() 7) (pmap (lambda (x) (pmap sq x)) (list (list 1 2) (list 3)))))");
+        QCOMPARE("(#t 499500 \"edcba\" () 7 ((1 4) (9)))", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_ParallelMapError)
+    {
+        try
+        {
+            std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn f (x) (if (== x 3) (undefined-fcn x) x)) (pmap f (list 1 2 3 4 5 6 7 8)))");
+            QVERIFY(false);
+        }
+        catch (const CppLisp::LispExceptionBase &)
+        {
+            QVERIFY(true);
+        }
+        catch (...)
+        {
+            QVERIFY(false);
+        }
+    }
+
+    TEST_METHOD(Test_ParallelInterpreters)
+    {
+        // independent interpreters (one global scope per thread) do not share mutable state
+        const int threadCount = 4;
+        std::vector<std::string> results(threadCount);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; i++)
+        {
+            threads.push_back(std::thread([&results, i]()
+            {
+                try
+                {
+                    for (int j = 0; j < 20; j++)
+                    {
+                        Lisp::ResetRuntimeStatistics();
+                        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def n " + std::to_string(i) + ") (defn g (x) (+ x n)) (defn f (x) (g x)) (def l (map f (list 1 2 3))) (defn g (x) (* x n)) (list l (f 10) (dict-get (runtime-stats) \"call-site-cache-misses\")))");
+                        results[i] = result->ToString();
+                    }
+                }
+                catch (...)
+                {
+                    results[i] = "exception";
+                }
+            }));
+        }
+        for (var & thread : threads)
+        {
+            thread.join();
+        }
+        for (int i = 0; i < threadCount; i++)
+        {
+            QCOMPARE(("((" + std::to_string(1 + i) + " " + std::to_string(2 + i) + " " + std::to_string(3 + i) + ") " + std::to_string(10 * i) + " 3)").c_str(), results[i].c_str());
+        }
+    }
+
+    TEST_METHOD(Test_ScopeFork)
+    {
+        std::shared_ptr<LispScope> prototype = LispEnvironment::CreateDefaultScope();
+        Lisp::Eval("(do (def l (list 1 2)) (def n 5) (defn f (x) (+ x n)))", prototype);
+        std::shared_ptr<LispScope> fork1 = prototype->Fork();
+        std::shared_ptr<LispScope> fork2 = prototype->Fork();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (push 3 l) (setf n 10) (list l (f 2)))", fork1);
+        QCOMPARE("((3 1 2) 12)", result->ToString().c_str());
+        result = Lisp::Eval("(do (defn f (x) (* x n)) (list l (f 2) (map f (list 1 2))))", fork2);
+        QCOMPARE("((1 2) 10 (5 10))", result->ToString().c_str());
+        result = Lisp::Eval("(list l n (f 2))", prototype);
+        QCOMPARE("((1 2) 5 7)", result->ToString().c_str());
+        result = Lisp::Eval("(list l n (f 2))", fork1);
+        QCOMPARE("((3 1 2) 10 12)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_ModuleCache)
+    {
+        const std::string moduleFileName = "modulecachetest.fuel";
+        const std::string cacheFileName = LispModuleCache::GetCacheFileName(moduleFileName, "");
+        std::remove(cacheFileName.c_str());
+        {
+            std::ofstream module(moduleFileName);
+            module << "(defn twice (x) (* 2 x)) ; comment\n(def values '(1 2.5 \"text\" #t nil))\n";
+        }
+        // the first import writes the cache file, the second import reads the tokens from the cache file
+        for (size_t i = 0; i < 2; i++)
+        {
+            Lisp::ResetRuntimeStatistics();
+            std::shared_ptr<LispVariant> result = Lisp::Eval("(do (import \"modulecachetest.fuel\") (list (twice 3) values))");
+            QCOMPARE("(6 (1 2.500000 \"text\" #t ()))", result->ToString().c_str());
+            QVERIFY(i == Lisp::GetRuntimeStatistics().ModuleCacheHits);
+            QVERIFY(1 - i == Lisp::GetRuntimeStatistics().ModuleCacheMisses);
+        }
+        // a modified module does not use the cache file
+        {
+            std::ofstream module(moduleFileName);
+            module << "(defn twice (x) (* 3 x))\n";
+        }
+        Lisp::ResetRuntimeStatistics();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (import \"modulecachetest.fuel\") (twice 3))");
+        QCOMPARE(9, result->IntValue());
+        QVERIFY(0 == Lisp::GetRuntimeStatistics().ModuleCacheHits);
+        std::remove(cacheFileName.c_str());
+        std::remove(moduleFileName.c_str());
+    }
+
+    TEST_METHOD(Test_ModuleRegistry)
+    {
+        const std::string moduleFileName = "registrytest.fuel";
+        {
+            std::ofstream module(moduleFileName);
+            module << "(println \"loading\")\n(defn version () 1)\n";
+        }
+        var scope = LispEnvironment::CreateDefaultScope();
+        scope->Output->EnableToString(true);
+        // an imported module is not evaluated again, also if it is imported with another path
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (import \"registrytest.fuel\") (import \"./registrytest.fuel\") (import \"registrytest.fuel\") (version))", scope);
+        QCOMPARE(1, result->IntValue());
+        QCOMPARE("loading", scope->Output->GetContent().Trim().c_str());
+        // reload evaluates the changed module
+        {
+            std::ofstream module(moduleFileName);
+            module << "(defn version () 2)\n";
+        }
+        result = Lisp::Eval("(do (reload \"registrytest.fuel\") (import \"registrytest.fuel\") (version))", scope);
+        QCOMPARE(2, result->IntValue());
+        std::remove(LispModuleCache::GetCacheFileName(moduleFileName, "").c_str());
+        std::remove(moduleFileName.c_str());
+    }
+
+    TEST_METHOD(Test_ModuleIndex)
+    {
+        {
+            std::ofstream module1("indextest1.fuel");
+            module1 << "(defn which () 1)\n(defn only1 () 10)\n";
+            std::ofstream module2("indextest2.fuel");
+            module2 << "(defn which () 2)\n(defn only2 () 20)\n";
+        }
+        var scope = LispEnvironment::CreateDefaultScope();
+        // a symbol defined in more than one module is taken from the module with the first name in sorted order
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (import \"indextest1.fuel\" \"indextest2.fuel\") (list (which) (only1) (only2) unknown))", scope);
+        QCOMPARE("(1 10 20 unknown)", result->ToString().c_str());
+        result = Lisp::Eval("(list (which) (only1) (only2) unknown)", scope->Fork());
+        QCOMPARE("(1 10 20 unknown)", result->ToString().c_str());
+        for (const char * moduleFileName : { "indextest1.fuel", "indextest2.fuel" })
+        {
+            std::remove(LispModuleCache::GetCacheFileName(moduleFileName, "").c_str());
+            std::remove(moduleFileName);
+        }
+    }
+
+    TEST_METHOD(Test_ReaderForms)
+    {
+        const std::string code = "(def a 1) \"a (string\" ; (comment\n\n'(1 2) sym\n(do\n  (+ a 1)) )";
+        const std::vector<std::string> expectedForms = { "(def a 1)", "\"a (string\"", "'(1 2)", "sym", "(do\n  (+ a 1))", ")" };
+        const std::vector<size_t> expectedLineNos = { 1, 1, 3, 3, 4, 5 };
+        // the forms do not depend on the size of the chunks
+        for (size_t chunkSize : { 1, 2, 7, 64 })
+        {
+            LispReader reader(std::make_shared<std::istringstream>(code), chunkSize);
+            string form;
+            for (size_t i = 0; i < expectedForms.size(); i++)
+            {
+                QVERIFY(reader.ReadForm(/*out*/ form));
+                QCOMPARE(expectedForms[i].c_str(), form.c_str());
+                QVERIFY(expectedLineNos[i] == reader.GetLineNo());
+            }
+            QVERIFY(!reader.ReadForm(/*out*/ form));
+        }
+        // the rest of the code is a form if the code ends within a form
+        LispReader reader(std::make_shared<std::istringstream>("(def a 1)\n(print a"));
+        string form;
+        QVERIFY(reader.ReadForm(/*out*/ form));
+        QVERIFY(reader.ReadForm(/*out*/ form));
+        QCOMPARE("(print a", form.c_str());
+        QVERIFY(10 == reader.GetPosition());
+        QVERIFY(!reader.ReadForm(/*out*/ form));
+    }
+
+    TEST_METHOD(Test_EvalForms)
+    {
+        var input = std::make_shared<TextReader>("(def a 3)\n(defn f (x)\n  (* a x))\n(f 7)");
+        std::shared_ptr<LispVariant> result = Lisp::EvalForms(std::make_shared<LispReader>(input));
+        QCOMPARE(21, result->IntValue());
+        // an error reports the same line number and position as the evaluation of the whole code
+        const string code = "(def a 3)\n\n(setf a 4)\n(unknown-function a)";
+        string expectedStartPos;
+        try
+        {
+            Lisp::Eval(code);
+            QVERIFY(false);
+        }
+        catch (LispException & exc)
+        {
+            expectedStartPos = exc.Data["StartPos"]->ToString();
+        }
+        try
+        {
+            Lisp::EvalForms(std::make_shared<LispReader>(std::make_shared<std::istringstream>(code)));
+            QVERIFY(false);
+        }
+        catch (LispException & exc)
+        {
+            QCOMPARE("4", exc.Data["LineNo"]->ToString().c_str());
+            QCOMPARE(expectedStartPos.c_str(), exc.Data["StartPos"]->ToString().c_str());
+        }
+    }
+
+    TEST_METHOD(Test_ModulePrecedence)
+    {
+        {
+            std::ofstream moduleB("precedencetest_b.fuel");
+            moduleB << "(defn which () 2)\n";
+            std::ofstream moduleA("precedencetest_a.fuel");
+            moduleA << "(defn which () 1)\n";
+        }
+        // a symbol defined in more than one module is taken from the module with the first name in sorted order, not in import order
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (import \"precedencetest_b.fuel\") (import \"precedencetest_a.fuel\") (which))");
+        QCOMPARE(1, result->IntValue());
+        for (const char * moduleFileName : { "precedencetest_a.fuel", "precedencetest_b.fuel" })
+        {
+            std::remove(LispModuleCache::GetCacheFileName(moduleFileName, "").c_str());
+            std::remove(moduleFileName);
+        }
+    }
+
+    TEST_METHOD(Test_RuntimeMacroCompiled)
+    {
+        // the expansion of a run time macro is compiled once for each call site
+        Lisp::ResetRuntimeStatistics();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (define-macro-eval my-inc (x) (setf x (+ x 1))) (define-macro-eval twice (statement) (do (eval 'statement) (eval 'statement))) (defn f (n) (do (def i 0) (def j 0) (while (< i n) (do (my-inc i) (twice (my-inc j)))) (list i j))) (f 5))");
+        QCOMPARE("(5 10)", result->ToString().c_str());
+        QCOMPARE((size_t)4, Lisp::GetRuntimeStatistics().MacroExpansions);
+    }
+
+    TEST_METHOD(Test_DictArgumentCheck)
+    {
+        const char * codes[] = { "(dict-values 1)", "(dict-values \"abc\")", "(dict-keys (list 1 2))", "(dict-get 1 2)", "(dict-set \"abc\" 1 2)" };
+        for (const char * code : codes)
+        {
+            try
+            {
+                Lisp::Eval(code);
+                QVERIFY(false);
+            }
+            catch (LispException & exc)
+            {
+                QVERIFY(exc.Message.Contains("Dictionary expected"));
+            }
+        }
+    }
+
+    TEST_METHOD(Test_CallWithoutScope)
+    {
+        // tail recursion and setf of a global variable, a local variable defined after its first use, _additionalArgs and native operations with more arguments
+        Lisp::ResetRuntimeStatistics();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def g1 0) (defn cnt (n) (if (> n 0) (do (setf g1 (+ g1 1)) (cnt (- n 1))) g1)) (def y 100) (defn k () (do (def r 0) (def i 0) (while (< i 2) (do (setf r (+ r y)) (def y 1) (setf i (+ i 1)))) (+ r 0))) (defn h (a) (do (setf a 5) (list a _additionalArgs))) (defn p3 (a b c) (* (+ a b c) 2 0.5)) (list (cnt 3) (k) (h 1 2 3) (p3 1 2 3.5)))");
+        QCOMPARE("(3 101 (5 (2 3)) 6.500000)", result->ToString().c_str());
+        LispRuntimeStatistics statistics = Lisp::GetRuntimeStatistics();
+        QCOMPARE((size_t)7, statistics.FunctionCalls);
+        // only h uses the variables of the scope
+        QCOMPARE((size_t)1, statistics.FunctionScopes);
+
+        // an error creates the scopes of the call stack
+        try
+        {
+            Lisp::Eval("(do (defn s1 (x) (+ x (s2 x))) (defn s2 (x) (+ x (unknown-fn x))) (s1 1))");
+            QVERIFY(false);
+        }
+        catch (LispException & exc)
+        {
+            string stackInfo = exc.Data["StackInfo"]->ToString();
+            QVERIFY(stackInfo.Contains("name=s1"));
+            QVERIFY(stackInfo.Contains("name=s2"));
+        }
+    }
+
+    TEST_METHOD(Test_EvalOfCreatedList)
+    {
+        // the code of the run time macro expansions: eval of a created list, setf of rval and elements of quoted lists
+        Lisp::ResetRuntimeStatistics();
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def l '(a b c)) (def a 1) (def r1 (eval (list + (first '(a b)) (nth 1 '(2 3)) 4))) (setf (rval (first '(a b))) (eval (list * a 7))) (def r2 (eval (list 'list a 'l))) (def r3 (eval (nth 1 '(x a)))) (list r1 a r2 r3 (eval (list)) (eval 42) (eval (list 'if (eval (list < 1 a)) \"lt\" \"ge\"))))");
+        QCOMPARE("(8 7 (7 (a b c)) 7 NIL 42 \"lt\")", result->ToString().c_str());
+        // only the special form if is evaluated by the ast interpreter
+        QCOMPARE((size_t)3, Lisp::GetRuntimeStatistics().EvalAstCalls);
+    }
+
+    TEST_METHOD(Test_ImmediateValues)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(+ 1 2)");
+        QVERIFY(result->IsImmediate());
+        QCOMPARE(3, result->IntValue());
+        QVERIFY(result->BoxedValue()->IsInt());
+        result = Lisp::Eval("(+ \"a\" 1 #t 2.5)");
+        QCOMPARE("a1true2.500000", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_ImmediateValuesInDict)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (def d (make-dict)) (dict-set d 1 2.5) (list (dict-get d 1) (dict-contains-value d 2.5)))");
+        QCOMPARE("(2.500000 #t)", result->ToString().c_str());
+    }
+
+    TEST_METHOD(Test_QuotedListCopyOnWrite)
+    {
+        std::shared_ptr<LispVariant> result = Lisp::Eval("(do (defn f () (do (def l '(1 2 3)) (push 9 l) (return l))) (f) (list (f) (push 0 (f))))");
+        QCOMPARE("((9 1 2 3) (0 9 1 2 3))", result->ToString().c_str());
+    }
+
     TEST_METHOD(Test_AddString)
     {
         std::shared_ptr<LispVariant> result = Lisp::Eval("(+ \"abc\" \"def() ; blub\" \"xxx\")");
@@ -2612,10 +3149,10 @@ private Q_SLOTS:
         QCOMPARE("print", value->Value->ToString().c_str());
         value = resultAsArray[1]->ToLispVariant();
         QVERIFY(value->IsInt());
-        QCOMPARE(1, (int)*(value->Value));
+        QCOMPARE(1, value->IntValue());
         value = resultAsArray[2]->ToLispVariant();
         QVERIFY(value->IsDouble());
-        QCOMPARE(2.54, (double)*(value->Value));
+        QCOMPARE(2.54, value->DoubleValue());
         value = resultAsArray[3]->ToLispVariant();
         QVERIFY(value->IsString());
         QCOMPARE("string", value->Value->ToString().c_str());
@@ -2637,15 +3174,35 @@ private Q_SLOTS:
         var resultAsArray = listValue->ToArray();
         value = resultAsArray[1]->ToLispVariant();
         QVERIFY(value->IsBool());
-        QCOMPARE(true, (bool)*(value->Value));
+        QCOMPARE(true, value->BoolValue());
         value = resultAsArray[2]->ToLispVariant();
         QVERIFY(value->IsDouble());
-        QCOMPARE(2.54, (double)*(value->Value));
+        QCOMPARE(2.54, value->DoubleValue());
         value = resultAsArray[3]->ToLispVariant();
         QVERIFY(value->IsString());
         QCOMPARE("string", value->Value->ToString().c_str());
     }
 
+    void Test_SingleParserQuote()
+    {
+        std::shared_ptr<object> result = LispParser::Parse("(print '(1 2) `(a ,b))");
+        QVERIFY(result.get() != 0);
+        QVERIFY(result->IsList());
+        var resultAsArray = result->ToEnumerableOfObjectRef();
+        QCOMPARE((size_t)3, resultAsArray.size());
+
+        var quoted = resultAsArray[1]->ToEnumerableOfObjectRef();
+        QCOMPARE((size_t)2, quoted.size());
+        QCOMPARE("quote", quoted[0]->ToLispVariant()->Value->ToString().c_str());
+        QCOMPARE((size_t)2, quoted[1]->ToEnumerableOfObjectRef().size());
+
+        var quasiQuoted = resultAsArray[2]->ToEnumerableOfObjectRef();
+        QCOMPARE("quasiquote", quasiQuoted[0]->ToLispVariant()->Value->ToString().c_str());
+        var unquoted = quasiQuoted[1]->ToEnumerableOfObjectRef()[1]->ToEnumerableOfObjectRef();
+        QCOMPARE("_unquote", unquoted[0]->ToLispVariant()->Value->ToString().c_str());
+        QCOMPARE("b", unquoted[1]->ToLispVariant()->Value->ToString().c_str());
+    }
+
     // ***************************************************
 
     TEST_METHOD(Test_Debugger)
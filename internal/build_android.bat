@@ -22,15 +22,26 @@ rem %CC% --help
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Environment.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Exception.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Interpreter.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Compiler.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% VirtualMachine.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Lisp.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Parser.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Scope.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Symbol.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Profiler.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% RuntimeStatistics.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Dictionary.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% List.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% ThreadPool.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Runtime.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% ModuleCache.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Reader.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Token.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Tokenizer.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Utils.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Variant.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% fuel.cpp
-%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% fuel.o Variant.o Utils.o Tokenizer.o Token.o Scope.o Parser.o Lisp.o Interpreter.o Exception.o Environment.o Debug.o cstypes.o csstring.o csobject.o -o fuel
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% fuel.o Variant.o Utils.o Tokenizer.o Token.o Symbol.o Profiler.o RuntimeStatistics.o Dictionary.o List.o ThreadPool.o Runtime.o ModuleCache.o Reader.o Scope.o Parser.o Lisp.o Interpreter.o Compiler.o VirtualMachine.o Exception.o Environment.o Debug.o cstypes.o csstring.o csobject.o -o fuel
 rem mingw32-make -j 4 -f makefile.unx -e android_win=1 release=1
 rem copy minscript minscript_O2_android_arm
 rem C:\usr\android-ndk-r15c\toolchains\arm-linux-androideabi-4.9\prebuilt\windows-x86_64\bin\arm-linux-androideabi-strip minscript_O2_android_arm
@@ -22,15 +22,26 @@ del *.o
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Environment.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Exception.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Interpreter.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Compiler.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% VirtualMachine.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Lisp.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Parser.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Scope.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Symbol.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Profiler.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% RuntimeStatistics.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Dictionary.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% List.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% ThreadPool.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Runtime.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% ModuleCache.cpp
+%CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Reader.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Token.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Tokenizer.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Utils.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% Variant.cpp
 %CC% -c %CFLAGS% -I %MY_INCLUDES% -I %MY_INCLUDES2% fuel.cpp
-%CC% fuel.o Variant.o Utils.o Tokenizer.o Token.o Scope.o Parser.o Lisp.o Interpreter.o Exception.o Environment.o Debugger.o cstypes.o csstring.o csobject.o -o fuel %LDFLAGS%
+%CC% fuel.o Variant.o Utils.o Tokenizer.o Token.o Symbol.o Profiler.o RuntimeStatistics.o Dictionary.o List.o ThreadPool.o Runtime.o ModuleCache.o Reader.o Scope.o Parser.o Lisp.o Interpreter.o Compiler.o VirtualMachine.o Exception.o Environment.o Debugger.o cstypes.o csstring.o csobject.o -o fuel %LDFLAGS%
 %STRIP% fuel
 
 rem exit 0
\ No newline at end of file